@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <cstddef>
+
+// Forward declaration
+namespace SQLite { class Database; }
+class AirwayGraph;
+
+enum class AirwayLevel { Any, Low, High };
+
+struct RouteWaypoint {
+    std::string ident;
+    std::string icao_region;        // Empty for airports
+    double latitude = 0.0;
+    double longitude = 0.0;
+    std::string airway;             // Airway flown to reach this waypoint, "DCT" for a direct leg, empty for the first
+};
+
+struct AirwayRoute {
+    std::vector<RouteWaypoint> waypoints;
+    double distance_km = 0.0;
+};
+
+class AirwayRouter {
+    public:
+        explicit AirwayRouter(SQLite::Database* db);
+        ~AirwayRouter();
+
+        AirwayRouter(const AirwayRouter&) = delete;
+        AirwayRouter& operator=(const AirwayRouter&) = delete;
+
+        /**
+         * @brief Shortest airway route between two points, by great-circle distance.
+         * @param from, to Airport ICAO code, or the ident of a fix or navaid. Idents are not unique worldwide, so every
+         * point with the ident is a candidate and the route between the closest pair is returned. Airports and points
+         * that are not on an airway join the network with direct legs to the airway points around them.
+         * @param level Only use low or high airways.
+         * @return The route, or std::nullopt if the airway network does not connect the two points.
+         * @throws std::invalid_argument if an endpoint is not found.
+         * @note The airway graph is loaded from the database on the first call and kept in memory.
+         */
+        std::optional<AirwayRoute> find_route(const std::string& from, const std::string& to, AirwayLevel level = AirwayLevel::Any);
+
+        // Airway points and directed legs of the loaded graph (loads it if needed)
+        size_t node_count();
+        size_t edge_count();
+
+        // Drops the loaded graph, so the next query reloads it. Called after the database is updated.
+        void invalidate();
+
+    private:
+        SQLite::Database* m_db;
+        std::unique_ptr<AirwayGraph> m_graph;
+
+        const AirwayGraph& graph();
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+enum class IngestStage {
+    Scanning,       // Deciding which files need to be parsed
+    Ingesting,      // Parsing files and writing them to the database
+    Optimizing,     // ANALYZE / VACUUM after the data is committed
+    Completed
+};
+
+// Snapshot of an ingest run. The counters are cumulative for the current call to parse_all_dat_files().
+struct IngestProgress {
+    IngestStage stage = IngestStage::Scanning;
+    std::string current_file;           // File being written to the database, empty outside the Ingesting stage
+    size_t files_completed = 0;
+    size_t files_total = 0;
+    uint64_t bytes_parsed = 0;          // Input consumed by the parsers, which run ahead of the writer
+    uint64_t bytes_total = 0;
+    uint64_t lines_parsed = 0;
+    uint64_t airports_written = 0;
+};
+
+class IngestObserver {
+    public:
+        virtual ~IngestObserver() = default;
+
+        /**
+         * @brief Receives a progress sample. Samples are sent on every stage change, after each file is written, and
+         * every few dozen airports in between.
+         * @note Called on the thread running parse_all_dat_files(), between database writes, so it should return quickly.
+         */
+        virtual void on_progress(const IngestProgress& progress) = 0;
+};
+
+// Draws a progress bar on std::cout. NavDataManager installs one when logging is enabled.
+class ConsoleIngestObserver : public IngestObserver {
+    public:
+        void on_progress(const IngestProgress& progress) override;
+
+    private:
+        bool m_bar_open = false;        // A bar has been drawn and its line not yet ended
+        size_t m_files_completed = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+// A record or file that was left out of the database by a lenient ingest (see NavDataManager::set_lenient_parsing)
+struct IngestDiagnostic {
+    std::string file;
+    int line = 0;                   // 0 when the whole file (or the rest of it) could not be read
+    int row_code = -1;              // Row code of the line, -1 if it has none (earth_fix.dat, CIFP) or for file errors
+    std::string reason;
+};
+
+// Result of a call to parse_all_dat_files()
+struct IngestSummary {
+    size_t files_parsed = 0;
+    size_t files_skipped = 0;       // Unchanged since they were ingested
+    size_t files_changed = 0;       // Parsed again because their contents changed (counted in files_parsed too)
+    size_t files_removed = 0;       // Gone from disk, their airports and procedures were retracted
+    size_t files_deduplicated = 0;  // Byte-identical to another apt.dat, so not parsed a second time
+    uint64_t lines_parsed = 0;
+    uint64_t airports_written = 0;
+    // Of the scan_xp() before the call
+    size_t packages_walked = 0;     // Custom Scenery packages listed directory by directory
+    size_t packages_cached = 0;     // Custom Scenery packages taken from the scan manifest, unchanged since the last scan
+    size_t packages_disabled = 0;   // Marked SCENERY_PACK_DISABLED in scenery_packs.ini, not scanned or parsed
+    std::chrono::milliseconds scan_time{0};
+    bool bulk_load = false;         // The database was empty and was loaded in bulk (indexes built after the rows)
+    // The database file afterwards
+    uint64_t page_count = 0;
+    double fill_factor = 0.0;       // Used share of the B-tree page bytes, 0 if SQLite was built without dbstat
+    bool vacuumed = false;          // Rebuilt by VACUUM, which only runs when the fill factor is low
+    std::vector<IngestDiagnostic> diagnostics;      // In file and line order
+
+    bool clean() const { return diagnostics.empty(); }
+};
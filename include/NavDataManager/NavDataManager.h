@@ -1,8 +1,14 @@
 #pragma once
 #include <string>
 #include <memory>
+#include "IngestSummary.h"
 
 class AirportQuery;
+class NavaidQuery;
+class AirwayRouter;
+class ProcedureQuery;
+class IngestObserver;
+namespace SQLite { class Database; }
 
 class NavDataManager {
     public:
@@ -22,6 +28,9 @@ class NavDataManager {
 
         /**
          * @brief Scans and collects all needed .dat files within the X-Plane installation.
+         * The Custom Scenery packages are walked in parallel. With a scan manifest set (see set_scan_manifest_path()),
+         * a package whose directories are unchanged since the last scan is taken from it instead. Scanning again
+         * replaces what the previous scan found.
          * @throws fs::filesystem_error or std::exception if installation does not contain global apt.dat or Custom Scenery directory can not be found.
          */
         void scan_xp();
@@ -35,13 +44,104 @@ class NavDataManager {
 
         /**
          * @brief Parses all .dat files and performs database update.
-         * @param force_full_parse
-         * @note First time parsing of data will take upwards of 45 seconds to complete. It is an expensive operation.
+         * Files are compared with what was ingested before by size, modification time and content hash. Only new and
+         * changed files are parsed, the airports and procedures of removed files are retracted (an airport that
+         * Global Airports also has is read from there again), and an apt.dat identical to one already ingested is not
+         * parsed a second time.
+         * @param force_full_parse Parse every file, changed or not.
+         * @return Counts of the run, and in lenient mode the records and files that were skipped.
+         * @throws std::runtime_error on the first malformed record, unless lenient parsing is enabled. Nothing is
+         * written in that case.
+         * @note The first run into an empty database loads it in bulk (relaxed durability settings and the indexes
+         * built after the rows). It is still the expensive run, its time grows with the size of the apt.dat files.
          */
-        void parse_all_dat_files(bool force_full_parse=false);
+        IngestSummary parse_all_dat_files(bool force_full_parse=false);
+
+        /**
+         * @brief Enables lenient parsing: a malformed record no longer aborts the ingest. In apt.dat the airport it
+         * belongs to is skipped, in the nav .dat and CIFP files the record; a file that cannot be read is skipped.
+         * Everything else is committed, and each skip is reported in the IngestSummary::diagnostics.
+         * @note Files with skipped records are parsed again on the next call. Takes effect on the next call to
+         * parse_all_dat_files().
+         */
+        void set_lenient_parsing(bool lenient);
+
+        /**
+         * @brief Keeps a Custom Scenery scan manifest, so that later scans only walk the packages that changed.
+         * There is none by default, every package is walked on each scan.
+         * @param manifest_path Manifest file, created if needed; next to the database is a good place for it. An empty
+         * path disables the manifest again.
+         * @note Takes effect on the next call to scan_xp().
+         */
+        void set_scan_manifest_path(const std::string& manifest_path);
+
+        /**
+         * @brief Parses one airport again and replaces everything the database holds for it, in a transaction of its
+         * own. Meant for scenery authors iterating on an airport, where a full parse would be far too slow.
+         * @param icao Airport to reparse. Its record is read straight from the offset indexed by the last parse of its
+         * apt.dat (the custom scenery one, if the airport is overridden), and the rest of the file is only read if the
+         * record has moved since.
+         * @return Counts of the run. airports_written is 0 if the airport is no longer in the file, or in lenient mode
+         * if its record failed to parse (see the diagnostics), in which case its rows are left as they were.
+         * @throws std::invalid_argument if no parsed apt.dat contains the airport.
+         * @throws std::runtime_error if the database is not connected, or on a malformed record in strict mode.
+         */
+        IngestSummary reparse_airport(const std::string& icao);
+
+        /**
+         * @brief Parses the apt.dat of one scenery package again and replaces all of its airports, in a transaction of
+         * its own.
+         * @param package_path Scenery package directory, or the apt.dat file itself.
+         * @return Counts of the run.
+         * @throws std::invalid_argument if there is no apt.dat at the path.
+         * @throws std::runtime_error if the database is not connected, or on a malformed record in strict mode.
+         * @note Reparsing Global Airports leaves the airports overridden by custom scenery as they are. Airports
+         * removed from the package keep their rows until the next full parse.
+         */
+        IngestSummary reparse_package(const std::string& package_path);
+
+        /**
+         * @brief Sets the number of worker threads used to parse .dat files.
+         * @param thread_count Number of threads, 0 (the default) uses one per hardware thread. 1 parses serially.
+         * @note Takes effect on the next call to parse_all_dat_files().
+         */
+        void set_thread_count(unsigned thread_count);
+
+        /**
+         * @brief Sets the observer that receives progress samples while parse_all_dat_files() runs.
+         * @param observer Observer to notify, or nullptr for none. With logging enabled a ConsoleIngestObserver is installed by default.
+         * @note See IngestObserver.h.
+         */
+        void set_ingest_observer(std::shared_ptr<IngestObserver> observer);
 
         AirportQuery& airport_data();
 
+        /**
+         * @brief Navaids (VOR, NDB, ILS components, marker beacons, DME) loaded from earth_nav.dat.
+         * @throws std::runtime_error if the database is not connected.
+         */
+        NavaidQuery& navaid_data();
+
+        /**
+         * @brief Shortest routes over the airways loaded from earth_awy.dat, placed with earth_fix.dat and earth_nav.dat.
+         * @throws std::runtime_error if the database is not connected.
+         * @note The router's airway graph is reloaded after parse_all_dat_files().
+         */
+        AirwayRouter& airway_routing();
+
+        /**
+         * @brief SIDs, STARs and approaches loaded from the per-airport CIFP files.
+         * @throws std::runtime_error if the database is not connected.
+         */
+        ProcedureQuery& procedure_data();
+
+        /**
+         * @brief The connection the queries run on, for SQL of your own.
+         * @throws std::runtime_error if the database is not connected.
+         * @note Replaced by the next call to connect_database().
+         */
+        SQLite::Database& database();
+
     private:
         struct Impl;
         std::unique_ptr<Impl> m_impl;
@@ -0,0 +1,72 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <optional>
+#include <string>
+
+// Forward declaration
+namespace SQLite { class Database; }
+
+class NavaidQueryBuilder {
+    public:
+        // spatial_index: the database has the navaids_rtree table, which near() uses instead of the lat/lon columns
+        NavaidQueryBuilder(SQLite::Database* db, bool spatial_index) : m_db(db), m_spatial_index(spatial_index) {}
+
+        // Builder methods - return *this for chaining
+        NavaidQueryBuilder& ident(const std::string& filter) { ident_filter = filter; return *this; }
+        NavaidQueryBuilder& type(const std::string& filter) { type_filter = filter; return *this; }
+        NavaidQueryBuilder& airport_icao(const std::string& filter) { airport_filter = filter; return *this; }
+        NavaidQueryBuilder& icao_region(const std::string& filter) { region_filter = filter; return *this; }
+        NavaidQueryBuilder& max_results(int max) { limit = max; return *this; }
+        // Navaids within radius_km of the point, nearest first, each with its distance_km set
+        NavaidQueryBuilder& near(double lat, double lon, double radius_km) {
+            latitude = lat;
+            longitude = lon;
+            radius = radius_km;
+            return *this;
+        }
+
+        // Terminal methods - execute the query
+        std::vector<NavaidData> execute();
+        std::optional<NavaidData> first();
+        size_t count();
+
+    private:
+        SQLite::Database* m_db = nullptr;
+        bool m_spatial_index = false;
+
+        // Query parameters (ident, type, airport and region match exactly, so they can use the indexes)
+        std::optional<std::string> ident_filter;
+        std::optional<std::string> type_filter;
+        std::optional<std::string> airport_filter;
+        std::optional<std::string> region_filter;
+        std::optional<double> latitude;
+        std::optional<double> longitude;
+        std::optional<double> radius;
+        int limit = 100;
+};
+
+class NavaidQuery {
+    public:
+        NavaidQuery(SQLite::Database* db, bool spatial_index) : m_db(db), m_spatial_index(spatial_index) {}
+
+        NavaidQueryBuilder navaids() { return NavaidQueryBuilder(m_db, m_spatial_index); }
+
+        // Convenience methods
+        // Idents are not unique worldwide, so every navaid with the ident is returned
+        std::vector<NavaidData> get_by_ident(const std::string& ident, int limit = 100) {
+            return navaids().ident(ident).max_results(limit).execute();
+        }
+
+        std::vector<NavaidData> get_for_airport(const std::string& icao, int limit = 100) {
+            return navaids().airport_icao(icao).max_results(limit).execute();
+        }
+
+        std::vector<NavaidData> get_near(double lat, double lon, double radius_km, int limit = 50) {
+            return navaids().near(lat, lon, radius_km).max_results(limit).execute();
+        }
+
+    private:
+        SQLite::Database* m_db;
+        bool m_spatial_index;
+};
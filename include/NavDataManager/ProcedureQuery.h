@@ -0,0 +1,60 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <optional>
+#include <string>
+
+// Forward declaration
+namespace SQLite { class Database; }
+
+class ProcedureQueryBuilder {
+    public:
+        explicit ProcedureQueryBuilder(SQLite::Database* db) : m_db(db) {}
+
+        // Builder methods - return *this for chaining
+        ProcedureQueryBuilder& airport(const std::string& icao) { airport_filter = icao; return *this; }
+        ProcedureQueryBuilder& type(const std::string& filter) { type_filter = filter; return *this; }
+        ProcedureQueryBuilder& ident(const std::string& filter) { ident_filter = filter; return *this; }
+        ProcedureQueryBuilder& transition(const std::string& filter) { transition_filter = filter; return *this; }
+
+        // Terminal methods - execute the query. Procedures come ordered by airport, type, ident and transition, each
+        // with its legs in sequence order.
+        std::vector<ProcedureData> execute();
+        std::optional<ProcedureData> first();
+
+    private:
+        SQLite::Database* m_db = nullptr;
+
+        // Query parameters (all match exactly, the airport through idx_procedure_legs_airport_icao)
+        std::optional<std::string> airport_filter;
+        std::optional<std::string> type_filter;
+        std::optional<std::string> ident_filter;
+        std::optional<std::string> transition_filter;
+};
+
+class ProcedureQuery {
+    public:
+        explicit ProcedureQuery(SQLite::Database* db) : m_db(db) {}
+
+        ProcedureQueryBuilder procedures() { return ProcedureQueryBuilder(m_db); }
+
+        // Convenience methods
+        std::vector<ProcedureData> get_for_airport(const std::string& icao) {
+            return procedures().airport(icao).execute();
+        }
+
+        std::vector<ProcedureData> get_sids(const std::string& icao) {
+            return procedures().airport(icao).type("SID").execute();
+        }
+
+        std::vector<ProcedureData> get_stars(const std::string& icao) {
+            return procedures().airport(icao).type("STAR").execute();
+        }
+
+        std::vector<ProcedureData> get_approaches(const std::string& icao) {
+            return procedures().airport(icao).type("APPCH").execute();
+        }
+
+    private:
+        SQLite::Database* m_db;
+};
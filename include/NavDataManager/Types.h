@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <optional>
+#include <vector>
 #include <cmath>
 
 #ifndef M_PI
@@ -109,4 +110,43 @@ struct LinearFeatureNodeData {
     std::optional<double> bezier_latitude;
     std::optional<double> bezier_longitude;
     std::optional<int> node_order;
-};
\ No newline at end of file
+};
+
+struct NavaidData {
+    std::optional<std::string> ident;
+    std::optional<std::string> type;            // 'NDB', 'VOR', 'ILS', 'LOC', 'GS', 'OM', 'MM', 'IM', 'DME', ...
+    std::optional<int> row_code;                // earth_nav.dat row code
+    std::optional<double> latitude;
+    std::optional<double> longitude;
+    std::optional<int> elevation;
+    std::optional<int> frequency;               // NDB in kHz, VHF in 10 kHz units
+    std::optional<int> range;
+    std::optional<double> bearing;
+    std::optional<double> glideslope_angle;
+    std::optional<std::string> airport_icao;    // Empty for enroute navaids
+    std::optional<std::string> icao_region;
+    std::optional<std::string> name;
+    std::optional<double> distance_km;          // Set by radius queries
+
+    bool is_enroute() const { return !airport_icao.has_value(); }
+};
+
+struct ProcedureLegData {
+    std::optional<int> sequence;
+    std::optional<std::string> fix_ident;       // Empty for legs that do not end at a fix
+    std::optional<std::string> fix_region;
+    std::optional<std::string> description_code;
+    std::optional<std::string> turn_direction;
+    std::optional<std::string> path_terminator; // ARINC 424 leg type: 'IF', 'TF', 'CF', 'VA', ...
+    std::optional<std::string> recommended_navaid;
+};
+
+// A SID, STAR or approach of an airport, one per transition (the common route has no transition ident)
+struct ProcedureData {
+    std::optional<std::string> airport_icao;
+    std::optional<std::string> procedure_type;  // 'SID', 'STAR', 'APPCH'
+    std::optional<std::string> ident;
+    std::optional<std::string> transition;
+    std::optional<std::string> route_type;
+    std::vector<ProcedureLegData> legs;         // In sequence order
+};
@@ -0,0 +1,440 @@
+#include <NavDataManager/AirwayRouter.h>
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <unordered_map>
+#include <queue>
+#include <cmath>
+#include <algorithm>
+#include <tuple>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <cstdint>
+
+namespace {
+    constexpr double EARTH_RADIUS_KM = 6371.0;
+    constexpr double KM_PER_DEGREE = 111.195;
+    constexpr double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0;
+    // Airports and points that are not on an airway join the network through direct legs to the nearest airway points
+    constexpr double DIRECT_CONNECTION_KM = 150.0;
+    constexpr size_t MAX_DIRECT_CONNECTIONS = 8;
+    constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+    constexpr double UNREACHED = std::numeric_limits<double>::infinity();
+
+    // Airway levels an edge or node is on, as a bit mask
+    constexpr uint8_t LOW_AIRWAY = 1;
+    constexpr uint8_t HIGH_AIRWAY = 2;
+
+    uint8_t level_mask(AirwayLevel level) {
+        switch (level) {
+            case AirwayLevel::Low: return LOW_AIRWAY;
+            case AirwayLevel::High: return HIGH_AIRWAY;
+            default: return LOW_AIRWAY | HIGH_AIRWAY;
+        }
+    }
+
+    // A position with the terms the haversine formula needs precomputed
+    struct GeoPoint {
+        double lat_rad = 0.0, lon_rad = 0.0, cos_lat = 1.0;
+    };
+
+    GeoPoint make_point(double latitude, double longitude) {
+        GeoPoint point;
+        point.lat_rad = latitude * DEGREES_TO_RADIANS;
+        point.lon_rad = longitude * DEGREES_TO_RADIANS;
+        point.cos_lat = std::cos(point.lat_rad);
+        return point;
+    }
+
+    // Great-circle (haversine) distance
+    double distance_km(const GeoPoint& a, const GeoPoint& b) {
+        const double sin_dlat = std::sin((b.lat_rad - a.lat_rad) / 2);
+        const double sin_dlon = std::sin((b.lon_rad - a.lon_rad) / 2);
+        const double h = sin_dlat * sin_dlat + a.cos_lat * b.cos_lat * sin_dlon * sin_dlon;
+        return 2 * EARTH_RADIUS_KM * std::asin(std::min(1.0, std::sqrt(h)));
+    }
+
+    // Airway end points are named by ident, ICAO region and type (11 = fix, 2 = NDB, 3 = VHF navaid)
+    std::string point_key(const std::string& ident, const std::string& region, int type) {
+        return ident + '\x1f' + region + '\x1f' + std::to_string(type);
+    }
+
+    // One degree cells, numbered row by row from (-90, -180)
+    int64_t grid_cell(int lat_cell, int lon_cell) {
+        return static_cast<int64_t>(lat_cell + 90) * 360 + (((lon_cell + 180) % 360 + 360) % 360);
+    }
+}
+
+/*
+    The airway network as a directed graph in compressed sparse row form: the legs leaving node n are
+    [edge_offsets[n], edge_offsets[n + 1]) of the edge arrays. Nodes are the airway end points that could be placed
+    from the fixes and navaids tables, weights are great-circle distances in km. A one degree grid over the nodes
+    finds the airway points near an airport.
+*/
+class AirwayGraph {
+    public:
+        explicit AirwayGraph(SQLite::Database& db);
+
+        size_t node_count() const { return m_idents.size(); }
+        size_t edge_count() const { return m_edge_targets.size(); }
+
+        const std::vector<uint32_t>* nodes_with_ident(const std::string& ident) const {
+            auto found = m_nodes_by_ident.find(ident);
+            return found == m_nodes_by_ident.end() ? nullptr : &found->second;
+        }
+
+        // Up to max_nodes nodes on the given airway levels within radius_km, nearest first, with their distances
+        std::vector<std::pair<uint32_t, double>> nodes_near(const GeoPoint& point, double radius_km, size_t max_nodes, uint8_t levels) const;
+
+        std::vector<std::string> m_idents;
+        std::vector<std::string> m_regions;
+        std::vector<double> m_latitudes;
+        std::vector<double> m_longitudes;
+        std::vector<GeoPoint> m_points;
+        std::vector<uint8_t> m_node_levels;        // Levels of the airways touching the node, 0 if it was not placed
+
+        std::vector<uint32_t> m_edge_offsets;
+        std::vector<uint32_t> m_edge_targets;
+        std::vector<double> m_edge_weights;
+        std::vector<uint32_t> m_edge_airways;      // Index into m_airway_names
+        std::vector<uint8_t> m_edge_levels;
+        std::vector<std::string> m_airway_names;
+
+    private:
+        std::unordered_map<std::string, std::vector<uint32_t>> m_nodes_by_ident;
+        std::unordered_map<int64_t, std::vector<uint32_t>> m_grid;
+};
+
+AirwayGraph::AirwayGraph(SQLite::Database& db) {
+    struct Edge {
+        uint32_t from, to, airway;
+        uint8_t level;
+    };
+    std::unordered_map<std::string, uint32_t> node_ids;
+    std::unordered_map<std::string, uint32_t> airway_ids;
+    std::vector<Edge> edges;
+
+    auto intern_node = [&](const std::string& ident, const std::string& region, int type) {
+        auto [it, inserted] = node_ids.try_emplace(point_key(ident, region, type), static_cast<uint32_t>(m_idents.size()));
+        if (inserted) {
+            m_idents.push_back(ident);
+            m_regions.push_back(region);
+        }
+        return it->second;
+    };
+
+    SQLite::Statement segments(db, R"(
+        SELECT airway_name, from_ident, from_region, from_type, to_ident, to_region, to_type, direction, airway_level
+        FROM airway_segments
+    )");
+    while (segments.executeStep()) {
+        std::string airway_name = segments.getColumn(0).getString();
+        uint32_t from = intern_node(segments.getColumn(1).getString(), segments.getColumn(2).getString(), segments.getColumn(3).getInt());
+        uint32_t to = intern_node(segments.getColumn(4).getString(), segments.getColumn(5).getString(), segments.getColumn(6).getInt());
+        std::string direction = segments.getColumn(7).getString();
+        uint8_t level = segments.getColumn(8).getInt() == 2 ? HIGH_AIRWAY : LOW_AIRWAY;
+        uint32_t airway = airway_ids.try_emplace(airway_name, static_cast<uint32_t>(airway_ids.size())).first->second;
+
+        if (direction != "B") edges.push_back({from, to, airway, level});
+        if (direction != "F") edges.push_back({to, from, airway, level});
+    }
+    m_airway_names.resize(airway_ids.size());
+    for (const auto& [name, id] : airway_ids) {
+        m_airway_names[id] = name;
+    }
+
+    // Place the nodes. Enroute fixes come first, so they win over a terminal fix of the same ident and region.
+    const size_t node_total = m_idents.size();
+    m_latitudes.assign(node_total, 0.0);
+    m_longitudes.assign(node_total, 0.0);
+    m_points.assign(node_total, GeoPoint());
+    std::vector<bool> placed(node_total, false);
+    auto place_node = [&](const std::string& key, double latitude, double longitude) {
+        auto found = node_ids.find(key);
+        if (found == node_ids.end() || placed[found->second]) return;
+        placed[found->second] = true;
+        m_latitudes[found->second] = latitude;
+        m_longitudes[found->second] = longitude;
+        m_points[found->second] = make_point(latitude, longitude);
+    };
+
+    SQLite::Statement fixes(db, "SELECT ident, icao_region, latitude, longitude FROM fixes ORDER BY airport_icao IS NOT NULL");
+    while (fixes.executeStep()) {
+        place_node(point_key(fixes.getColumn(0).getString(), fixes.getColumn(1).getString(), 11),
+                   fixes.getColumn(2).getDouble(), fixes.getColumn(3).getDouble());
+    }
+    SQLite::Statement navaids(db, "SELECT ident, icao_region, row_code, latitude, longitude FROM navaids WHERE row_code IN (2, 3, 12, 13) ORDER BY row_code");
+    while (navaids.executeStep()) {
+        int type = navaids.getColumn(2).getInt() == 2 ? 2 : 3;
+        place_node(point_key(navaids.getColumn(0).getString(), navaids.getColumn(1).getString(), type),
+                   navaids.getColumn(3).getDouble(), navaids.getColumn(4).getDouble());
+    }
+
+    // A segment shared by several airways appears once per airway, keep one leg per node pair and level
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const Edge& edge) {
+        return !placed[edge.from] || !placed[edge.to] || edge.from == edge.to;
+    }), edges.end());
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        return std::tie(a.from, a.to, a.level, a.airway) < std::tie(b.from, b.to, b.level, b.airway);
+    });
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        return a.from == b.from && a.to == b.to && a.level == b.level;
+    }), edges.end());
+
+    // Edges are sorted by source node, so the offsets follow from a running count
+    m_node_levels.assign(node_total, 0);
+    m_edge_offsets.assign(node_total + 1, 0);
+    m_edge_targets.reserve(edges.size());
+    m_edge_weights.reserve(edges.size());
+    m_edge_airways.reserve(edges.size());
+    m_edge_levels.reserve(edges.size());
+    for (const Edge& edge : edges) {
+        m_edge_offsets[edge.from + 1]++;
+        m_edge_targets.push_back(edge.to);
+        m_edge_weights.push_back(distance_km(m_points[edge.from], m_points[edge.to]));
+        m_edge_airways.push_back(edge.airway);
+        m_edge_levels.push_back(edge.level);
+        m_node_levels[edge.from] |= edge.level;
+        m_node_levels[edge.to] |= edge.level;
+    }
+    for (size_t node = 0; node < node_total; ++node) {
+        m_edge_offsets[node + 1] += m_edge_offsets[node];
+    }
+
+    for (uint32_t node = 0; node < node_total; ++node) {
+        if (m_node_levels[node] == 0) continue;
+        m_nodes_by_ident[m_idents[node]].push_back(node);
+        int lat_cell = static_cast<int>(std::floor(m_latitudes[node]));
+        int lon_cell = static_cast<int>(std::floor(m_longitudes[node]));
+        m_grid[grid_cell(lat_cell, lon_cell)].push_back(node);
+    }
+}
+
+std::vector<std::pair<uint32_t, double>> AirwayGraph::nodes_near(const GeoPoint& point, double radius_km, size_t max_nodes, uint8_t levels) const {
+    const double latitude = point.lat_rad / DEGREES_TO_RADIANS;
+    const double longitude = point.lon_rad / DEGREES_TO_RADIANS;
+    const double delta_lat = radius_km / KM_PER_DEGREE;
+    const int min_lat_cell = std::max(-90, static_cast<int>(std::floor(latitude - delta_lat)));
+    const int max_lat_cell = std::min(89, static_cast<int>(std::floor(latitude + delta_lat)));
+
+    // Longitude span at the cell row farthest from the equator, every column near a pole
+    const double edge_latitude = std::min(89.0, std::max(std::abs(latitude - delta_lat), std::abs(latitude + delta_lat)));
+    const double delta_lon = delta_lat / std::cos(edge_latitude * DEGREES_TO_RADIANS);
+    int min_lon_cell = static_cast<int>(std::floor(longitude - delta_lon));
+    int max_lon_cell = static_cast<int>(std::floor(longitude + delta_lon));
+    if (max_lon_cell - min_lon_cell >= 359) {
+        min_lon_cell = -180;
+        max_lon_cell = 179;
+    }
+
+    std::vector<std::pair<uint32_t, double>> nearby;
+    for (int lat_cell = min_lat_cell; lat_cell <= max_lat_cell; ++lat_cell) {
+        for (int lon_cell = min_lon_cell; lon_cell <= max_lon_cell; ++lon_cell) {
+            auto cell = m_grid.find(grid_cell(lat_cell, lon_cell));
+            if (cell == m_grid.end()) continue;
+            for (uint32_t node : cell->second) {
+                if ((m_node_levels[node] & levels) == 0) continue;
+                double distance = distance_km(point, m_points[node]);
+                if (distance <= radius_km) nearby.emplace_back(node, distance);
+            }
+        }
+    }
+
+    auto by_distance = [](const auto& a, const auto& b) { return a.second < b.second; };
+    if (nearby.size() > max_nodes) {
+        std::partial_sort(nearby.begin(), nearby.begin() + max_nodes, nearby.end(), by_distance);
+        nearby.resize(max_nodes);
+    } else {
+        std::sort(nearby.begin(), nearby.end(), by_distance);
+    }
+    return nearby;
+}
+
+namespace {
+    // One place a route endpoint may refer to: an airway point, or a position off the network (an airport, or a fix
+    // or navaid no airway uses) that is joined to the airway points around it by direct legs
+    struct EndpointCandidate {
+        std::optional<RouteWaypoint> off_network;
+        std::vector<std::pair<uint32_t, double>> connections;      // Airway node and the length of the leg to it
+    };
+
+    std::vector<EndpointCandidate> resolve_endpoint(SQLite::Database& db, const AirwayGraph& graph, const std::string& name, uint8_t levels) {
+        std::vector<EndpointCandidate> candidates;
+        auto add_off_network = [&](const std::string& ident, const std::string& region, double latitude, double longitude) {
+            EndpointCandidate candidate;
+            candidate.off_network = RouteWaypoint{ident, region, latitude, longitude, ""};
+            candidate.connections = graph.nodes_near(make_point(latitude, longitude), DIRECT_CONNECTION_KM, MAX_DIRECT_CONNECTIONS, levels);
+            candidates.push_back(std::move(candidate));
+        };
+
+        SQLite::Statement airport(db, "SELECT latitude, longitude FROM airports WHERE icao = ? AND latitude IS NOT NULL AND longitude IS NOT NULL");
+        airport.bind(1, name);
+        if (airport.executeStep()) {
+            add_off_network(name, "", airport.getColumn(0).getDouble(), airport.getColumn(1).getDouble());
+            return candidates;
+        }
+
+        if (const std::vector<uint32_t>* nodes = graph.nodes_with_ident(name)) {
+            for (uint32_t node : *nodes) {
+                candidates.push_back({std::nullopt, {{node, 0.0}}});
+            }
+            return candidates;
+        }
+
+        SQLite::Statement points(db, R"(
+            SELECT icao_region, latitude, longitude FROM fixes WHERE ident = ?
+            UNION ALL
+            SELECT icao_region, latitude, longitude FROM navaids WHERE ident = ? AND row_code IN (2, 3, 12, 13)
+        )");
+        points.bind(1, name);
+        points.bind(2, name);
+        while (points.executeStep()) {
+            add_off_network(name, points.getColumn(0).getString(), points.getColumn(1).getDouble(), points.getColumn(2).getDouble());
+        }
+        if (candidates.empty()) {
+            throw std::invalid_argument("Unknown route endpoint: " + name);
+        }
+        return candidates;
+    }
+}
+
+AirwayRouter::AirwayRouter(SQLite::Database* db) : m_db(db) {}
+
+AirwayRouter::~AirwayRouter() = default;
+
+const AirwayGraph& AirwayRouter::graph() {
+    if (!m_graph) {
+        try {
+            m_graph = std::make_unique<AirwayGraph>(*m_db);
+        } catch (const SQLite::Exception& e) {
+            throw std::runtime_error("Airway graph load failed: " + std::string(e.what()));
+        }
+    }
+    return *m_graph;
+}
+
+size_t AirwayRouter::node_count() {
+    return graph().node_count();
+}
+
+size_t AirwayRouter::edge_count() {
+    return graph().edge_count();
+}
+
+void AirwayRouter::invalidate() {
+    m_graph.reset();
+}
+
+// A* over the airway graph, from every candidate of 'from' at once to the nearest candidate of 'to'. The heuristic is
+// the great-circle distance to the closest target position, which never overestimates since every leg is a great
+// circle. A node next to a target records the total through its exit leg, and the search stops once no open node
+// can beat the best total found.
+std::optional<AirwayRoute> AirwayRouter::find_route(const std::string& from, const std::string& to, AirwayLevel level) {
+    const AirwayGraph& network = graph();
+    const uint8_t levels = level_mask(level);
+    std::vector<EndpointCandidate> sources, targets;
+    try {
+        sources = resolve_endpoint(*m_db, network, from, levels);
+        targets = resolve_endpoint(*m_db, network, to, levels);
+    } catch (const SQLite::Exception& e) {
+        throw std::runtime_error("Route query failed: " + std::string(e.what()));
+    }
+
+    const size_t node_total = network.node_count();
+    std::vector<double> cost(node_total, UNREACHED);
+    std::vector<uint32_t> parent_edge(node_total, NO_NODE);
+    std::vector<uint32_t> origin(node_total, NO_NODE);               // Source candidate the node was reached from
+
+    // Exit legs into the targets, and the positions the heuristic measures to
+    std::unordered_map<uint32_t, std::pair<double, uint32_t>> exits;    // node -> (leg length, target candidate)
+    std::vector<GeoPoint> target_points;
+    for (uint32_t candidate = 0; candidate < targets.size(); ++candidate) {
+        const EndpointCandidate& target = targets[candidate];
+        if (target.off_network) {
+            target_points.push_back(make_point(target.off_network->latitude, target.off_network->longitude));
+        }
+        for (const auto& [node, leg] : target.connections) {
+            if (!target.off_network) target_points.push_back(network.m_points[node]);
+            auto [it, inserted] = exits.try_emplace(node, leg, candidate);
+            if (!inserted && leg < it->second.first) it->second = {leg, candidate};
+        }
+    }
+    auto heuristic = [&](uint32_t node) {
+        double closest = UNREACHED;
+        for (const GeoPoint& point : target_points) {
+            closest = std::min(closest, distance_km(network.m_points[node], point));
+        }
+        return closest;
+    };
+
+    using OpenEntry = std::pair<double, uint32_t>;      // (cost + heuristic, node)
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open;
+    for (uint32_t candidate = 0; candidate < sources.size(); ++candidate) {
+        for (const auto& [node, leg] : sources[candidate].connections) {
+            if (leg < cost[node]) {
+                cost[node] = leg;
+                origin[node] = candidate;
+                open.emplace(leg + heuristic(node), node);
+            }
+        }
+    }
+
+    double best_total = UNREACHED;
+    uint32_t best_exit = NO_NODE;
+    while (!open.empty()) {
+        auto [estimate, node] = open.top();
+        open.pop();
+        if (estimate >= best_total) break;
+        if (estimate > cost[node] + heuristic(node) + 1e-9) continue;      // Stale entry
+
+        auto exit = exits.find(node);
+        if (exit != exits.end() && cost[node] + exit->second.first < best_total) {
+            best_total = cost[node] + exit->second.first;
+            best_exit = node;
+        }
+
+        for (uint32_t edge = network.m_edge_offsets[node]; edge < network.m_edge_offsets[node + 1]; ++edge) {
+            if ((network.m_edge_levels[edge] & levels) == 0) continue;
+            uint32_t next = network.m_edge_targets[edge];
+            double next_cost = cost[node] + network.m_edge_weights[edge];
+            if (next_cost < cost[next]) {
+                cost[next] = next_cost;
+                parent_edge[next] = edge;
+                origin[next] = origin[node];
+                open.emplace(next_cost + heuristic(next), next);
+            }
+        }
+    }
+    if (best_exit == NO_NODE) return std::nullopt;
+
+    // Walk back from the exit node. The source of an edge is the node whose edge range contains it.
+    std::vector<uint32_t> path_edges;
+    uint32_t node = best_exit;
+    while (parent_edge[node] != NO_NODE) {
+        uint32_t edge = parent_edge[node];
+        path_edges.push_back(edge);
+        node = static_cast<uint32_t>(std::upper_bound(network.m_edge_offsets.begin(), network.m_edge_offsets.end(), edge) - network.m_edge_offsets.begin() - 1);
+    }
+    std::reverse(path_edges.begin(), path_edges.end());
+
+    auto airway_waypoint = [&](uint32_t waypoint_node, std::string airway) {
+        return RouteWaypoint{network.m_idents[waypoint_node], network.m_regions[waypoint_node], network.m_latitudes[waypoint_node],
+                             network.m_longitudes[waypoint_node], std::move(airway)};
+    };
+
+    AirwayRoute route;
+    route.distance_km = best_total;
+    const EndpointCandidate& source = sources[origin[best_exit]];
+    if (source.off_network) {
+        route.waypoints.push_back(*source.off_network);
+    }
+    route.waypoints.push_back(airway_waypoint(node, source.off_network ? "DCT" : ""));
+    for (uint32_t edge : path_edges) {
+        route.waypoints.push_back(airway_waypoint(network.m_edge_targets[edge], network.m_airway_names[network.m_edge_airways[edge]]));
+    }
+    const EndpointCandidate& target = targets[exits.at(best_exit).second];
+    if (target.off_network) {
+        route.waypoints.push_back(*target.off_network);
+        route.waypoints.back().airway = "DCT";
+    }
+    return route;
+}
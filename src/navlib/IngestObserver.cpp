@@ -0,0 +1,36 @@
+#include <NavDataManager/IngestObserver.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+void ConsoleIngestObserver::on_progress(const IngestProgress& progress) {
+    if (progress.stage != IngestStage::Ingesting || progress.bytes_total == 0) {
+        if (m_bar_open) {
+            std::cout << std::endl;
+            m_bar_open = false;
+        }
+        m_files_completed = progress.files_completed;
+        return;
+    }
+
+    const int bar_width = 50;
+    double fraction = std::min(1.0, static_cast<double>(progress.bytes_parsed) / progress.bytes_total);
+    int pos = static_cast<int>(bar_width * fraction);
+    std::string bar(bar_width, ' ');
+    std::fill(bar.begin(), bar.begin() + pos, '=');
+    if (pos < bar_width) bar[pos] = '>';
+
+    std::cout << "\r[" << bar << "] " << std::setw(3) << static_cast<int>(fraction * 100.0) << "%"
+              << std::setw(11) << std::min(progress.bytes_parsed, progress.bytes_total) << "/" << progress.bytes_total
+              << " bytes | " << progress.airports_written << " airports | " << progress.current_file;
+
+    // The last sample of a file ends its line, so the next file starts on a fresh one
+    if (progress.files_completed != m_files_completed) {
+        m_files_completed = progress.files_completed;
+        std::cout << std::endl;
+        m_bar_open = false;
+    } else {
+        std::cout.flush();
+        m_bar_open = true;
+    }
+}
@@ -1,14 +1,34 @@
 #include <NavDataManager/NavDataManager.h>
 #include <NavDataManager/AirportQuery.h>
+#include <NavDataManager/NavaidQuery.h>
+#include <NavDataManager/AirwayRouter.h>
+#include <NavDataManager/ProcedureQuery.h>
+#include <NavDataManager/IngestObserver.h>
+#include <NavDataManager/IngestSummary.h>
 #include "XPlaneDatParser.h"
+#include "MappedFile.h"
+#include "DecompressingReader.h"
+#include "SceneryScanner.h"
+#include "ThreadPool.h"
+#include "BoundedQueue.h"
 #include "schema.h"
 #include <iostream>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <filesystem>
 #include <string>
 #include <algorithm>
+#include <tuple>
 #include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <limits>
+#include <iterator>
+#include <numeric>
+#include <functional>
 #include <sqlite3.h>
 #include <SQLiteCpp/Transaction.h>
 #include <SQLiteCpp/Database.h>
@@ -16,36 +36,610 @@
 
 namespace fs = std::filesystem;
 
+namespace {
+    // Per-airport batches each file's parser may queue ahead of the writer
+    constexpr size_t INGEST_QUEUE_CAPACITY = 256;
+    // The observer is sampled every this many airport batches, besides every file boundary
+    constexpr size_t PROGRESS_SAMPLE_BATCHES = 64;
+    // CIFP files (one per airport, a few KiB each) handed to one parse task
+    constexpr size_t CIFP_FILES_PER_TASK = 64;
+    // Rows written by one multi-row INSERT, within SQLite's default limit of 999 bound parameters per statement
+    constexpr size_t MAX_ROWS_PER_INSERT = 64;
+    constexpr size_t MAX_PARAMETERS_PER_INSERT = 999;
+    // Rows of airport data a file collects before they are sorted and written
+    constexpr size_t WRITE_GROUP_ROWS = 64 * 1024;
+    // Below this share of used bytes in its B-tree pages the database is rebuilt by VACUUM after an ingest
+    constexpr double MIN_FILL_WITHOUT_VACUUM = 0.9;
+    // Page cache while an empty database is loaded in bulk
+    constexpr int BULK_LOAD_CACHE_KIB = 256 * 1024;
+    // Picks the airport_records row that is in the database: the highest in the scenery order (records indexed before
+    // it was known: custom scenery over Global Airports, then the last written)
+    constexpr const char* CURRENT_RECORD_ORDER = "ORDER BY scenery_priority DESC, is_custom_scenery DESC, record_id DESC LIMIT 1";
+
+    // One file moving through the pipeline: its parser task pushes batches (per airport for apt.dat), the writer pops them
+    template <typename Batch>
+    struct DatFileStream {
+        explicit DatFileStream(size_t capacity) : batches(capacity) {}
+
+        BoundedQueue<Batch> batches;
+        std::future<std::chrono::steady_clock::duration> producer;    // Resolves to the task's run time
+    };
+    using AptFileStream = DatFileStream<ParsedAptData>;
+    using NavFileStream = DatFileStream<ParsedNavData>;
+
+    // Runs parse(sink) on the pool as the producer of the stream. The queue is closed when the parse ends, and a
+    // closed queue (the writer gave up) cancels the parse.
+    template <typename Batch, typename Parse>
+    void start_producer(ThreadPool& pool, const std::shared_ptr<DatFileStream<Batch>>& stream, Parse parse) {
+        stream->producer = pool.submit([stream, parse] {
+            auto task_start = std::chrono::steady_clock::now();
+            try {
+                parse([&stream](Batch&& batch) {
+                    if (!stream->batches.push(std::move(batch))) {
+                        throw std::runtime_error("Ingest cancelled");
+                    }
+                });
+            } catch (...) {
+                stream->batches.close();
+                throw;
+            }
+            stream->batches.close();
+            return std::chrono::steady_clock::now() - task_start;
+        });
+    }
+
+    enum class FileChange { New, Changed, Unchanged };
+
+    struct SceneryFileCheck {
+        FileChange change;
+        uint64_t content_hash;
+    };
+
+    // Packages listed in scenery_packs.ini can live outside Custom Scenery, so anything but Global Airports counts
+    bool is_custom_scenery_file(const fs::path& file) {
+        return file.string().find("Global Scenery") == std::string::npos;
+    }
+
+    bool is_cifp_file(const fs::path& file) {
+        return file.parent_path().filename() == "CIFP" && file.extension() == ".dat";
+    }
+
+    // Files that stand in for each other share a key: the CIFP files of an airport (Custom Data over default data),
+    // and each nav .dat file. When one is removed, the other is parsed even if it has not changed.
+    std::string replacement_key(const fs::path& file) {
+        return is_cifp_file(file) ? "CIFP/" + file.stem().string() : file.filename().string();
+    }
+
+    // ICAO codes are compared without surrounding whitespace (a trailing '\r' of a CRLF file, for one)
+    std::string trimmed_icao(std::string_view icao) {
+        size_t first = icao.find_first_not_of(" \t\r\n");
+        if (first == std::string_view::npos) return std::string();
+        size_t last = icao.find_last_not_of(" \t\r\n");
+        return std::string(icao.substr(first, last - first + 1));
+    }
+
+    long long to_milliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+
+    // Bind a nullable column value. Batches outlive the statement step, so text is bound without a copy.
+    void bind_text(SQLite::Statement& stmt, int index, const StringColumn& column, size_t row) {
+        column.has_value(row) ? stmt.bindNoCopy(index, column.c_str(row)) : stmt.bind(index);
+    }
+
+    template <typename T>
+    void bind_value(SQLite::Statement& stmt, int index, const Column<T>& column, size_t row) {
+        column.has_value(row) ? stmt.bind(index, column[row]) : stmt.bind(index);
+    }
+
+    // The rows of each airport table in the order of its key (its primary key or UNIQUE constraint, the airport for
+    // the tables with neither), so that the inserts move through every B-tree in one direction rather than splitting
+    // pages all over it. Rows with equal keys keep their file order, so INSERT OR REPLACE still keeps the last one.
+    struct AptKeyOrder {
+        std::vector<uint32_t> airports;
+        std::vector<uint32_t> runways;
+        std::vector<uint32_t> taxiway_nodes;
+        std::vector<uint32_t> taxiway_edges;
+        std::vector<uint32_t> linear_features;
+        std::vector<uint32_t> linear_feature_nodes;
+        std::vector<uint32_t> taxiway_signs;
+        std::vector<uint32_t> startup_locations;
+    };
+
+    template <typename Less>
+    void sort_rows(std::vector<uint32_t>& order, size_t rows, Less less) {
+        order.resize(rows);
+        std::iota(order.begin(), order.end(), 0u);
+        if (!std::is_sorted(order.begin(), order.end(), less)) {
+            std::stable_sort(order.begin(), order.end(), less);
+        }
+    }
+
+    size_t row_count(const ParsedAptData& data) {
+        return data.airports.size() + data.runways.size() + data.taxiway_nodes.size() + data.taxiway_edges.size() +
+               data.linear_features.size() + data.linear_feature_nodes.size() + data.taxiway_signs.size() +
+               data.startup_locations.size();
+    }
+
+    // The tables are sorted in parallel on the pool, or one after the other on this thread without one
+    AptKeyOrder sort_by_key(const ParsedAptData& data, ThreadPool* pool) {
+        AptKeyOrder order;
+        const AirportIdTable& ids = data.airport_ids;
+        const std::vector<std::function<void()>> sorts = {
+            [&] {
+                const StringColumn& icao = data.airports.icao;
+                sort_rows(order.airports, data.airports.size(), [&](uint32_t a, uint32_t b) { return icao.view(a) < icao.view(b); });
+            },
+            [&] {
+                const RunwayColumns& runways = data.runways;
+                sort_rows(order.runways, runways.size(), [&](uint32_t a, uint32_t b) {
+                    return std::make_tuple(ids[runways.airport[a]], runways.end1.rw_number.view(a), runways.end2.rw_number.view(a)) <
+                           std::make_tuple(ids[runways.airport[b]], runways.end1.rw_number.view(b), runways.end2.rw_number.view(b));
+                });
+            },
+            [&] {
+                const TaxiwayNodeColumns& nodes = data.taxiway_nodes;
+                sort_rows(order.taxiway_nodes, nodes.size(), [&](uint32_t a, uint32_t b) {
+                    return std::make_tuple(nodes.node_id[a], ids[nodes.airport[a]]) < std::make_tuple(nodes.node_id[b], ids[nodes.airport[b]]);
+                });
+            },
+            [&] {
+                const TaxiwayEdgeColumns& edges = data.taxiway_edges;
+                sort_rows(order.taxiway_edges, edges.size(), [&](uint32_t a, uint32_t b) {
+                    return std::make_tuple(ids[edges.airport[a]], edges.start_node_id[a], edges.end_node_id[a]) <
+                           std::make_tuple(ids[edges.airport[b]], edges.start_node_id[b], edges.end_node_id[b]);
+                });
+            },
+            [&] {
+                const LinearFeatureColumns& features = data.linear_features;
+                sort_rows(order.linear_features, features.size(), [&](uint32_t a, uint32_t b) {
+                    return std::make_tuple(ids[features.airport[a]], features.feature_sequence[a]) <
+                           std::make_tuple(ids[features.airport[b]], features.feature_sequence[b]);
+                });
+            },
+            [&] {
+                const LinearFeatureNodeColumns& nodes = data.linear_feature_nodes;
+                sort_rows(order.linear_feature_nodes, nodes.size(), [&](uint32_t a, uint32_t b) {
+                    return std::make_tuple(ids[nodes.airport[a]], nodes.feature_sequence[a], nodes.node_order[a]) <
+                           std::make_tuple(ids[nodes.airport[b]], nodes.feature_sequence[b], nodes.node_order[b]);
+                });
+            },
+            [&] {
+                const TaxiwaySignColumns& signs = data.taxiway_signs;
+                sort_rows(order.taxiway_signs, signs.size(), [&](uint32_t a, uint32_t b) { return ids[signs.airport[a]] < ids[signs.airport[b]]; });
+            },
+            [&] {
+                const StartupLocationColumns& locations = data.startup_locations;
+                sort_rows(order.startup_locations, locations.size(), [&](uint32_t a, uint32_t b) {
+                    return ids[locations.airport[a]] < ids[locations.airport[b]];
+                });
+            },
+        };
+        if (pool == nullptr) {
+            for (const auto& sort : sorts) sort();
+            return order;
+        }
+        std::vector<std::future<void>> sorted;
+        sorted.reserve(sorts.size());
+        for (const auto& sort : sorts) {
+            sorted.push_back(pool->submit(sort));
+        }
+        for (auto& table : sorted) {
+            table.get();
+        }
+        return order;
+    }
+}
+
+// An INSERT writing up to MAX_ROWS_PER_INSERT rows per step, as INSERT ... VALUES (...), (...). SQLite inserts the rows
+// in order, so conflicts resolve as they would row by row. A statement is prepared for each row count a batch needs,
+// and bind_row(stmt, offset, row) binds the columns of one row at offset + 1 onwards.
+class MultiRowInsert {
+    public:
+        MultiRowInsert(SQLite::Database& db, std::string insert_into, int columns)
+            : m_db(db), m_insert_into(std::move(insert_into)), m_columns(columns),
+              m_rows_per_insert(std::clamp<size_t>(MAX_PARAMETERS_PER_INSERT / columns, 1, MAX_ROWS_PER_INSERT)) {}
+
+        template <typename BindRow>
+        void write(size_t row_count, BindRow bind_row) {
+            write_rows(row_count, [](size_t i) { return i; }, bind_row);
+        }
+
+        // The rows in the given order
+        template <typename BindRow>
+        void write(const std::vector<uint32_t>& order, BindRow bind_row) {
+            write_rows(order.size(), [&order](size_t i) { return static_cast<size_t>(order[i]); }, bind_row);
+        }
+
+    private:
+        SQLite::Database& m_db;
+        std::string m_insert_into;                                  // Up to the VALUES keyword
+        int m_columns;
+        size_t m_rows_per_insert;
+        std::vector<std::unique_ptr<SQLite::Statement>> m_statements;  // By row count - 1, prepared on first use
+
+        template <typename RowAt, typename BindRow>
+        void write_rows(size_t row_count, RowAt row_at, BindRow& bind_row) {
+            for (size_t first = 0; first < row_count; first += m_rows_per_insert) {
+                size_t rows = std::min(m_rows_per_insert, row_count - first);
+                SQLite::Statement& stmt = statement(rows);
+                for (size_t i = 0; i < rows; ++i) {
+                    bind_row(stmt, static_cast<int>(i) * m_columns, row_at(first + i));
+                }
+                stmt.exec();
+                stmt.reset();
+            }
+        }
+
+        SQLite::Statement& statement(size_t rows) {
+            if (m_statements.size() < rows) m_statements.resize(rows);
+            std::unique_ptr<SQLite::Statement>& stmt = m_statements[rows - 1];
+            if (!stmt) {
+                std::string row = "(?";
+                for (int column = 1; column < m_columns; ++column) row += ", ?";
+                row += ")";
+                std::string sql = m_insert_into + " VALUES " + row;
+                for (size_t i = 1; i < rows; ++i) sql += ", " + row;
+                stmt = std::make_unique<SQLite::Statement>(m_db, sql);
+            }
+            return *stmt;
+        }
+};
+
+// Connection settings while an empty database is loaded: no syncs (the load is all or nothing, and a crash midway
+// leaves a database to build again rather than data to lose), a larger page cache, and the file locked for the whole
+// load. The connection's own settings come back when the load ends, however it ends.
+class BulkLoadPragmas {
+    public:
+        explicit BulkLoadPragmas(SQLite::Database& db) : m_db(db) {
+            SQLite::Statement synchronous(m_db, "PRAGMA synchronous");
+            m_synchronous = synchronous.executeStep() ? synchronous.getColumn(0).getInt() : 1;
+            SQLite::Statement cache_size(m_db, "PRAGMA cache_size");
+            m_cache_size = cache_size.executeStep() ? cache_size.getColumn(0).getInt() : -2000;
+            m_db.exec("PRAGMA synchronous = OFF");
+            m_db.exec("PRAGMA cache_size = -" + std::to_string(BULK_LOAD_CACHE_KIB));
+            m_db.exec("PRAGMA locking_mode = EXCLUSIVE");
+        }
+
+        ~BulkLoadPragmas() {
+            try {
+                m_db.exec("PRAGMA locking_mode = NORMAL");
+                m_db.exec("PRAGMA synchronous = " + std::to_string(m_synchronous));
+                m_db.exec("PRAGMA cache_size = " + std::to_string(m_cache_size));
+                // The exclusive lock is given up on the next access
+                m_db.exec("SELECT COUNT(*) FROM sqlite_master");
+            } catch (const SQLite::Exception& e) {
+                std::cerr << "Error restoring database settings after bulk load: " << e.what() << std::endl;
+            }
+        }
+
+        BulkLoadPragmas(const BulkLoadPragmas&) = delete;
+        BulkLoadPragmas& operator=(const BulkLoadPragmas&) = delete;
+
+    private:
+        SQLite::Database& m_db;
+        int m_synchronous;
+        int m_cache_size;
+};
+
+// Insert statements are prepared once per ingest and reused for every batch
+struct AptInsertStatements {
+    SQLite::Statement insert_airport;
+    MultiRowInsert insert_runway;
+    MultiRowInsert insert_taxi_node;
+    MultiRowInsert insert_taxi_edge;
+    MultiRowInsert insert_linear_feature;
+    MultiRowInsert insert_linear_feature_node;
+    MultiRowInsert insert_taxiway_sign;
+    MultiRowInsert insert_startup_location;
+    // Record index of the airports of a file, rewritten whenever the file is parsed
+    SQLite::Statement delete_airport_records;
+    SQLite::Statement insert_airport_record;
+
+    explicit AptInsertStatements(SQLite::Database& db)
+        : insert_airport(db, R"(
+            INSERT OR REPLACE INTO airports
+            (icao, iata, faa, airport_name, elevation, type, latitude, longitude, 
+             country_id, state_id, city_id, region_id, transition_alt, transition_level)
+            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+          )"),
+          insert_runway(db, R"(
+            INSERT OR REPLACE INTO runways
+            (airport_icao, width, surface, end1_rw_number, end1_lat, end1_lon, end1_d_threshold, end1_rw_marking_code, end1_rw_app_light_code, 
+             end2_rw_number, end2_lat, end2_lon, end2_d_threshold, end2_rw_marking_code, end2_rw_app_light_code)
+          )", 15),
+          insert_taxi_node(db, R"(
+            INSERT OR REPLACE INTO taxi_nodes
+            (node_id, airport_icao, latitude, longitude, node_type)
+          )", 5),
+          insert_taxi_edge(db, R"(
+            INSERT OR REPLACE INTO taxi_edges
+            (airport_icao, start_node_id, end_node_id, is_two_way, taxiway_name, width_class)
+          )", 6),
+          insert_linear_feature(db, R"(
+            INSERT OR REPLACE INTO linear_features
+            (airport_icao, feature_sequence, line_type)
+          )", 3),
+          insert_linear_feature_node(db, R"(
+            INSERT OR REPLACE INTO linear_feature_nodes
+            (airport_icao, feature_sequence, latitude, longitude, bezier_latitude, bezier_longitude, node_order)
+          )", 7),
+          insert_taxiway_sign(db, R"(
+            INSERT INTO taxiway_signs
+            (airport_icao, latitude, longitude, heading, sign_text, size_class)
+          )", 6),
+          insert_startup_location(db, R"(
+            INSERT INTO startup_locations
+            (airport_icao, latitude, longitude, heading, location_type, ramp_name)
+          )", 6),
+          delete_airport_records(db, "DELETE FROM airport_records WHERE source_file = ?"),
+          insert_airport_record(db, R"(
+            INSERT OR REPLACE INTO airport_records
+            (source_file, airport_icao, byte_offset, byte_length, first_line, is_custom_scenery, scenery_priority)
+            VALUES (?, ?, ?, ?, ?, ?, ?)
+          )") {}
+};
+
+// Everything stored for an airport, cleared before a reparsed airport is written. The bulk ingest leaves this to
+// INSERT OR REPLACE, which would keep rows the new record no longer has (a removed runway, a renumbered taxi node).
+struct AirportDeleteStatements {
+    SQLite::Statement delete_airport;
+    SQLite::Statement delete_runways;
+    SQLite::Statement delete_taxi_nodes;
+    SQLite::Statement delete_taxi_edges;
+    SQLite::Statement delete_linear_features;
+    SQLite::Statement delete_linear_feature_nodes;
+    SQLite::Statement delete_taxiway_signs;
+    SQLite::Statement delete_startup_locations;
+
+    explicit AirportDeleteStatements(SQLite::Database& db)
+        : delete_airport(db, "DELETE FROM airports WHERE icao = ?"),
+          delete_runways(db, "DELETE FROM runways WHERE airport_icao = ?"),
+          delete_taxi_nodes(db, "DELETE FROM taxi_nodes WHERE airport_icao = ?"),
+          delete_taxi_edges(db, "DELETE FROM taxi_edges WHERE airport_icao = ?"),
+          delete_linear_features(db, "DELETE FROM linear_features WHERE airport_icao = ?"),
+          delete_linear_feature_nodes(db, "DELETE FROM linear_feature_nodes WHERE airport_icao = ?"),
+          delete_taxiway_signs(db, "DELETE FROM taxiway_signs WHERE airport_icao = ?"),
+          delete_startup_locations(db, "DELETE FROM startup_locations WHERE airport_icao = ?") {}
+
+    void execute(const std::string& icao) {
+        for (SQLite::Statement* stmt : {&delete_airport, &delete_runways, &delete_taxi_nodes, &delete_taxi_edges, &delete_linear_features,
+                                        &delete_linear_feature_nodes, &delete_taxiway_signs, &delete_startup_locations}) {
+            stmt->bind(1, icao);
+            stmt->exec();
+            stmt->reset();
+        }
+    }
+};
+
+// Country, region, state and city IDs by name, loaded from their tables when the database is connected so airports
+// resolve them without a query. A name seen for the first time is inserted through the statements kept here. IDs
+// inserted by a transaction that then rolls back are dropped by discard_uncommitted(), which reloads the tables.
+class LocationDictionary {
+    public:
+        explicit LocationDictionary(SQLite::Database& db)
+            : m_insert_country(db, "INSERT INTO countries (country_name) VALUES (?)"),
+              m_insert_region(db, "INSERT INTO regions (region_code) VALUES (?)"),
+              m_insert_state(db, "INSERT INTO states (state_name, country_id) VALUES (?, ?)"),
+              m_insert_city(db, "INSERT INTO cities (city_name, state_id, country_id) VALUES (?, ?, ?)"),
+              m_db(db) {
+            load();
+        }
+
+        void load() {
+            m_countries.clear();
+            m_regions.clear();
+            m_states.clear();
+            m_cities.clear();
+            SQLite::Statement select_countries(m_db, "SELECT country_id, country_name FROM countries");
+            while (select_countries.executeStep()) {
+                m_countries.emplace(select_countries.getColumn(1).getString(), select_countries.getColumn(0).getInt());
+            }
+            SQLite::Statement select_regions(m_db, "SELECT region_id, region_code FROM regions");
+            while (select_regions.executeStep()) {
+                m_regions.emplace(select_regions.getColumn(1).getString(), select_regions.getColumn(0).getInt());
+            }
+            SQLite::Statement select_states(m_db, "SELECT state_id, state_name, country_id FROM states");
+            while (select_states.executeStep()) {
+                m_states[select_states.getColumn(2).getInt()].emplace(select_states.getColumn(1).getString(), select_states.getColumn(0).getInt());
+            }
+            SQLite::Statement select_cities(m_db, "SELECT city_id, city_name, state_id, country_id FROM cities");
+            while (select_cities.executeStep()) {
+                m_cities[parents_key(select_cities.getColumn(2).getInt(), select_cities.getColumn(3).getInt())]
+                    .emplace(select_cities.getColumn(1).getString(), select_cities.getColumn(0).getInt());
+            }
+            m_uncommitted = false;
+        }
+
+        int country_id(const char* name) { return find_or_insert(m_countries, name, m_insert_country); }
+        int region_id(const char* code) { return find_or_insert(m_regions, code, m_insert_region); }
+        int state_id(const char* name, int country_id) { return find_or_insert(m_states[country_id], name, m_insert_state, country_id); }
+        int city_id(const char* name, int state_id, int country_id) {
+            return find_or_insert(m_cities[parents_key(state_id, country_id)], name, m_insert_city, state_id, country_id);
+        }
+
+        // Called once the transaction that used the dictionary has committed
+        void commit() { m_uncommitted = false; }
+        void discard_uncommitted() {
+            if (m_uncommitted) load();
+        }
+
+    private:
+        using NameIds = std::unordered_map<std::string, int>;
+
+        SQLite::Statement m_insert_country;
+        SQLite::Statement m_insert_region;
+        SQLite::Statement m_insert_state;
+        SQLite::Statement m_insert_city;
+        SQLite::Database& m_db;
+        NameIds m_countries;
+        NameIds m_regions;
+        std::unordered_map<int, NameIds> m_states;          // By country_id
+        std::unordered_map<int64_t, NameIds> m_cities;      // By state_id and country_id, see parents_key()
+        bool m_uncommitted = false;                         // Names inserted since the last commit()
+
+        static int64_t parents_key(int state_id, int country_id) {
+            return (static_cast<int64_t>(state_id) << 32) | static_cast<uint32_t>(country_id);
+        }
+
+        template <typename... ParentIds>
+        int find_or_insert(NameIds& ids, const char* name, SQLite::Statement& insert_stmt, ParentIds... parent_ids) {
+            auto [entry, inserted] = ids.try_emplace(name, 0);
+            if (!inserted) return entry->second;
+            try {
+                insert_stmt.bind(1, name);
+                int index = 2;
+                (insert_stmt.bind(index++, parent_ids), ...);
+                insert_stmt.exec();
+                insert_stmt.reset();
+            } catch (...) {
+                insert_stmt.reset();
+                ids.erase(entry);
+                throw;
+            }
+            entry->second = static_cast<int>(m_db.getLastInsertRowid());
+            m_uncommitted = true;
+            return entry->second;
+        }
+};
+
+struct NavInsertStatements {
+    SQLite::Statement delete_navaids;
+    MultiRowInsert insert_navaid;
+    SQLite::Statement delete_fixes;
+    MultiRowInsert insert_fix;
+    SQLite::Statement delete_airway_segments;
+    MultiRowInsert insert_airway_segment;
+
+    explicit NavInsertStatements(SQLite::Database& db)
+        : delete_navaids(db, "DELETE FROM navaids"),
+          insert_navaid(db, R"(
+            INSERT INTO navaids
+            (row_code, navaid_type, ident, latitude, longitude, elevation, frequency, range, bearing, glideslope_angle,
+             airport_icao, icao_region, name)
+          )", 13),
+          delete_fixes(db, "DELETE FROM fixes"),
+          insert_fix(db, R"(
+            INSERT INTO fixes
+            (ident, latitude, longitude, airport_icao, icao_region, waypoint_type)
+          )", 6),
+          delete_airway_segments(db, "DELETE FROM airway_segments"),
+          insert_airway_segment(db, R"(
+            INSERT INTO airway_segments
+            (airway_name, from_ident, from_region, from_type, to_ident, to_region, to_type, direction, airway_level,
+             base_fl, top_fl)
+          )", 11) {}
+};
+
+struct CifpInsertStatements {
+    SQLite::Statement delete_procedure_legs;
+    MultiRowInsert insert_procedure_leg;
+
+    explicit CifpInsertStatements(SQLite::Database& db)
+        : delete_procedure_legs(db, "DELETE FROM procedure_legs WHERE airport_icao = ?"),
+          insert_procedure_leg(db, R"(
+            INSERT INTO procedure_legs
+            (airport_icao, procedure_type, route_type, procedure_ident, transition_ident, sequence, fix_ident, fix_region,
+             description_code, turn_direction, path_terminator, recommended_navaid)
+          )", 12) {}
+};
+
 struct NavDataManager::Impl {
     std::string m_data_directory;
     std::string m_xp_directory;
     fs::path m_global_airport_data_path;
     fs::path m_custom_scenery_path;
     bool m_logging_enabled;
+    unsigned m_thread_count = 0;
     std::unique_ptr<SQLite::Database> m_db;
+    std::unique_ptr<LocationDictionary> m_locations;    // Warmed by connect_database()
     std::vector<fs::path> m_all_apt_files;
+    std::vector<fs::path> m_all_nav_files;
+    std::vector<fs::path> m_all_cifp_files;
+    bool m_has_navaid_rtree = false;
+    bool m_bulk_load = false;                           // The ingest running started from an empty database
     std::unique_ptr<XPlaneDatParser> m_parser;
     std::unique_ptr<AirportQuery> airport_query;
+    std::unique_ptr<NavaidQuery> navaid_query;
+    std::unique_ptr<AirwayRouter> airway_router;
+    std::unique_ptr<ProcedureQuery> procedure_query;
+    std::shared_ptr<IngestObserver> m_observer;
+    IngestProgress m_progress;
+    bool m_lenient = false;
+    std::vector<IngestDiagnostic> m_file_diagnostics;   // Lenient mode: files whose parse task failed
+    fs::path m_scan_manifest_path;                      // Empty: none, every scan walks all packages
+    size_t m_packages_walked = 0;                       // Custom Scenery packages of the last scan_xp()
+    size_t m_packages_cached = 0;
+    size_t m_packages_disabled = 0;
+    std::chrono::milliseconds m_scan_time{0};
+    std::unordered_map<std::string, int> m_apt_priorities;  // Scanned apt.dat files, by position in m_all_apt_files (higher wins)
 
     Impl(const std::string& xp_root_path, bool logging)
-        : m_xp_directory(xp_root_path), m_logging_enabled(logging), m_db(nullptr),
-        m_parser(std::make_unique<XPlaneDatParser>(logging)) {}
+        : m_xp_directory(xp_root_path), m_logging_enabled(logging), m_db(nullptr) {
+        if (logging) {
+            m_observer = std::make_shared<ConsoleIngestObserver>();
+        }
+    }
+
+    // Sends m_progress to the observer, with the parser counters read at this point
+    void notify_progress(IngestStage stage);
 
-    void optimize_database();
+    void optimize_database(IngestSummary& summary);
+    void measure_pages(IngestSummary& summary);
 
     void get_airport_dat_paths(const std::string& xp_dir);
+    void get_nav_dat_paths(const std::string& xp_dir);
+    void get_cifp_paths(const std::string& xp_dir);
     void apply_schema();
-    void parse_all_dat_files(bool force_full_parse);
-    bool check_scenery_path_in_db(const fs::path& scenery_path);
-    void insert_airports(const std::vector<AirportMeta>& airports, bool is_custom_scenery, std::unordered_set<std::string>& airports_in_transaction);
-    void insert_runways(const std::vector<RunwayData>& runways);
-    void insert_taxiway_nodes(const std::vector<TaxiwayNodeData>& taxiway_nodes);
-    void insert_taxiway_edges(const std::vector<TaxiwayEdgeData>& taxiway_edges);
-    void insert_linear_features(const std::vector<LinearFeatureData>& linear_features);
-    void insert_linear_feature_nodes(const std::vector<LinearFeatureNodeData>& linear_feature_nodes);
+    bool is_database_empty();
+    std::vector<std::string> drop_secondary_indexes();
+    void migrate_schema();
+    void create_navaid_spatial_index();
+    void rebuild_navaid_spatial_index();
+    IngestSummary parse_all_dat_files(bool force_full_parse);
+    // Lenient mode: records the failure of a parse task against each of its files and returns, strict mode: rethrows it
+    template <typename Duration>
+    Duration await_producer(std::future<Duration>& producer, const std::vector<fs::path>& files);
+    void ingest_apt_files(const std::vector<fs::path>& files_to_parse, std::unordered_set<std::string>& airports_in_transaction);
+    void ingest_nav_files(const std::vector<fs::path>& files_to_parse);
+    void ingest_cifp_files(const std::vector<fs::path>& files_to_parse);
+    SceneryFileCheck check_scenery_file(const fs::path& file);
+    size_t retract_removed_files(std::unordered_set<std::string>& retracted_keys, std::unordered_set<std::string>& orphaned_airports);
+    std::vector<std::string> current_airports_of(const fs::path& file);
+    void restore_orphaned_airports(const std::unordered_set<std::string>& orphaned_airports, const std::unordered_set<std::string>& airports_in_transaction);
+    void copy_airport_records(const std::vector<std::pair<fs::path, fs::path>>& duplicate_apt_files);
+    void insert_parsed_data(const ParsedAptData& data, std::unordered_set<std::string>& airports_in_transaction, AptInsertStatements& statements,
+                            ThreadPool* sort_pool = nullptr);
+    void insert_airports(const AirportColumns& airports, const std::vector<uint32_t>& order, std::unordered_set<std::string>& airports_in_transaction, AptInsertStatements& statements);
+    void insert_airport_records(const AirportColumns& airports, const fs::path& file, bool is_custom_scenery, int scenery_priority, SQLite::Statement& stmt);
+    int scenery_priority_of(const fs::path& file);
+    void apply_scenery_priorities(std::unordered_set<std::string>& orphaned_airports);
+    IngestSummary reparse_airport(const std::string& icao);
+    IngestSummary reparse_package(const fs::path& package_path);
+    size_t replace_indexed_airport(const std::string& icao, XPlaneDatParser& parser, AirportDeleteStatements& delete_statements, AptInsertStatements& statements);
+    // Parses one apt.dat file again and replaces its airports. With only_icao set just that airport is replaced, the
+    // others are only indexed again (their offsets may have moved).
+    size_t write_apt_file(const fs::path& file, bool is_custom_scenery, const std::optional<std::string>& only_icao,
+                          XPlaneDatParser& parser, AirportDeleteStatements& delete_statements, AptInsertStatements& statements);
+    size_t replace_airports(const ParsedAptData& batch, AirportDeleteStatements& delete_statements, AptInsertStatements& statements);
+    void finish_reparse(XPlaneDatParser& parser, IngestSummary& summary, const std::string& what, std::chrono::steady_clock::time_point begin_time);
+    void insert_runways(const RunwayColumns& runways, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_taxiway_nodes(const TaxiwayNodeColumns& taxiway_nodes, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_taxiway_edges(const TaxiwayEdgeColumns& taxiway_edges, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_linear_features(const LinearFeatureColumns& linear_features, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_linear_feature_nodes(const LinearFeatureNodeColumns& linear_feature_nodes, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_taxiway_signs(const TaxiwaySignColumns& taxiway_signs, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_startup_locations(const StartupLocationColumns& startup_locations, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert);
+    void insert_navaids(const NavaidColumns& navaids, MultiRowInsert& insert);
+    void insert_fixes(const FixColumns& fixes, MultiRowInsert& insert);
+    void insert_airway_segments(const AirwaySegmentColumns& airway_segments, MultiRowInsert& insert);
+    void insert_procedure_legs(const ProcedureLegColumns& procedure_legs, MultiRowInsert& insert);
     
     void initialize_queries() {
         airport_query = std::make_unique<AirportQuery>(m_db.get());
+        navaid_query = std::make_unique<NavaidQuery>(m_db.get(), m_has_navaid_rtree);
+        airway_router = std::make_unique<AirwayRouter>(m_db.get());
+        procedure_query = std::make_unique<ProcedureQuery>(m_db.get());
     }
 };
 
@@ -57,8 +651,21 @@ NavDataManager::~NavDataManager() = default;
 
 void NavDataManager::scan_xp() {
     try {
+        auto begin_time = std::chrono::steady_clock::now();
+        // Each scan starts over, a file listed twice would be taken for a copy of itself
+        m_impl->m_all_apt_files.clear();
+        m_impl->m_all_nav_files.clear();
+        m_impl->m_all_cifp_files.clear();
+        m_impl->m_apt_priorities.clear();
         m_impl->get_airport_dat_paths(m_impl->m_xp_directory);
-        // TODO: Add getNavDataPaths and handle similarly
+        m_impl->get_nav_dat_paths(m_impl->m_xp_directory);
+        m_impl->get_cifp_paths(m_impl->m_xp_directory);
+        m_impl->m_scan_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin_time);
+        if (m_impl->m_logging_enabled) {
+            std::cout << "Scanned the installation in " << m_impl->m_scan_time.count() << " ms (" << m_impl->m_packages_walked
+                      << " scenery packages walked, " << m_impl->m_packages_cached << " unchanged, "
+                      << m_impl->m_packages_disabled << " disabled)" << std::endl;
+        }
     } catch (const std::exception& e) {
         std::cerr << "NavDataManager scanning failed: " << e.what() << std::endl;
         throw;
@@ -67,6 +674,7 @@ void NavDataManager::scan_xp() {
 
 void NavDataManager::connect_database(const std::string& db_path) {
     try {
+        m_impl->m_locations.reset();
         m_impl->m_db = std::make_unique<SQLite::Database>(
             db_path,
             SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE
@@ -83,6 +691,7 @@ void NavDataManager::connect_database(const std::string& db_path) {
 
         // Create tables after opening the database
         m_impl->apply_schema();
+        m_impl->m_locations = std::make_unique<LocationDictionary>(*m_impl->m_db);
 
         m_impl->initialize_queries();
 
@@ -99,20 +708,69 @@ void NavDataManager::connect_database(const std::string& db_path) {
     }
 }
 
-void NavDataManager::parse_all_dat_files(bool force_full_parse) {
-    m_impl->parse_all_dat_files(force_full_parse);
+IngestSummary NavDataManager::parse_all_dat_files(bool force_full_parse) {
+    return m_impl->parse_all_dat_files(force_full_parse);
+}
+
+void NavDataManager::set_lenient_parsing(bool lenient) {
+    m_impl->m_lenient = lenient;
+}
+
+void NavDataManager::set_scan_manifest_path(const std::string& manifest_path) {
+    m_impl->m_scan_manifest_path = fs::path(manifest_path);
+}
+
+IngestSummary NavDataManager::reparse_airport(const std::string& icao) {
+    if (!m_impl->m_db) {
+        throw std::runtime_error("Database not connected. Call connect_database() first.");
+    }
+    return m_impl->reparse_airport(icao);
+}
+
+IngestSummary NavDataManager::reparse_package(const std::string& package_path) {
+    if (!m_impl->m_db) {
+        throw std::runtime_error("Database not connected. Call connect_database() first.");
+    }
+    return m_impl->reparse_package(package_path);
+}
+
+void NavDataManager::set_thread_count(unsigned thread_count) {
+    m_impl->m_thread_count = thread_count;
+}
+
+void NavDataManager::set_ingest_observer(std::shared_ptr<IngestObserver> observer) {
+    m_impl->m_observer = std::move(observer);
 }
 
 // ------ Implementation of Impl methods -----
-void NavDataManager::Impl::optimize_database() {
+void NavDataManager::Impl::notify_progress(IngestStage stage) {
+    if (!m_observer) return;
+    m_progress.stage = stage;
+    if (m_parser) {
+        m_progress.bytes_parsed = m_parser->bytes_parsed();
+        m_progress.lines_parsed = m_parser->lines_parsed();
+    }
+    m_observer->on_progress(m_progress);
+}
+
+void NavDataManager::Impl::optimize_database(IngestSummary& summary) {
     if (m_logging_enabled) {
         std::cout << "Optimizing database..." << std::endl;
     }
     m_db->exec("ANALYZE");
-    m_db->exec("VACUUM");
     m_db->exec("PRAGMA incremental_vacuum");
+    // Rows are written in key order, which leaves the pages full. VACUUM only pays off once changed and removed
+    // files have left them sparse.
+    measure_pages(summary);
+    if (summary.fill_factor < MIN_FILL_WITHOUT_VACUUM) {
+        m_db->exec("VACUUM");
+        summary.vacuumed = true;
+        measure_pages(summary);
+    }
 
     if (m_logging_enabled) {
+        std::cout << "Database: " << summary.page_count << " pages, " << static_cast<int>(summary.fill_factor * 100.0 + 0.5)
+                  << "% full" << (summary.vacuumed ? " after VACUUM" : ", no VACUUM needed") << std::endl;
         std::cout << "Database optimization completed." << std::endl;
         for (int i = 0; i < 50; ++i) {
                 std::cout << "-";
@@ -121,77 +779,200 @@ void NavDataManager::Impl::optimize_database() {
     }
 }
 
+// The fill factor is the used share of the bytes of the B-tree pages, read from the dbstat virtual table. SQLite built
+// without it reports 0, so that the database is always vacuumed as before.
+void NavDataManager::Impl::measure_pages(IngestSummary& summary) {
+    SQLite::Statement page_count(*m_db, "PRAGMA page_count");
+    summary.page_count = page_count.executeStep() ? static_cast<uint64_t>(page_count.getColumn(0).getInt64()) : 0;
+    summary.fill_factor = 0.0;
+    try {
+        SQLite::Statement usage(*m_db, "SELECT SUM(pgsize), SUM(unused) FROM dbstat");
+        if (usage.executeStep() && usage.getColumn(0).getInt64() > 0) {
+            summary.fill_factor = 1.0 - static_cast<double>(usage.getColumn(1).getInt64()) / usage.getColumn(0).getInt64();
+        }
+    } catch (const SQLite::Exception&) {
+        // No dbstat table
+    }
+}
 
-void NavDataManager::Impl::parse_all_dat_files(bool force_full_parse) {
+
+IngestSummary NavDataManager::Impl::parse_all_dat_files(bool force_full_parse) {
     // Perhaps it is best to open a transaction here, that way we make database commits more efficient
     try {
+        // A first build loads an empty database in bulk, under relaxed settings and with the secondary indexes built
+        // once the rows are in
+        m_bulk_load = is_database_empty();
+        std::optional<BulkLoadPragmas> bulk_load_pragmas;
+        if (m_bulk_load) bulk_load_pragmas.emplace(*m_db);
         SQLite::Transaction transaction(*m_db);
+        std::vector<std::string> deferred_indexes;
+        if (m_bulk_load) deferred_indexes = drop_secondary_indexes();
         if (m_logging_enabled) {
             std::cout << "Preparing for parsing..." << std::endl;
+            if (m_bulk_load) {
+                std::cout << "Empty database, loading in bulk (" << deferred_indexes.size() << " indexes deferred)" << std::endl;
+            }
         }
+        m_parser.reset();
+        m_file_diagnostics.clear();
+        m_progress = IngestProgress();
+        m_progress.files_total = m_all_apt_files.size() + m_all_nav_files.size() + m_all_cifp_files.size();
+        notify_progress(IngestStage::Scanning);
 
         // Track airports inserted during this transaction
         std::unordered_set<std::string> airports_in_transaction;
 
-        // Check files already in database
+        // Files ingested before that are gone from disk, or from the enabled scenery, take their data with them
+        std::unordered_set<std::string> retracted_keys;
+        std::unordered_set<std::string> orphaned_airports;
+        size_t removed_files = retract_removed_files(retracted_keys, orphaned_airports);
+        apply_scenery_priorities(orphaned_airports);
+
+        // Decide per file from its size, mtime and content hash. A file that replaces a retracted one (the default
+        // CIFP file of an airport whose custom one was removed) is parsed even if it has not changed itself.
         int skipped_files = 0;
-        std::vector<fs::path> files_to_parse;
-        for (const auto& file : m_all_apt_files) {
-            bool file_in_db = check_scenery_path_in_db(file);
-            if (!file_in_db || force_full_parse) {
-                files_to_parse.push_back(file);
-            } else {
-                skipped_files++;
+        size_t changed_files = 0;
+        std::unordered_map<uint64_t, fs::path> apt_file_hashes;                     // First apt.dat with each content
+        std::vector<std::pair<fs::path, fs::path>> duplicate_apt_files;             // Duplicate, and the file it copies
+        auto select_files_to_parse = [&](const std::vector<fs::path>& files, bool is_apt) {
+            std::vector<SceneryFileCheck> checks;
+            checks.reserve(files.size());
+            for (const auto& file : files) {
+                checks.push_back(check_scenery_file(file));
+                // Files already in the database are the first choice to copy from
+                if (is_apt && !force_full_parse && checks.back().change == FileChange::Unchanged && checks.back().content_hash != 0) {
+                    apt_file_hashes.emplace(checks.back().content_hash, file);
+                }
             }
-            if (m_logging_enabled) {
-                if (force_full_parse) {
-                    std::cout << "Force Full Parse Detected. File: [" << file.string() << "] added to parse queue." << std::endl;
+
+            std::vector<fs::path> files_to_parse;
+            for (size_t i = 0; i < files.size(); ++i) {
+                const fs::path& file = files[i];
+                const SceneryFileCheck& check = checks[i];
+                bool replaces_retracted = !is_apt && retracted_keys.count(replacement_key(file)) > 0;
+                bool parse = force_full_parse || check.change != FileChange::Unchanged || replaces_retracted;
+                if (is_apt && parse && check.content_hash != 0) {
+                    auto [first, inserted] = apt_file_hashes.emplace(check.content_hash, file);
+                    if (!inserted && first->second != file) {
+                        if (m_logging_enabled) {
+                            std::cout << "File: [" << file.string() << "] is identical to [" << first->second.string() << "], skipping..." << std::endl;
+                        }
+                        duplicate_apt_files.emplace_back(file, first->second);
+                        continue;
+                    }
+                }
+                if (is_apt && check.change == FileChange::Changed) {
+                    // Whatever the file no longer has is retracted after the ingest
+                    for (auto& icao : current_airports_of(file)) {
+                        orphaned_airports.insert(std::move(icao));
+                    }
+                }
+                if (check.change == FileChange::Changed) changed_files++;
+
+                if (parse) {
+                    files_to_parse.push_back(file);
                 } else {
-                    if (file_in_db) {
-                        std::cout << "File: [" << file.string() << "] detected in database, skipping..." << std::endl;
-                    } else {
+                    skipped_files++;
+                }
+                if (m_logging_enabled) {
+                    if (force_full_parse) {
+                        std::cout << "Force Full Parse Detected. File: [" << file.string() << "] added to parse queue." << std::endl;
+                    } else if (check.change == FileChange::New) {
                         std::cout << "Detected new file: [" << file.string() << "] added to parse queue." << std::endl;
+                    } else if (check.change == FileChange::Changed) {
+                        std::cout << "Detected changed file: [" << file.string() << "] added to parse queue." << std::endl;
+                    } else if (replaces_retracted) {
+                        std::cout << "File: [" << file.string() << "] replaces a removed file, added to parse queue." << std::endl;
+                    } else {
+                        std::cout << "File: [" << file.string() << "] unchanged, skipping..." << std::endl;
                     }
                 }
             }
+            return files_to_parse;
+        };
+        std::vector<fs::path> apt_files_to_parse = select_files_to_parse(m_all_apt_files, true);
+        std::vector<fs::path> nav_files_to_parse = select_files_to_parse(m_all_nav_files, false);
+        std::vector<fs::path> cifp_files_to_parse = select_files_to_parse(m_all_cifp_files, false);
+
+        m_progress.files_total = apt_files_to_parse.size() + nav_files_to_parse.size() + cifp_files_to_parse.size();
+        for (const auto* files : {&apt_files_to_parse, &nav_files_to_parse, &cifp_files_to_parse}) {
+            for (const auto& file : *files) {
+                std::error_code ec;
+                uintmax_t file_size = fs::file_size(file, ec);
+                if (!ec) m_progress.bytes_total += file_size;
+            }
         }
 
         if (m_logging_enabled) {
             std::cout << "Parsing apt.dat files..." << std::endl;
         }
-        int curr_file_num = 0;
-        auto begin_time = std::chrono::steady_clock::now();
-        auto total_insertion_time = std::chrono::seconds::zero();
-
-        // Parse all non-skipped files
-        for (const auto& file: files_to_parse) {
-            
+        // Airports of removed and changed files are cleared first, so a changed airport is written without the rows
+        // (runways, taxi nodes) its new record no longer has
+        if (!orphaned_airports.empty()) {
+            AirportDeleteStatements delete_statements(*m_db);
+            for (const auto& icao : orphaned_airports) {
+                delete_statements.execute(icao);
+            }
+        }
+        ingest_apt_files(apt_files_to_parse, airports_in_transaction);
+        copy_airport_records(duplicate_apt_files);
+        restore_orphaned_airports(orphaned_airports, airports_in_transaction);
+        ingest_nav_files(nav_files_to_parse);
+        ingest_cifp_files(cifp_files_to_parse);
+        if (!deferred_indexes.empty()) {
+            auto begin_time = std::chrono::steady_clock::now();
+            for (const auto& create_index : deferred_indexes) {
+                m_db->exec(create_index);
+            }
             if (m_logging_enabled) {
-                curr_file_num++;
-                std::cout << "(" << curr_file_num << "/" << files_to_parse.size() << ")..." << std::endl;
+                std::cout << "Indexes built in " << to_milliseconds(std::chrono::steady_clock::now() - begin_time) << " ms" << std::endl;
             }
-            
-            ParsedAptData parsed_data = m_parser->parse_airport_dat(file);
+        }
+
+        IngestSummary summary;
+        summary.bulk_load = m_bulk_load;
+        summary.files_parsed = m_progress.files_completed;
+        summary.files_skipped = skipped_files;
+        summary.files_changed = changed_files;
+        summary.files_removed = removed_files;
+        summary.files_deduplicated = duplicate_apt_files.size();
+        summary.packages_walked = m_packages_walked;
+        summary.packages_cached = m_packages_cached;
+        summary.packages_disabled = m_packages_disabled;
+        summary.scan_time = m_scan_time;
+        summary.lines_parsed = m_parser->lines_parsed();
+        summary.airports_written = m_progress.airports_written;
+        summary.diagnostics = m_parser->take_diagnostics();
+        summary.diagnostics.insert(summary.diagnostics.end(), m_file_diagnostics.begin(), m_file_diagnostics.end());
+        std::sort(summary.diagnostics.begin(), summary.diagnostics.end(), [](const IngestDiagnostic& a, const IngestDiagnostic& b) {
+            return std::tie(a.file, a.line) < std::tie(b.file, b.line);
+        });
+        // A file with skipped records is not marked as parsed, so the next run picks it up again once it is fixed.
+        // Neither are its duplicates, which copied its records.
+        SQLite::Statement forget_file(*m_db, "DELETE FROM scenery_paths WHERE scenery_path = ?");
+        auto forget = [&forget_file](const std::string& file) {
+            forget_file.bind(1, file);
+            forget_file.executeStep();
+            forget_file.reset();
+        };
+        for (size_t i = 0; i < summary.diagnostics.size(); ++i) {
+            if (i > 0 && summary.diagnostics[i].file == summary.diagnostics[i - 1].file) continue;
+            forget(summary.diagnostics[i].file);
+            for (const auto& [duplicate, source] : duplicate_apt_files) {
+                if (source.string() == summary.diagnostics[i].file) forget(duplicate.string());
+            }
+        }
 
-            bool is_custom_scenery = file.string().find("Custom Scenery") != std::string::npos;
-            auto begin_insertion_time = std::chrono::steady_clock::now();
-            insert_airports(parsed_data.airports, is_custom_scenery, airports_in_transaction);
-            insert_runways(parsed_data.runways);
-            insert_taxiway_nodes(parsed_data.taxiway_nodes);
-            insert_taxiway_edges(parsed_data.taxiway_edges);
-            insert_linear_features(parsed_data.linear_features);
-            insert_linear_feature_nodes(parsed_data.linear_feature_nodes);
-            auto end_insertion_time = std::chrono::steady_clock::now();
-            auto insertion_duration = std::chrono::duration_cast<std::chrono::seconds>(end_insertion_time - begin_insertion_time);
-            total_insertion_time += insertion_duration;
-        }
-        // Handle other file types...
-        auto end_time = std::chrono::steady_clock::now();
         if (m_logging_enabled) {
-            auto parse_duration = std::chrono::duration_cast<std::chrono::seconds>(end_time - begin_time);
-            std::cout << "Parsing Completed in " << parse_duration.count() << " seconds." << std::endl;
-            std::cout << "Total Insertion Time: " << total_insertion_time.count() << " seconds." << std::endl;
-            std::cout << "Total Files Skipped: " << skipped_files << std::endl;
+            if (!summary.clean()) {
+                std::cout << "Lenient parsing skipped " << summary.diagnostics.size() << " records:" << std::endl;
+                for (const auto& diagnostic : summary.diagnostics) {
+                    std::cout << "  " << diagnostic.file << ":" << diagnostic.line << " (row code " << diagnostic.row_code
+                              << "): " << diagnostic.reason << std::endl;
+                }
+            }
+            std::cout << "Total Files Skipped: " << skipped_files << " (changed " << changed_files << ", removed " << removed_files
+                      << ", duplicates " << duplicate_apt_files.size() << ")" << std::endl;
             for (int i = 0; i < 50; ++i) {
                 std::cout << "-";
             }
@@ -199,178 +980,830 @@ void NavDataManager::Impl::parse_all_dat_files(bool force_full_parse) {
         }
         // Close the transaction and commit if everything succeeded
         transaction.commit();
+        m_locations->commit();
+        if (airway_router) {
+            airway_router->invalidate();
+        }
 
         // Optimize database
-        optimize_database();
+        notify_progress(IngestStage::Optimizing);
+        optimize_database(summary);
+        if (bulk_load_pragmas) {
+            // Back to the normal settings, under which the checkpoint makes the load durable
+            bulk_load_pragmas.reset();
+            m_db->exec("PRAGMA wal_checkpoint(TRUNCATE)");
+        }
+        notify_progress(IngestStage::Completed);
+        return summary;
 
     } catch (const std::exception& e) {
+        // The transaction has rolled back, and with it any country, region, state or city it added
+        m_locations->discard_uncommitted();
         throw;
     }
 }
 
-bool NavDataManager::Impl::check_scenery_path_in_db(const fs::path& scenery_path) {
-    SQLite::Statement select_stmt(*m_db, "SELECT * FROM scenery_paths WHERE scenery_path = ?");
-    select_stmt.bind(1, scenery_path.string());
-    
-    // Check if it exists in the database
-    if (select_stmt.executeStep()) return true;
-
-    // If not, create a new record for the scenery path
-    SQLite::Statement insert_stmt(*m_db, "INSERT INTO scenery_paths (scenery_path) VALUES (?)");
-    insert_stmt.bind(1, scenery_path.string());
-    insert_stmt.executeStep();
-    return false;
+template <typename Duration>
+Duration NavDataManager::Impl::await_producer(std::future<Duration>& producer, const std::vector<fs::path>& files) {
+    try {
+        return producer.get();
+    } catch (const std::exception& e) {
+        if (!m_lenient) throw;
+        // What the files delivered before the failure has been written and is kept. Each of them is reported, so that
+        // none is taken for ingested and skipped by the next run.
+        for (const auto& file : files) {
+            m_file_diagnostics.push_back({file.string(), 0, -1, e.what()});
+        }
+        return Duration{0};
+    }
 }
 
-void NavDataManager::Impl::insert_airports(const std::vector<AirportMeta>& airports, bool is_custom_scenery, std::unordered_set<std::string>& airports_in_transaction) {
-    // Helper function to get or create lookup table IDs
-    auto get_or_create_country_id = [this](const std::string& country_name) -> int {
-        // First try to get existing
-        SQLite::Statement select_stmt(*m_db, "SELECT country_id FROM countries WHERE country_name = ?");
-        select_stmt.bind(1, country_name);
-        if (select_stmt.executeStep()) {
-            return select_stmt.getColumn(0).getInt();
+// Parsing and writing run as a pipeline. Parser tasks on the pool push per-airport batches into a bounded queue per
+// file, and this thread, the only one touching the database, drains the queues into the open transaction. Files are
+// written strictly in queue order, from the top of the scenery order down, each in write groups whose rows are sorted
+// by table key (see sort_by_key) before they are inserted. The pool runs tasks FIFO, so
+// the producer of the file being written is always running or done and a full queue can never deadlock. At most
+// parse_window files are in flight, and each holds at most INGEST_QUEUE_CAPACITY batches, which bounds the memory
+// waiting for the writer. Files entering the window get a read-ahead hint so their pages are already cached when a
+// worker picks them up.
+void NavDataManager::Impl::ingest_apt_files(const std::vector<fs::path>& files_to_parse, std::unordered_set<std::string>& airports_in_transaction) {
+    auto begin_time = std::chrono::steady_clock::now();
+    AptInsertStatements statements(*m_db);
+
+    // A file parsed without the files above it in the scenery order (Global Airports changed, the overrides did not)
+    // only indexes the airports those files have: the highest priority each airport has in a file not parsed now
+    std::unordered_map<std::string, int> unparsed_priorities;
+    if (!files_to_parse.empty()) {
+        std::unordered_set<std::string> parsed_files;
+        int lowest_priority = std::numeric_limits<int>::max();
+        for (const auto& file : files_to_parse) {
+            parsed_files.insert(file.string());
+            lowest_priority = std::min(lowest_priority, scenery_priority_of(file));
         }
-        
-        // Create new
-        SQLite::Statement insert_stmt(*m_db, "INSERT INTO countries (country_name) VALUES (?)");
-        insert_stmt.bind(1, country_name);
-        insert_stmt.executeStep();
-        return static_cast<int>(m_db->getLastInsertRowid());
-    };
-    
-    auto get_or_create_region_id = [this](const std::string& region_code) -> int {
-        SQLite::Statement select_stmt(*m_db, "SELECT region_id FROM regions WHERE region_code = ?");
-        select_stmt.bind(1, region_code);
-        if (select_stmt.executeStep()) {
-            return select_stmt.getColumn(0).getInt();
+        SQLite::Statement select_priorities(*m_db, "SELECT airport_icao, source_file, scenery_priority FROM airport_records WHERE scenery_priority > ?");
+        select_priorities.bind(1, lowest_priority);
+        while (select_priorities.executeStep()) {
+            if (parsed_files.count(select_priorities.getColumn(1).getString()) > 0) continue;
+            int& priority = unparsed_priorities[select_priorities.getColumn(0).getString()];
+            priority = std::max(priority, select_priorities.getColumn(2).getInt());
         }
-        
-        SQLite::Statement insert_stmt(*m_db, "INSERT INTO regions (region_code) VALUES (?)");
-        insert_stmt.bind(1, region_code);
-        insert_stmt.executeStep();
-        return static_cast<int>(m_db->getLastInsertRowid());
-    };
-    
-    auto get_or_create_state_id = [this](const std::string& state_name, int country_id) -> int {
-        SQLite::Statement select_stmt(*m_db, "SELECT state_id FROM states WHERE state_name = ? AND country_id = ?");
-        select_stmt.bind(1, state_name);
-        select_stmt.bind(2, country_id);
-        if (select_stmt.executeStep()) {
-            return select_stmt.getColumn(0).getInt();
+    }
+    // Overrides are resolved before anything is written: files go from the top of the scenery order down, the first
+    // to deliver an airport wins it, and the files below only index it. Only an airport still in the database from an
+    // earlier run has rows to delete, once, before its winner is written.
+    std::vector<fs::path> write_order(files_to_parse.rbegin(), files_to_parse.rend());
+    std::unordered_set<std::string> stored_airports;
+    {
+        SQLite::Statement select_stored(*m_db, "SELECT icao FROM airports");
+        while (select_stored.executeStep()) {
+            stored_airports.insert(trimmed_icao(select_stored.getColumn(0).getString()));
         }
-        
-        SQLite::Statement insert_stmt(*m_db, "INSERT INTO states (state_name, country_id) VALUES (?, ?)");
-        insert_stmt.bind(1, state_name);
-        insert_stmt.bind(2, country_id);
-        insert_stmt.executeStep();
-        return static_cast<int>(m_db->getLastInsertRowid());
+    }
+    AirportDeleteStatements delete_statements(*m_db);
+
+    unsigned thread_count = ThreadPool::resolve_thread_count(m_thread_count);
+    m_parser = std::make_unique<XPlaneDatParser>(m_logging_enabled && thread_count == 1, thread_count);
+    m_parser->set_lenient(m_lenient);
+
+    ThreadPool file_pool(thread_count);
+    const size_t parse_window = static_cast<size_t>(thread_count) * 2;
+    std::deque<std::shared_ptr<AptFileStream>> pending_files;
+    // Write groups are sorted on a pool of their own (one task per table, eight tables), since the parse tasks may be
+    // waiting on the writer. With a single thread the writer sorts them itself.
+    std::optional<ThreadPool> sort_pool;
+    if (thread_count > 1) sort_pool.emplace(std::min(thread_count, 8u));
+    size_t next_to_submit = 0;
+    auto submit_parse = [&]() {
+        const fs::path& next_file = write_order[next_to_submit++];
+        prefetch_file(next_file);
+        auto stream = std::make_shared<AptFileStream>(INGEST_QUEUE_CAPACITY);
+        start_producer(file_pool, stream, [this, &next_file](const auto& sink) {
+            m_parser->parse_airport_dat(next_file, sink);
+        });
+        pending_files.push_back(std::move(stream));
     };
-    
-    auto get_or_create_city_id = [this](const std::string& city_name, int state_id, int country_id) -> int {
-        SQLite::Statement select_stmt(*m_db, "SELECT city_id FROM cities WHERE city_name = ? AND state_id = ? AND country_id = ?");
-        select_stmt.bind(1, city_name);
-        select_stmt.bind(2, state_id);
-        select_stmt.bind(3, country_id);
-        if (select_stmt.executeStep()) {
-            return select_stmt.getColumn(0).getInt();
+
+    // Stage statistics
+    std::chrono::steady_clock::duration parse_time{0};          // Parser tasks, excluding time blocked on a full queue
+    std::chrono::steady_clock::duration parser_blocked_time{0};
+    std::chrono::steady_clock::duration write_time{0};
+    std::chrono::steady_clock::duration writer_idle_time{0};    // Writer blocked on an empty queue
+    size_t queue_high_water_mark = 0;
+    size_t batch_count = 0;
+
+    try {
+        int curr_file_num = 0;
+        for (const auto& file : write_order) {
+            while (next_to_submit < write_order.size() && pending_files.size() < parse_window) {
+                submit_parse();
+            }
+
+            if (m_logging_enabled) {
+                curr_file_num++;
+                std::cout << "(" << curr_file_num << "/" << write_order.size() << ") " << file.string() << std::endl;
+            }
+
+            std::shared_ptr<AptFileStream> stream = pending_files.front();
+            bool is_custom_scenery = is_custom_scenery_file(file);
+            int scenery_priority = scenery_priority_of(file);
+            std::unordered_set<std::string> file_airports_written;     // A file that repeats an airport has the last one
+            // The file's airports are written in groups of about WRITE_GROUP_ROWS rows, each sorted by key first
+            std::unique_ptr<ParsedAptData> write_group;
+            auto write_pending = [&]() {
+                if (!write_group) return;
+                insert_parsed_data(*write_group, airports_in_transaction, statements, sort_pool ? &*sort_pool : nullptr);
+                write_group.reset();
+            };
+            m_progress.current_file = file.string();
+            statements.delete_airport_records.bind(1, file.string());
+            statements.delete_airport_records.exec();
+            statements.delete_airport_records.reset();
+            std::vector<std::string> file_airports;
+            while (std::optional<ParsedAptData> batch = stream->batches.pop()) {
+                if (m_logging_enabled && is_custom_scenery) {
+                    const StringColumn& icao = batch->airports.icao;
+                    for (size_t row = 0; row < icao.size(); ++row) {
+                        file_airports.push_back(icao.has_value(row) && !icao.view(row).empty() ? std::string(icao.view(row)) : "[NULL/EMPTY]");
+                    }
+                }
+                auto begin_insertion_time = std::chrono::steady_clock::now();
+                insert_airport_records(batch->airports, file, is_custom_scenery, scenery_priority, statements.insert_airport_record);
+                std::string icao = batch->airports.size() > 0 && batch->airports.icao.has_value(0) ? trimmed_icao(batch->airports.icao.view(0)) : std::string();
+                bool overridden = false;
+                if (!icao.empty()) {
+                    auto higher = unparsed_priorities.find(icao);
+                    bool won_above = airports_in_transaction.count(icao) > 0 && file_airports_written.count(icao) == 0;
+                    overridden = won_above || (higher != unparsed_priorities.end() && higher->second > scenery_priority);
+                }
+                if (overridden) {
+                    write_time += std::chrono::steady_clock::now() - begin_insertion_time;
+                    continue;
+                }
+                if (!icao.empty()) {
+                    bool repeated = file_airports_written.count(icao) > 0;
+                    if (repeated || stored_airports.erase(icao) > 0) {
+                        // The record the file repeats may still be waiting in the write group
+                        if (repeated) write_pending();
+                        delete_statements.execute(icao);
+                        if (m_logging_enabled) {
+                            std::cout << "  -> Replacing existing airport: " << icao << std::endl;
+                        }
+                    }
+                    file_airports_written.insert(icao);
+                }
+                if (!write_group) write_group = std::make_unique<ParsedAptData>();
+                write_group->append(*batch);
+                if (row_count(*write_group) >= WRITE_GROUP_ROWS) write_pending();
+                write_time += std::chrono::steady_clock::now() - begin_insertion_time;
+                batch_count++;
+                m_progress.airports_written += batch->airports.size();
+                if (batch_count % PROGRESS_SAMPLE_BATCHES == 0) {
+                    notify_progress(IngestStage::Ingesting);
+                }
+            }
+            auto begin_insertion_time = std::chrono::steady_clock::now();
+            write_pending();
+            write_time += std::chrono::steady_clock::now() - begin_insertion_time;
+            pending_files.pop_front();
+
+            // Rethrows the parse error if the producer failed (records it in lenient mode)
+            auto producer_time = await_producer(stream->producer, {file});
+            parse_time += producer_time - stream->batches.push_wait_time();
+            parser_blocked_time += stream->batches.push_wait_time();
+            writer_idle_time += stream->batches.pop_wait_time();
+            queue_high_water_mark = std::max(queue_high_water_mark, stream->batches.high_water_mark());
+            m_progress.files_completed++;
+            notify_progress(IngestStage::Ingesting);
+
+            if (m_logging_enabled && is_custom_scenery) {
+                std::cout << "  -> Custom scenery file contains " << file_airports.size() << " airports: ";
+                for (const auto& icao : file_airports) {
+                    std::cout << icao << " ";
+                }
+                std::cout << std::endl;
+            }
         }
-        
-        SQLite::Statement insert_stmt(*m_db, "INSERT INTO cities (city_name, state_id, country_id) VALUES (?, ?, ?)");
-        insert_stmt.bind(1, city_name);
-        insert_stmt.bind(2, state_id);
-        insert_stmt.bind(3, country_id);
-        insert_stmt.executeStep();
-        return static_cast<int>(m_db->getLastInsertRowid());
+    } catch (...) {
+        // Unblock producers still waiting on a full queue so the pool can wind down
+        for (auto& stream : pending_files) {
+            stream->batches.close();
+        }
+        throw;
+    }
+
+    if (m_logging_enabled) {
+        auto elapsed = std::chrono::steady_clock::now() - begin_time;
+        std::cout << "Parsing Completed in " << std::chrono::duration_cast<std::chrono::seconds>(elapsed).count() << " seconds." << std::endl;
+        std::cout << "Total Insertion Time: " << std::chrono::duration_cast<std::chrono::seconds>(write_time).count() << " seconds." << std::endl;
+        std::cout << "Pipeline stages: parse " << to_milliseconds(parse_time) << " ms (" << thread_count << " threads), write "
+                  << to_milliseconds(write_time) << " ms, writer waiting on parsers " << to_milliseconds(writer_idle_time)
+                  << " ms, parsers waiting on writer " << to_milliseconds(parser_blocked_time) << " ms" << std::endl;
+        // parse_time adds up every parser task, so this is the rate of a single parser thread
+        uint64_t lines_parsed = m_parser->lines_parsed();
+        double parse_seconds = std::chrono::duration<double>(parse_time).count();
+        std::cout << "Parse rate: " << lines_parsed << " lines, "
+                  << static_cast<uint64_t>(parse_seconds > 0.0 ? lines_parsed / parse_seconds : 0.0) << " lines/sec per parser thread" << std::endl;
+        std::cout << "Batch queue: " << batch_count << " airport batches, high-water mark " << queue_high_water_mark
+                  << "/" << INGEST_QUEUE_CAPACITY << std::endl;
+        ArenaUsage arenas = m_parser->arena_usage();
+        std::cout << "Parse arenas: " << arenas.arenas_created << " created, largest " << arenas.largest_arena_bytes / 1024
+                  << " KiB, peak live " << arenas.peak_live_bytes / 1024 << " KiB" << std::endl;
+    }
+}
+
+// The nav .dat files go through the same pipeline as an apt.dat file, with one producer. Each file is the complete set
+// of its records for the installation (earth_nav.dat: navaids, earth_fix.dat: fixes, earth_awy.dat: airway segments),
+// so it replaces that table, and the navaid spatial index is rebuilt in one pass once all rows are in rather than
+// updated row by row.
+void NavDataManager::Impl::ingest_nav_files(const std::vector<fs::path>& files_to_parse) {
+    if (files_to_parse.empty()) return;
+    auto begin_time = std::chrono::steady_clock::now();
+    NavInsertStatements statements(*m_db);
+
+    ThreadPool file_pool(1);
+    size_t navaid_count = 0, fix_count = 0, airway_segment_count = 0;
+    bool navaids_replaced = false;
+    for (const auto& file : files_to_parse) {
+        if (m_logging_enabled) {
+            std::cout << "Parsing " << file.string() << "..." << std::endl;
+        }
+        auto stream = std::make_shared<NavFileStream>(INGEST_QUEUE_CAPACITY);
+        const std::string file_name = file.filename().string();
+        if (file_name == "earth_fix.dat") {
+            statements.delete_fixes.exec();
+            fix_count = 0;
+            start_producer(file_pool, stream, [this, &file](const auto& sink) {
+                m_parser->parse_fix_dat(file, sink);
+            });
+        } else if (file_name == "earth_awy.dat") {
+            statements.delete_airway_segments.exec();
+            airway_segment_count = 0;
+            start_producer(file_pool, stream, [this, &file](const auto& sink) {
+                m_parser->parse_awy_dat(file, sink);
+            });
+        } else {
+            statements.delete_navaids.exec();
+            navaid_count = 0;
+            navaids_replaced = true;
+            start_producer(file_pool, stream, [this, &file](const auto& sink) {
+                m_parser->parse_nav_dat(file, sink);
+            });
+        }
+        m_progress.current_file = file.string();
+        try {
+            // A batch only fills the columns of its file's records
+            while (std::optional<ParsedNavData> batch = stream->batches.pop()) {
+                insert_navaids(batch->navaids, statements.insert_navaid);
+                insert_fixes(batch->fixes, statements.insert_fix);
+                insert_airway_segments(batch->airway_segments, statements.insert_airway_segment);
+                navaid_count += batch->navaids.size();
+                fix_count += batch->fixes.size();
+                airway_segment_count += batch->airway_segments.size();
+            }
+        } catch (...) {
+            stream->batches.close();
+            throw;
+        }
+        // Rethrows the parse error if the producer failed (records it in lenient mode)
+        await_producer(stream->producer, {file});
+        m_progress.files_completed++;
+        notify_progress(IngestStage::Ingesting);
+    }
+    if (navaids_replaced) {
+        rebuild_navaid_spatial_index();
+    }
+
+    if (m_logging_enabled) {
+        auto elapsed = std::chrono::steady_clock::now() - begin_time;
+        std::cout << "Navaids: " << navaid_count << ", fixes: " << fix_count << ", airway segments: " << airway_segment_count
+                  << " written in " << to_milliseconds(elapsed) << " ms"
+                  << (m_has_navaid_rtree ? "" : " (no R*Tree support, radius queries use the latitude index)") << std::endl;
+    }
+}
+
+// CIFP files are small and there are tens of thousands of them, so opening and reading them one after the other would
+// dominate the ingest. A parse task takes a run of CIFP_FILES_PER_TASK files, the pool keeps two runs per thread in
+// flight, and this thread drains the runs in order into the open transaction as in ingest_apt_files. The procedures
+// of an airport are replaced as a whole, so its old legs are deleted before its run is written.
+void NavDataManager::Impl::ingest_cifp_files(const std::vector<fs::path>& files_to_parse) {
+    if (files_to_parse.empty()) return;
+    auto begin_time = std::chrono::steady_clock::now();
+    CifpInsertStatements statements(*m_db);
+
+    unsigned thread_count = ThreadPool::resolve_thread_count(m_thread_count);
+    ThreadPool file_pool(thread_count);
+    const size_t parse_window = static_cast<size_t>(thread_count) * 2;
+
+    struct CifpRun {
+        std::vector<fs::path> files;
+        std::shared_ptr<NavFileStream> stream;
+    };
+    std::deque<CifpRun> pending_runs;
+    size_t next_to_submit = 0;
+    auto submit_parse = [&]() {
+        size_t run_end = std::min(files_to_parse.size(), next_to_submit + CIFP_FILES_PER_TASK);
+        CifpRun run{std::vector<fs::path>(files_to_parse.begin() + next_to_submit, files_to_parse.begin() + run_end),
+                    std::make_shared<NavFileStream>(INGEST_QUEUE_CAPACITY)};
+        next_to_submit = run_end;
+        start_producer(file_pool, run.stream, [this, files = run.files](const auto& sink) {
+            m_parser->parse_cifp_files(files, sink);
+        });
+        pending_runs.push_back(std::move(run));
     };
 
-    // Prepare statements
-    SQLite::Statement check_stmt(*m_db, "SELECT icao FROM airports WHERE icao = ?");
-    SQLite::Statement delete_stmt(*m_db, "DELETE FROM airports WHERE icao = ?");
-    SQLite::Statement airport_stmt(*m_db, R"(
-        INSERT OR REPLACE INTO airports
-        (icao, iata, faa, airport_name, elevation, type, latitude, longitude, 
-         country_id, state_id, city_id, region_id, transition_alt, transition_level)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    size_t leg_count = 0;
+    try {
+        while (next_to_submit < files_to_parse.size() || !pending_runs.empty()) {
+            while (next_to_submit < files_to_parse.size() && pending_runs.size() < parse_window) {
+                submit_parse();
+            }
+
+            CifpRun& run = pending_runs.front();
+            // A bulk load starts without procedures, and has one file per airport
+            for (const auto& file : run.files) {
+                if (m_bulk_load) break;
+                statements.delete_procedure_legs.bind(1, file.stem().string());
+                statements.delete_procedure_legs.executeStep();
+                statements.delete_procedure_legs.reset();
+            }
+            m_progress.current_file = run.files.front().string();
+            while (std::optional<ParsedNavData> batch = run.stream->batches.pop()) {
+                insert_procedure_legs(batch->procedure_legs, statements.insert_procedure_leg);
+                leg_count += batch->procedure_legs.size();
+            }
+            // Rethrows the parse error if the producer failed. In lenient mode it is recorded for every file of the run,
+            // whose old legs are all deleted by now.
+            await_producer(run.stream->producer, run.files);
+            m_progress.files_completed += run.files.size();
+            pending_runs.pop_front();
+            notify_progress(IngestStage::Ingesting);
+        }
+    } catch (...) {
+        // Unblock producers still waiting on a full queue so the pool can wind down
+        for (auto& run : pending_runs) {
+            run.stream->batches.close();
+        }
+        throw;
+    }
+
+    if (m_logging_enabled) {
+        auto elapsed = std::chrono::steady_clock::now() - begin_time;
+        std::cout << "Procedures: " << leg_count << " legs of " << files_to_parse.size() << " airports written in "
+                  << to_milliseconds(elapsed) << " ms (" << thread_count << " threads)" << std::endl;
+    }
+}
+
+IngestSummary NavDataManager::Impl::reparse_airport(const std::string& icao) {
+    auto begin_time = std::chrono::steady_clock::now();
+    XPlaneDatParser parser(false, 1);
+    parser.set_lenient(m_lenient);
+
+    IngestSummary summary;
+    try {
+        SQLite::Transaction transaction(*m_db);
+        AptInsertStatements statements(*m_db);
+        AirportDeleteStatements delete_statements(*m_db);
+        summary.airports_written = replace_indexed_airport(icao, parser, delete_statements, statements);
+        transaction.commit();
+    } catch (...) {
+        m_locations->discard_uncommitted();
+        throw;
+    }
+    m_locations->commit();
+    finish_reparse(parser, summary, icao, begin_time);
+    return summary;
+}
+
+IngestSummary NavDataManager::Impl::reparse_package(const fs::path& package_path) {
+    // A package directory is resolved to its apt.dat the way the scan does, the shortest path wins
+    fs::path file;
+    if (fs::is_directory(package_path)) {
+        for (const auto& entry : fs::recursive_directory_iterator(package_path)) {
+            if (entry.is_regular_file() && is_apt_dat_file(entry.path()) &&
+                (file.empty() || entry.path().string().length() < file.string().length())) {
+                file = entry.path();
+            }
+        }
+    } else if (fs::is_regular_file(package_path) && is_apt_dat_file(package_path)) {
+        file = package_path;
+    }
+    if (file.empty()) {
+        throw std::invalid_argument("No apt.dat found in scenery package: " + package_path.string());
+    }
+
+    auto begin_time = std::chrono::steady_clock::now();
+    XPlaneDatParser parser(false, ThreadPool::resolve_thread_count(m_thread_count));
+    parser.set_lenient(m_lenient);
+
+    IngestSummary summary;
+    try {
+        SQLite::Transaction transaction(*m_db);
+        AptInsertStatements statements(*m_db);
+        AirportDeleteStatements delete_statements(*m_db);
+        bool is_custom_scenery = is_custom_scenery_file(file);
+        summary.airports_written = write_apt_file(file, is_custom_scenery, std::nullopt, parser, delete_statements, statements);
+        transaction.commit();
+    } catch (...) {
+        m_locations->discard_uncommitted();
+        throw;
+    }
+    m_locations->commit();
+    finish_reparse(parser, summary, file.string(), begin_time);
+    return summary;
+}
+
+// A targeted reparse reads just the airport's record: the index gives the file and offset it was last written from
+// (the one highest in the scenery order, which is the one in the database). If the file has changed around the record,
+// the whole file is parsed instead and indexed again.
+size_t NavDataManager::Impl::replace_indexed_airport(const std::string& icao, XPlaneDatParser& parser, AirportDeleteStatements& delete_statements, AptInsertStatements& statements) {
+    SQLite::Statement find_record(*m_db, std::string(R"(
+        SELECT source_file, byte_offset, byte_length, first_line, is_custom_scenery, scenery_priority FROM airport_records
+        WHERE airport_icao = ? )") + CURRENT_RECORD_ORDER);
+    find_record.bind(1, icao);
+    if (!find_record.executeStep()) {
+        throw std::invalid_argument("Airport not indexed: " + icao);
+    }
+    fs::path file = find_record.getColumn(0).getString();
+    AptRecordSpan span{static_cast<uint64_t>(find_record.getColumn(1).getInt64()), static_cast<uint64_t>(find_record.getColumn(2).getInt64()),
+                       find_record.getColumn(3).getInt()};
+    bool is_custom_scenery = find_record.getColumn(4).getInt() != 0;
+    int scenery_priority = find_record.getColumn(5).getInt();
+
+    std::vector<ParsedAptData> batches;
+    bool record_found = parser.parse_airport_record(file, span, [&batches](ParsedAptData&& batch) { batches.push_back(std::move(batch)); });
+    // The record must still be the airport's: an edit earlier in the file moves the records after it
+    record_found = record_found && std::any_of(batches.begin(), batches.end(), [&icao](const ParsedAptData& batch) {
+        const StringColumn& icaos = batch.airports.icao;
+        for (size_t row = 0; row < icaos.size(); ++row) {
+            if (icaos.has_value(row) && trimmed_icao(icaos.view(row)) == icao) return true;
+        }
+        return false;
+    });
+    if (!record_found) {
+        if (m_logging_enabled) {
+            std::cout << "Record of " << icao << " moved in " << file.string() << ", parsing the whole file" << std::endl;
+        }
+        return write_apt_file(file, is_custom_scenery, icao, parser, delete_statements, statements);
+    }
+
+    size_t airports_written = 0;
+    for (const auto& batch : batches) {
+        airports_written += replace_airports(batch, delete_statements, statements);
+        insert_airport_records(batch.airports, file, is_custom_scenery, scenery_priority, statements.insert_airport_record);
+    }
+    return airports_written;
+}
+
+// Batches are written as the parser delivers them. The airports that a file higher in the scenery order also has are
+// left alone, as the full ingest would have.
+size_t NavDataManager::Impl::write_apt_file(const fs::path& file, bool is_custom_scenery, const std::optional<std::string>& only_icao,
+                                            XPlaneDatParser& parser, AirportDeleteStatements& delete_statements, AptInsertStatements& statements) {
+    int scenery_priority = scenery_priority_of(file);
+    SQLite::Statement check_override(*m_db, R"(
+        SELECT 1 FROM airport_records
+        WHERE airport_icao = ? AND source_file <> ? AND (scenery_priority, is_custom_scenery) > (?, ?) LIMIT 1
     )");
+    statements.delete_airport_records.bind(1, file.string());
+    statements.delete_airport_records.exec();
+    statements.delete_airport_records.reset();
+
+    size_t airports_written = 0;
+    parser.parse_airport_dat(file, [&](ParsedAptData&& batch) {
+        insert_airport_records(batch.airports, file, is_custom_scenery, scenery_priority, statements.insert_airport_record);
+        if (batch.airports.size() == 0) return;
+        std::string icao = trimmed_icao(batch.airports.icao.has_value(0) ? batch.airports.icao.view(0) : std::string_view());
+        if (only_icao && icao != *only_icao) return;
+        check_override.bind(1, icao);
+        check_override.bind(2, file.string());
+        check_override.bind(3, scenery_priority);
+        check_override.bind(4, is_custom_scenery ? 1 : 0);
+        bool overridden = check_override.executeStep();
+        check_override.reset();
+        if (overridden) return;
+        airports_written += replace_airports(batch, delete_statements, statements);
+    });
+    return airports_written;
+}
 
-    // DEBUG: Log what airports are in this file
-    if (m_logging_enabled && is_custom_scenery) {
-        std::cout << "  -> Custom scenery file contains " << airports.size() << " airports: ";
-        for (const auto& airport : airports) {
-            if (airport.icao && !airport.icao->empty()) {
-                std::cout << *airport.icao << " ";
-            } else {
-                std::cout << "[NULL/EMPTY] ";
+size_t NavDataManager::Impl::replace_airports(const ParsedAptData& batch, AirportDeleteStatements& delete_statements, AptInsertStatements& statements) {
+    size_t airports_written = 0;
+    for (size_t row = 0; row < batch.airports.size(); ++row) {
+        if (!batch.airports.icao.has_value(row)) continue;
+        std::string icao = trimmed_icao(batch.airports.icao.view(row));
+        if (icao.empty()) continue;
+        delete_statements.execute(icao);
+        airports_written++;
+    }
+    std::unordered_set<std::string> airports_in_transaction;
+    insert_parsed_data(batch, airports_in_transaction, statements);
+    return airports_written;
+}
+
+void NavDataManager::Impl::finish_reparse(XPlaneDatParser& parser, IngestSummary& summary, const std::string& what, std::chrono::steady_clock::time_point begin_time) {
+    if (airway_router) {
+        airway_router->invalidate();
+    }
+    summary.files_parsed = 1;
+    summary.lines_parsed = parser.lines_parsed();
+    summary.diagnostics = parser.take_diagnostics();
+    std::sort(summary.diagnostics.begin(), summary.diagnostics.end(), [](const IngestDiagnostic& a, const IngestDiagnostic& b) {
+        return a.line < b.line;
+    });
+    if (m_logging_enabled) {
+        std::cout << "Reparsed " << what << ": " << summary.airports_written << " airports, " << summary.lines_parsed
+                  << " lines in " << to_milliseconds(std::chrono::steady_clock::now() - begin_time) << " ms" << std::endl;
+        for (const auto& diagnostic : summary.diagnostics) {
+            std::cout << "  " << diagnostic.file << ":" << diagnostic.line << " (row code " << diagnostic.row_code
+                      << "): " << diagnostic.reason << std::endl;
+        }
+    }
+}
+
+// A file whose size and mtime match its row is taken as unchanged without reading it. Otherwise its contents are
+// hashed, so a file that was only touched (copied, re-extracted) is not parsed again. Rows written before the stats
+// were tracked have none; those files are taken as unchanged, as they were before, and their stats filled in.
+SceneryFileCheck NavDataManager::Impl::check_scenery_file(const fs::path& file) {
+    std::error_code ec;
+    int64_t file_size = static_cast<int64_t>(fs::file_size(file, ec));
+    if (ec) file_size = -1;
+    int64_t modified_time = static_cast<int64_t>(fs::last_write_time(file, ec).time_since_epoch().count());
+    if (ec) modified_time = 0;
+
+    SQLite::Statement select_stmt(*m_db, "SELECT file_size, modified_time, content_hash FROM scenery_paths WHERE scenery_path = ?");
+    select_stmt.bind(1, file.string());
+    if (select_stmt.executeStep()) {
+        bool has_stats = !select_stmt.getColumn(2).isNull();
+        uint64_t stored_hash = static_cast<uint64_t>(select_stmt.getColumn(2).getInt64());
+        if (has_stats && select_stmt.getColumn(0).getInt64() == file_size && select_stmt.getColumn(1).getInt64() == modified_time) {
+            return {FileChange::Unchanged, stored_hash};
+        }
+        uint64_t content_hash = hash_file_contents(file);
+        SQLite::Statement update_stmt(*m_db, "UPDATE scenery_paths SET file_size = ?, modified_time = ?, content_hash = ? WHERE scenery_path = ?");
+        update_stmt.bind(1, file_size);
+        update_stmt.bind(2, modified_time);
+        update_stmt.bind(3, static_cast<int64_t>(content_hash));
+        update_stmt.bind(4, file.string());
+        update_stmt.executeStep();
+        bool unchanged = !has_stats || content_hash == stored_hash;
+        return {unchanged ? FileChange::Unchanged : FileChange::Changed, content_hash};
+    }
+
+    // If not, create a new record for the scenery path
+    uint64_t content_hash = hash_file_contents(file);
+    SQLite::Statement insert_stmt(*m_db, "INSERT INTO scenery_paths (scenery_path, file_size, modified_time, content_hash) VALUES (?, ?, ?, ?)");
+    insert_stmt.bind(1, file.string());
+    insert_stmt.bind(2, file_size);
+    insert_stmt.bind(3, modified_time);
+    insert_stmt.bind(4, static_cast<int64_t>(content_hash));
+    insert_stmt.executeStep();
+    return {FileChange::New, content_hash};
+}
+
+// A removed apt.dat's airports are deleted, and put back from the next record of each (Global Airports under a removed
+// override) once the ingest has run, see restore_orphaned_airports(). So are those of an apt.dat the scan no longer
+// found, such as one in a package disabled in scenery_packs.ini. A removed CIFP file takes its airport's procedures
+// along. A removed nav .dat file's table is replaced by the copy that takes over from it.
+size_t NavDataManager::Impl::retract_removed_files(std::unordered_set<std::string>& retracted_keys, std::unordered_set<std::string>& orphaned_airports) {
+    std::vector<fs::path> removed_files;
+    bool scanned = !m_custom_scenery_path.empty();
+    SQLite::Statement select_paths(*m_db, "SELECT scenery_path FROM scenery_paths");
+    while (select_paths.executeStep()) {
+        fs::path file = select_paths.getColumn(0).getString();
+        std::error_code ec;
+        bool removed = !fs::exists(file, ec) && !ec;
+        bool left_out = scanned && is_apt_dat_file(file) && m_apt_priorities.count(file.string()) == 0;
+        if (removed || left_out) {
+            removed_files.push_back(file);
+        }
+    }
+
+    SQLite::Statement forget_file(*m_db, "DELETE FROM scenery_paths WHERE scenery_path = ?");
+    SQLite::Statement delete_records(*m_db, "DELETE FROM airport_records WHERE source_file = ?");
+    SQLite::Statement delete_procedures(*m_db, "DELETE FROM procedure_legs WHERE airport_icao = ?");
+    for (const auto& file : removed_files) {
+        if (is_apt_dat_file(file)) {
+            for (auto& icao : current_airports_of(file)) {
+                orphaned_airports.insert(std::move(icao));
             }
+            delete_records.bind(1, file.string());
+            delete_records.exec();
+            delete_records.reset();
+        } else {
+            if (is_cifp_file(file)) {
+                delete_procedures.bind(1, file.stem().string());
+                delete_procedures.exec();
+                delete_procedures.reset();
+            }
+            retracted_keys.insert(replacement_key(file));
         }
-        std::cout << std::endl;
+        forget_file.bind(1, file.string());
+        forget_file.exec();
+        forget_file.reset();
+        if (m_logging_enabled) {
+            std::cout << "File: [" << file.string() << "] was removed or disabled, its data is retracted." << std::endl;
+        }
+    }
+    return removed_files.size();
+}
+
+// Position of an apt.dat in the scenery order of the last scan. Without a scan (a reparse right after connecting), the
+// priority its records were indexed with.
+int NavDataManager::Impl::scenery_priority_of(const fs::path& file) {
+    auto found = m_apt_priorities.find(file.string());
+    if (found != m_apt_priorities.end()) return found->second;
+    SQLite::Statement select_priority(*m_db, "SELECT MAX(scenery_priority) FROM airport_records WHERE source_file = ?");
+    select_priority.bind(1, file.string());
+    if (select_priority.executeStep() && !select_priority.getColumn(0).isNull()) {
+        return select_priority.getColumn(0).getInt();
+    }
+    return 0;
+}
+
+// Moves the records of the scanned apt.dat files to their place in the current scenery order. An airport that more
+// than one file has may change hands when packages are reordered in scenery_packs.ini, and is then put back from its
+// new winner like the airports of a removed file.
+void NavDataManager::Impl::apply_scenery_priorities(std::unordered_set<std::string>& orphaned_airports) {
+    auto current_sources = [this]() {
+        std::unordered_map<std::string, std::string> sources;
+        SQLite::Statement select_sources(*m_db, std::string(R"(
+            SELECT airport_icao, source_file FROM airport_records AS record
+            WHERE airport_icao IN (SELECT airport_icao FROM airport_records GROUP BY airport_icao HAVING COUNT(*) > 1)
+            AND record_id = (SELECT record_id FROM airport_records WHERE airport_icao = record.airport_icao )") + CURRENT_RECORD_ORDER + ")");
+        while (select_sources.executeStep()) {
+            sources.emplace(select_sources.getColumn(0).getString(), select_sources.getColumn(1).getString());
+        }
+        return sources;
+    };
+
+    SQLite::Statement update_priority(*m_db, "UPDATE airport_records SET scenery_priority = ? WHERE source_file = ? AND scenery_priority <> ?");
+    std::unordered_map<std::string, std::string> sources_before;
+    bool loaded = false;
+    for (const auto& file : m_all_apt_files) {
+        int priority = m_apt_priorities[file.string()];
+        update_priority.bind(1, priority);
+        update_priority.bind(2, file.string());
+        update_priority.bind(3, priority);
+        // The winners are only worked out when something moved, before the first update
+        if (!loaded) {
+            SQLite::Statement check_moved(*m_db, "SELECT 1 FROM airport_records WHERE source_file = ? AND scenery_priority <> ? LIMIT 1");
+            check_moved.bind(1, file.string());
+            check_moved.bind(2, priority);
+            if (check_moved.executeStep()) {
+                sources_before = current_sources();
+                loaded = true;
+            }
+        }
+        update_priority.exec();
+        update_priority.reset();
+    }
+    if (!loaded) return;
+
+    size_t moved = 0;
+    for (const auto& [icao, source] : current_sources()) {
+        auto before = sources_before.find(icao);
+        if (before != sources_before.end() && before->second != source) {
+            orphaned_airports.insert(icao);
+            moved++;
+        }
+    }
+    if (m_logging_enabled && moved > 0) {
+        std::cout << "Scenery order changed, " << moved << " airports move to another package" << std::endl;
     }
+}
+
+// Airports whose rows in the database came from this file
+std::vector<std::string> NavDataManager::Impl::current_airports_of(const fs::path& file) {
+    SQLite::Statement select_airports(*m_db, std::string(R"(
+        SELECT airport_icao FROM airport_records AS record WHERE source_file = ? AND record_id = (
+            SELECT record_id FROM airport_records WHERE airport_icao = record.airport_icao )") + CURRENT_RECORD_ORDER + ")");
+    select_airports.bind(1, file.string());
+    std::vector<std::string> airports;
+    while (select_airports.executeStep()) {
+        airports.push_back(select_airports.getColumn(0).getString());
+    }
+    return airports;
+}
+
+// Airports taken from removed or changed files that no file wrote again in this run. Each one is deleted, and if
+// another file still has a record of it, read from there.
+void NavDataManager::Impl::restore_orphaned_airports(const std::unordered_set<std::string>& orphaned_airports, const std::unordered_set<std::string>& airports_in_transaction) {
+    std::vector<std::string> airports;
+    for (const auto& icao : orphaned_airports) {
+        if (airports_in_transaction.count(icao) == 0) airports.push_back(icao);
+    }
+    if (airports.empty()) return;
+    std::sort(airports.begin(), airports.end());
+
+    XPlaneDatParser parser(false, 1);
+    parser.set_lenient(m_lenient);
+    AptInsertStatements statements(*m_db);
+    AirportDeleteStatements delete_statements(*m_db);
+    SQLite::Statement has_record(*m_db, "SELECT 1 FROM airport_records WHERE airport_icao = ? LIMIT 1");
+    size_t restored = 0;
+    for (const auto& icao : airports) {
+        has_record.bind(1, icao);
+        bool indexed = has_record.executeStep();
+        has_record.reset();
+        if (indexed) {
+            restored += replace_indexed_airport(icao, parser, delete_statements, statements);
+        } else {
+            delete_statements.execute(icao);
+        }
+    }
+    std::vector<IngestDiagnostic> diagnostics = parser.take_diagnostics();
+    m_file_diagnostics.insert(m_file_diagnostics.end(), diagnostics.begin(), diagnostics.end());
+
+    if (m_logging_enabled) {
+        std::cout << "Retracted " << airports.size() - restored << " airports, restored " << restored
+                  << " from the next scenery that has them" << std::endl;
+    }
+}
+
+// A byte-identical apt.dat has the same records, so the copy is indexed from the file that was parsed
+void NavDataManager::Impl::copy_airport_records(const std::vector<std::pair<fs::path, fs::path>>& duplicate_apt_files) {
+    if (duplicate_apt_files.empty()) return;
+    SQLite::Statement delete_records(*m_db, "DELETE FROM airport_records WHERE source_file = ?");
+    SQLite::Statement copy_records(*m_db, R"(
+        INSERT OR REPLACE INTO airport_records
+        (source_file, airport_icao, byte_offset, byte_length, first_line, is_custom_scenery, scenery_priority)
+        SELECT ?, airport_icao, byte_offset, byte_length, first_line, ?, ? FROM airport_records WHERE source_file = ?
+    )");
+    for (const auto& [duplicate, source] : duplicate_apt_files) {
+        delete_records.bind(1, duplicate.string());
+        delete_records.exec();
+        delete_records.reset();
+        copy_records.bind(1, duplicate.string());
+        copy_records.bind(2, is_custom_scenery_file(duplicate) ? 1 : 0);
+        copy_records.bind(3, scenery_priority_of(duplicate));
+        copy_records.bind(4, source.string());
+        copy_records.exec();
+        copy_records.reset();
+    }
+}
+
+void NavDataManager::Impl::insert_parsed_data(const ParsedAptData& data, std::unordered_set<std::string>& airports_in_transaction, AptInsertStatements& statements,
+                                              ThreadPool* sort_pool) {
+    AptKeyOrder order = sort_by_key(data, sort_pool);
+    insert_airports(data.airports, order.airports, airports_in_transaction, statements);
+    insert_runways(data.runways, data.airport_ids, order.runways, statements.insert_runway);
+    insert_taxiway_nodes(data.taxiway_nodes, data.airport_ids, order.taxiway_nodes, statements.insert_taxi_node);
+    insert_taxiway_edges(data.taxiway_edges, data.airport_ids, order.taxiway_edges, statements.insert_taxi_edge);
+    insert_linear_features(data.linear_features, data.airport_ids, order.linear_features, statements.insert_linear_feature);
+    insert_linear_feature_nodes(data.linear_feature_nodes, data.airport_ids, order.linear_feature_nodes, statements.insert_linear_feature_node);
+    insert_taxiway_signs(data.taxiway_signs, data.airport_ids, order.taxiway_signs, statements.insert_taxiway_sign);
+    insert_startup_locations(data.startup_locations, data.airport_ids, order.startup_locations, statements.insert_startup_location);
+}
+
+void NavDataManager::Impl::insert_airports(const AirportColumns& airports, const std::vector<uint32_t>& order, std::unordered_set<std::string>& airports_in_transaction, AptInsertStatements& statements) {
+    LocationDictionary& locations = *m_locations;
+    SQLite::Statement& airport_stmt = statements.insert_airport;
     
     // Process each airport individually
-    for (const auto& airport : airports) {
+    for (size_t row : order) {
         // Skip airports without ICAO (required field)
-        if (!airport.icao || airport.icao->empty()) {
+        if (!airports.icao.has_value(row) || airports.icao.view(row).empty()) {
             continue;
         }
 
         // TRIM THE ICAO CODE TO REMOVE HIDDEN CHARACTERS
-        std::string clean_icao = *airport.icao;
+        std::string clean_icao(airports.icao.view(row));
         // Remove whitespace, carriage returns, newlines from both ends
         clean_icao.erase(0, clean_icao.find_first_not_of(" \t\r\n"));
         clean_icao.erase(clean_icao.find_last_not_of(" \t\r\n") + 1);
 
-        if (is_custom_scenery) {
-            // Use cleaned ICAO for database operations
-            check_stmt.bind(1, clean_icao);
-            bool airport_exists_in_db = check_stmt.executeStep();
-            check_stmt.reset();
-
-            bool airport_exists = airport_exists_in_db || airports_in_transaction.count(clean_icao) > 0;
-
-            if (airport_exists) {
-                delete_stmt.bind(1, clean_icao);
-                delete_stmt.executeStep();
-                delete_stmt.reset();
-
-                if (m_logging_enabled) {
-                    std::cout << "  -> Replacing existing airport: " << clean_icao << std::endl;
-                }
-            }
-        }
-        
         // Resolve foreign key IDs
         std::optional<int> country_id, state_id, city_id, region_id;
+        auto has_text = [row](const StringColumn& column) { return column.has_value(row) && !column.view(row).empty(); };
         
         // Get country ID if country exists
-        if (airport.country && !airport.country->empty()) {
-            country_id = get_or_create_country_id(*airport.country);
+        if (has_text(airports.country)) {
+            country_id = locations.country_id(airports.country.c_str(row));
         }
         
         // Get region ID if region exists
-        if (airport.region && !airport.region->empty()) {
-            region_id = get_or_create_region_id(*airport.region);
+        if (has_text(airports.region)) {
+            region_id = locations.region_id(airports.region.c_str(row));
         }
         
         // Get state ID if state exists (requires country)
-        if (airport.state && !airport.state->empty() && country_id) {
-            state_id = get_or_create_state_id(*airport.state, *country_id);
+        if (has_text(airports.state) && country_id) {
+            state_id = locations.state_id(airports.state.c_str(row), *country_id);
         }
         
         // Get city ID if city exists (requires state and country)
-        if (airport.city && !airport.city->empty() && state_id && country_id) {
-            city_id = get_or_create_city_id(*airport.city, *state_id, *country_id);
+        if (has_text(airports.city) && state_id && country_id) {
+            city_id = locations.city_id(airports.city.c_str(row), *state_id, *country_id);
         }
         
         // Bind airport data
-        airport.icao ? airport_stmt.bind(1, *airport.icao) : airport_stmt.bind(1);
-        airport.iata ? airport_stmt.bind(2, *airport.iata) : airport_stmt.bind(2);
-        airport.faa ? airport_stmt.bind(3, *airport.faa) : airport_stmt.bind(3);
-        airport.airport_name ? airport_stmt.bind(4, *airport.airport_name) : airport_stmt.bind(4);
-        airport.elevation ? airport_stmt.bind(5, *airport.elevation) : airport_stmt.bind(5);
-        airport.type ? airport_stmt.bind(6, *airport.type) : airport_stmt.bind(6);
-        airport.latitude ? airport_stmt.bind(7, *airport.latitude) : airport_stmt.bind(7);
-        airport.longitude ? airport_stmt.bind(8, *airport.longitude) : airport_stmt.bind(8);
+        bind_text(airport_stmt, 1, airports.icao, row);
+        bind_text(airport_stmt, 2, airports.iata, row);
+        bind_text(airport_stmt, 3, airports.faa, row);
+        bind_text(airport_stmt, 4, airports.airport_name, row);
+        bind_value(airport_stmt, 5, airports.elevation, row);
+        bind_text(airport_stmt, 6, airports.type, row);
+        bind_value(airport_stmt, 7, airports.latitude, row);
+        bind_value(airport_stmt, 8, airports.longitude, row);
         
         // Bind foreign key IDs
         country_id ? airport_stmt.bind(9, *country_id) : airport_stmt.bind(9);
@@ -379,233 +1812,306 @@ void NavDataManager::Impl::insert_airports(const std::vector<AirportMeta>& airpo
         region_id ? airport_stmt.bind(12, *region_id) : airport_stmt.bind(12);
         
         // Bind transition fields
-        airport.transition_alt ? airport_stmt.bind(13, *airport.transition_alt) : airport_stmt.bind(13);
-        airport.transition_level ? airport_stmt.bind(14, *airport.transition_level) : airport_stmt.bind(14);
+        bind_text(airport_stmt, 13, airports.transition_alt, row);
+        bind_text(airport_stmt, 14, airports.transition_level, row);
         
         airport_stmt.executeStep();
         airport_stmt.reset();
 
         // Track this airport as inserted in the current transaction
-        airports_in_transaction.insert(*airport.icao);
+        airports_in_transaction.insert(clean_icao);
     }
 }
 
-void NavDataManager::Impl::insert_runways(const std::vector<RunwayData>& runways) {
-    SQLite::Statement stmt(*m_db, R"(
-        INSERT OR REPLACE INTO runways
-        (airport_icao, width, surface, end1_rw_number, end1_lat, end1_lon, end1_d_threshold, end1_rw_marking_code, end1_rw_app_light_code, 
-         end2_rw_number, end2_lat, end2_lon, end2_d_threshold, end2_rw_marking_code, end2_rw_app_light_code)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-
-    for (const auto& runway: runways) {
-        runway.airport_icao ? stmt.bind(1, *runway.airport_icao) : stmt.bind(1);
-        runway.width ? stmt.bind(2, *runway.width) : stmt.bind(2);
-        runway.surface ? stmt.bind(3, *runway.surface) : stmt.bind(3);
-        runway.end1_rw_number ? stmt.bind(4, *runway.end1_rw_number) : stmt.bind(4);
-        runway.end1_lat ? stmt.bind(5, *runway.end1_lat) : stmt.bind(5);
-        runway.end1_lon ? stmt.bind(6, *runway.end1_lon) : stmt.bind(6);
-        runway.end1_d_threshold ? stmt.bind(7, *runway.end1_d_threshold) : stmt.bind(7);
-        runway.end1_rw_marking_code ? stmt.bind(8, *runway.end1_rw_marking_code) : stmt.bind(8);
-        runway.end1_rw_app_light_code ? stmt.bind(9, *runway.end1_rw_app_light_code) : stmt.bind(9);
-        runway.end2_rw_number ? stmt.bind(10, *runway.end2_rw_number) : stmt.bind(10);
-        runway.end2_lat ? stmt.bind(11, *runway.end2_lat) : stmt.bind(11);
-        runway.end2_lon ? stmt.bind(12, *runway.end2_lon) : stmt.bind(12);
-        runway.end2_d_threshold ? stmt.bind(13, *runway.end2_d_threshold) : stmt.bind(13);
-        runway.end2_rw_marking_code ? stmt.bind(14, *runway.end2_rw_marking_code) : stmt.bind(14);
-        runway.end2_rw_app_light_code ? stmt.bind(15, *runway.end2_rw_app_light_code) : stmt.bind(15);
-
+void NavDataManager::Impl::insert_airport_records(const AirportColumns& airports, const fs::path& file, bool is_custom_scenery, int scenery_priority, SQLite::Statement& stmt) {
+    std::string source_file = file.string();
+    for (size_t row = 0; row < airports.size(); ++row) {
+        if (!airports.icao.has_value(row)) continue;
+        std::string icao = trimmed_icao(airports.icao.view(row));
+        if (icao.empty()) continue;
+        const AptRecordSpan& span = airports.record[row];
+        stmt.bind(1, source_file);
+        stmt.bind(2, icao);
+        stmt.bind(3, static_cast<int64_t>(span.offset));
+        stmt.bind(4, static_cast<int64_t>(span.length));
+        stmt.bind(5, span.first_line);
+        stmt.bind(6, is_custom_scenery ? 1 : 0);
+        stmt.bind(7, scenery_priority);
         stmt.executeStep();
         stmt.reset();
     }
 }
 
-void NavDataManager::Impl::insert_taxiway_nodes(const std::vector<TaxiwayNodeData>& taxiway_nodes) {
-    SQLite::Statement stmt(*m_db, R"(
-        INSERT OR REPLACE INTO taxi_nodes
-        (node_id, airport_icao, latitude, longitude, node_type)
-        VALUES (?, ?, ?, ?, ?)
-    )");
-
-    for (const auto& taxi_node : taxiway_nodes) {
-        taxi_node.node_id ? stmt.bind(1, *taxi_node.node_id) : stmt.bind(1);
-        taxi_node.airport_icao ? stmt.bind(2, *taxi_node.airport_icao) : stmt.bind(2);
-        taxi_node.latitude ? stmt.bind(3, *taxi_node.latitude) : stmt.bind(3);
-        taxi_node.longitude ? stmt.bind(4, *taxi_node.longitude) : stmt.bind(4);
-        taxi_node.node_type ? stmt.bind(5, *taxi_node.node_type) : stmt.bind(5);
+void NavDataManager::Impl::insert_runways(const RunwayColumns& runways, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airport_ids.c_str(runways.airport[row]));
+        stmt.bind(offset + 2, runways.width[row]);
+        stmt.bind(offset + 3, runways.surface[row]);
+        stmt.bindNoCopy(offset + 4, runways.end1.rw_number.c_str(row));
+        stmt.bind(offset + 5, runways.end1.latitude[row]);
+        stmt.bind(offset + 6, runways.end1.longitude[row]);
+        stmt.bind(offset + 7, runways.end1.d_threshold[row]);
+        stmt.bind(offset + 8, runways.end1.rw_marking_code[row]);
+        stmt.bind(offset + 9, runways.end1.rw_app_light_code[row]);
+        stmt.bindNoCopy(offset + 10, runways.end2.rw_number.c_str(row));
+        stmt.bind(offset + 11, runways.end2.latitude[row]);
+        stmt.bind(offset + 12, runways.end2.longitude[row]);
+        stmt.bind(offset + 13, runways.end2.d_threshold[row]);
+        stmt.bind(offset + 14, runways.end2.rw_marking_code[row]);
+        stmt.bind(offset + 15, runways.end2.rw_app_light_code[row]);
+    });
+}
 
-        stmt.executeStep();
-        stmt.reset();
-    }
+void NavDataManager::Impl::insert_taxiway_nodes(const TaxiwayNodeColumns& taxiway_nodes, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bind(offset + 1, taxiway_nodes.node_id[row]);
+        stmt.bindNoCopy(offset + 2, airport_ids.c_str(taxiway_nodes.airport[row]));
+        stmt.bind(offset + 3, taxiway_nodes.latitude[row]);
+        stmt.bind(offset + 4, taxiway_nodes.longitude[row]);
+        stmt.bindNoCopy(offset + 5, taxiway_nodes.node_type.c_str(row));
+    });
 }
 
-void NavDataManager::Impl::insert_taxiway_edges(const std::vector<TaxiwayEdgeData>& taxiway_edges) {
-    SQLite::Statement stmt(*m_db, R"(
-        INSERT OR REPLACE INTO taxi_edges
-        (airport_icao, start_node_id, end_node_id, is_two_way, taxiway_name, width_class)
-        VALUES (?, ?, ?, ?, ?, ?)
-    )");
+void NavDataManager::Impl::insert_taxiway_edges(const TaxiwayEdgeColumns& taxiway_edges, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airport_ids.c_str(taxiway_edges.airport[row]));
+        stmt.bind(offset + 2, taxiway_edges.start_node_id[row]);
+        stmt.bind(offset + 3, taxiway_edges.end_node_id[row]);
+        stmt.bind(offset + 4, static_cast<int>(taxiway_edges.is_two_way[row]));
+        bind_text(stmt, offset + 5, taxiway_edges.taxiway_name, row);
+        bind_text(stmt, offset + 6, taxiway_edges.width_class, row);
+    });
+}
 
-    for (const auto& taxi_edge : taxiway_edges) {
-        taxi_edge.airport_icao ? stmt.bind(1, *taxi_edge.airport_icao) : stmt.bind(1);
-        taxi_edge.start_node_id ? stmt.bind(2, *taxi_edge.start_node_id) : stmt.bind(2);
-        taxi_edge.end_node_id ? stmt.bind(3, *taxi_edge.end_node_id) : stmt.bind(3);
-        taxi_edge.is_two_way ? stmt.bind(4, *taxi_edge.is_two_way) : stmt.bind(4);
-        taxi_edge.taxiway_name ? stmt.bind(5, *taxi_edge.taxiway_name) : stmt.bind(5);
-        taxi_edge.width_class ? stmt.bind(6, *taxi_edge.width_class) : stmt.bind(6);
+void NavDataManager::Impl::insert_linear_features(const LinearFeatureColumns& linear_features, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airport_ids.c_str(linear_features.airport[row]));
+        stmt.bind(offset + 2, linear_features.feature_sequence[row]);
+        bind_text(stmt, offset + 3, linear_features.line_type, row);
+    });
+}
 
-        stmt.executeStep();
-        stmt.reset();
-    }
+void NavDataManager::Impl::insert_linear_feature_nodes(const LinearFeatureNodeColumns& linear_feature_nodes, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airport_ids.c_str(linear_feature_nodes.airport[row]));
+        stmt.bind(offset + 2, linear_feature_nodes.feature_sequence[row]);
+        stmt.bind(offset + 3, linear_feature_nodes.latitude[row]);
+        stmt.bind(offset + 4, linear_feature_nodes.longitude[row]);
+        bind_value(stmt, offset + 5, linear_feature_nodes.bezier_latitude, row);
+        bind_value(stmt, offset + 6, linear_feature_nodes.bezier_longitude, row);
+        stmt.bind(offset + 7, linear_feature_nodes.node_order[row]);
+    });
 }
 
-void NavDataManager::Impl::insert_linear_features(const std::vector<LinearFeatureData>& linear_features) {
-    SQLite::Statement stmt(*m_db, R"(
-        INSERT OR REPLACE INTO linear_features
-        (airport_icao, feature_sequence, line_type)
-        VALUES(?, ?, ?)
-    )");
+void NavDataManager::Impl::insert_taxiway_signs(const TaxiwaySignColumns& taxiway_signs, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airport_ids.c_str(taxiway_signs.airport[row]));
+        stmt.bind(offset + 2, taxiway_signs.latitude[row]);
+        stmt.bind(offset + 3, taxiway_signs.longitude[row]);
+        stmt.bind(offset + 4, taxiway_signs.heading[row]);
+        bind_text(stmt, offset + 5, taxiway_signs.sign_text, row);
+        stmt.bind(offset + 6, taxiway_signs.size_class[row]);
+    });
+}
 
-    for (const auto& feature : linear_features) {
-        feature.airport_icao ? stmt.bind(1, *feature.airport_icao) : stmt.bind(1);
-        feature.feature_sequence ? stmt.bind(2, *feature.feature_sequence) : stmt.bind(2);
-        feature.line_type ? stmt.bind(3, *feature.line_type) : stmt.bind(3);
+void NavDataManager::Impl::insert_startup_locations(const StartupLocationColumns& startup_locations, const AirportIdTable& airport_ids, const std::vector<uint32_t>& order, MultiRowInsert& insert) {
+    insert.write(order, [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airport_ids.c_str(startup_locations.airport[row]));
+        stmt.bind(offset + 2, startup_locations.latitude[row]);
+        stmt.bind(offset + 3, startup_locations.longitude[row]);
+        stmt.bind(offset + 4, startup_locations.heading[row]);
+        bind_text(stmt, offset + 5, startup_locations.location_type, row);
+        bind_text(stmt, offset + 6, startup_locations.ramp_name, row);
+    });
+}
 
-        stmt.executeStep();
-        stmt.reset();
-    }
+void NavDataManager::Impl::insert_navaids(const NavaidColumns& navaids, MultiRowInsert& insert) {
+    insert.write(navaids.size(), [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bind(offset + 1, navaids.row_code[row]);
+        stmt.bindNoCopy(offset + 2, navaids.navaid_type.c_str(row));
+        stmt.bindNoCopy(offset + 3, navaids.ident.c_str(row));
+        stmt.bind(offset + 4, navaids.latitude[row]);
+        stmt.bind(offset + 5, navaids.longitude[row]);
+        stmt.bind(offset + 6, navaids.elevation[row]);
+        stmt.bind(offset + 7, navaids.frequency[row]);
+        stmt.bind(offset + 8, navaids.range[row]);
+        stmt.bind(offset + 9, navaids.bearing[row]);
+        bind_value(stmt, offset + 10, navaids.glideslope_angle, row);
+        bind_text(stmt, offset + 11, navaids.airport_icao, row);
+        bind_text(stmt, offset + 12, navaids.icao_region, row);
+        bind_text(stmt, offset + 13, navaids.name, row);
+    });
 }
 
-void NavDataManager::Impl::insert_linear_feature_nodes(const std::vector<LinearFeatureNodeData>& linear_feature_nodes) {
-    SQLite::Statement stmt(*m_db, R"(
-        INSERT OR REPLACE INTO linear_feature_nodes
-        (airport_icao, feature_sequence, latitude, longitude, bezier_latitude, bezier_longitude, node_order)
-        VALUES (?, ?, ?, ?, ?, ?, ?)
-    )");
+void NavDataManager::Impl::insert_fixes(const FixColumns& fixes, MultiRowInsert& insert) {
+    insert.write(fixes.size(), [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, fixes.ident.c_str(row));
+        stmt.bind(offset + 2, fixes.latitude[row]);
+        stmt.bind(offset + 3, fixes.longitude[row]);
+        bind_text(stmt, offset + 4, fixes.airport_icao, row);
+        bind_text(stmt, offset + 5, fixes.icao_region, row);
+        bind_value(stmt, offset + 6, fixes.waypoint_type, row);
+    });
+}
 
-    for (const auto& node : linear_feature_nodes) {
-        node.airport_icao ? stmt.bind(1, *node.airport_icao) : stmt.bind(1);
-        node.feature_sequence ? stmt.bind(2, *node.feature_sequence) : stmt.bind(2);
-        node.latitude ? stmt.bind(3, *node.latitude) : stmt.bind(3);
-        node.longitude ? stmt.bind(4, *node.longitude) : stmt.bind(4);
-        node.bezier_latitude ? stmt.bind(5, *node.bezier_latitude) : stmt.bind(5);
-        node.bezier_longitude ? stmt.bind(6, *node.bezier_longitude) : stmt.bind(6);
-        node.node_order ? stmt.bind(7, *node.node_order) : stmt.bind(7);
+void NavDataManager::Impl::insert_airway_segments(const AirwaySegmentColumns& airway_segments, MultiRowInsert& insert) {
+    insert.write(airway_segments.size(), [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, airway_segments.airway_name.c_str(row));
+        stmt.bindNoCopy(offset + 2, airway_segments.from_ident.c_str(row));
+        stmt.bindNoCopy(offset + 3, airway_segments.from_region.c_str(row));
+        stmt.bind(offset + 4, airway_segments.from_type[row]);
+        stmt.bindNoCopy(offset + 5, airway_segments.to_ident.c_str(row));
+        stmt.bindNoCopy(offset + 6, airway_segments.to_region.c_str(row));
+        stmt.bind(offset + 7, airway_segments.to_type[row]);
+        stmt.bindNoCopy(offset + 8, airway_segments.direction.c_str(row));
+        stmt.bind(offset + 9, airway_segments.airway_level[row]);
+        stmt.bind(offset + 10, airway_segments.base_fl[row]);
+        stmt.bind(offset + 11, airway_segments.top_fl[row]);
+    });
+}
 
-        stmt.executeStep();
-        stmt.reset();
-    }
+void NavDataManager::Impl::insert_procedure_legs(const ProcedureLegColumns& procedure_legs, MultiRowInsert& insert) {
+    insert.write(procedure_legs.size(), [&](SQLite::Statement& stmt, int offset, size_t row) {
+        stmt.bindNoCopy(offset + 1, procedure_legs.airport_icao.c_str(row));
+        stmt.bindNoCopy(offset + 2, procedure_legs.procedure_type.c_str(row));
+        bind_text(stmt, offset + 3, procedure_legs.route_type, row);
+        stmt.bindNoCopy(offset + 4, procedure_legs.procedure_ident.c_str(row));
+        bind_text(stmt, offset + 5, procedure_legs.transition_ident, row);
+        stmt.bind(offset + 6, procedure_legs.sequence[row]);
+        bind_text(stmt, offset + 7, procedure_legs.fix_ident, row);
+        bind_text(stmt, offset + 8, procedure_legs.fix_region, row);
+        bind_text(stmt, offset + 9, procedure_legs.description_code, row);
+        bind_text(stmt, offset + 10, procedure_legs.turn_direction, row);
+        stmt.bindNoCopy(offset + 11, procedure_legs.path_terminator.c_str(row));
+        bind_text(stmt, offset + 12, procedure_legs.recommended_navaid, row);
+    });
 }
 
 // This method finds all apt.dat files within an X-Plane installation and assigns the paths to the
-// required private member variables.
+// required private member variables. Compressed apt.dat.gz / apt.dat.zst files count as apt.dat files; next to an
+// uncompressed apt.dat in the same folder the shorter (uncompressed) path wins. The Custom Scenery packages are walked
+// by a SceneryScanner, which skips the ones its manifest (if one is set) shows to be unchanged.
+// With a Custom Scenery/scenery_packs.ini, the packages it marks SCENERY_PACK_DISABLED are left out and the others are
+// ordered as X-Plane orders them, *GLOBAL_AIRPORTS* included. Without one, Global Airports comes first and the
+// packages follow by name. Either way, the packages matching an exclusion pattern are left out.
 void NavDataManager::Impl::get_airport_dat_paths(const std::string& xp_dir) {
     try {
-        bool in_global_scenery = false;
-        std::vector<std::string> airport_scenery_extensions = {"Global Scenery", "Custom Scenery"};
         std::vector<std::string> exclusion_patterns = {"z_", "ortho", "zortho4xp_", "simheaven_", "x-plane landmarks", "uhd_", "hd_", "library"};
 
         fs::path xp_dir_path(xp_dir);
         if (!fs::exists(xp_dir_path) || !fs::is_directory(xp_dir_path)) {
             throw std::invalid_argument("Provided path is not a valid directory: " + xp_dir);
         }
-
-        // Collect all apt.dat files first, then filter
-        std::vector<fs::path> all_apt_files;
-
-        for (const auto& scenery_folder : airport_scenery_extensions) {
-            fs::path scenery_dir = xp_dir_path / scenery_folder;
-            if (scenery_folder == "Global Scenery") {
-                scenery_dir /= "Global Airports";
-                scenery_dir /= "Earth nav data";
-                m_global_airport_data_path = scenery_dir;
-                in_global_scenery = true;
-            } else {
-                m_custom_scenery_path = scenery_dir;
-                in_global_scenery = false;
-            }
-
+        m_global_airport_data_path = xp_dir_path / "Global Scenery" / "Global Airports" / "Earth nav data";
+        m_custom_scenery_path = xp_dir_path / "Custom Scenery";
+
+        // Keep only the shortest path per scenery package
+        auto add_shortest = [this](const std::vector<fs::path>& apt_files) {
+            if (apt_files.empty()) return;
+            auto shortest = std::min_element(apt_files.begin(), apt_files.end(), [](const fs::path& a, const fs::path& b) {
+                return a.string().length() < b.string().length();
+            });
             if (m_logging_enabled) {
-                std::cout << "Finding all apt.dat files..." << std::endl;
-                std::cout << "Scanning " << scenery_dir.string() << "..." << std::endl;
+                for (auto it = apt_files.begin(); it != apt_files.end(); ++it) {
+                    if (it != shortest) std::cout << "  -> Skipping subdirectory apt.dat: " << it->string() << std::endl;
+                }
+                std::cout << "  -> Located File: " << shortest->string() << std::endl;
             }
+            m_all_apt_files.push_back(*shortest);
+        };
 
-            try {
-                auto iterator = fs::recursive_directory_iterator(scenery_dir);
-                for (const auto& entry: iterator) {
-                    if (entry.is_directory() && !in_global_scenery) {
-                        std::string dir_name = entry.path().filename().string();
-                        std::transform(dir_name.begin(), dir_name.end(), dir_name.begin(), [](unsigned char c){return std::tolower(c);});
-                        for (const auto& pattern : exclusion_patterns) {
-                            if (dir_name.find(pattern) != std::string::npos) {
-                                iterator.disable_recursion_pending();
-                                break;
-                            }
-                        }
-                    }
+        if (m_logging_enabled) {
+            std::cout << "Finding all apt.dat files..." << std::endl;
+            std::cout << "Scanning " << m_global_airport_data_path.string() << "..." << std::endl;
+        }
 
-                    if (entry.is_regular_file() && entry.path().filename() == "apt.dat") {
-                        all_apt_files.push_back(entry.path());
-                    }
+        std::vector<fs::path> global_apt_files;
+        try {
+            for (const auto& entry : fs::recursive_directory_iterator(m_global_airport_data_path)) {
+                if (entry.is_regular_file() && is_apt_dat_file(entry.path())) {
+                    global_apt_files.push_back(entry.path());
                 }
-            } catch (const fs::filesystem_error& e) {
-                std::cerr << "Filesystem error while scanning: " << e.what() << std::endl;
-                throw;
             }
+        } catch (const fs::filesystem_error& e) {
+            std::cerr << "Filesystem error while scanning: " << e.what() << std::endl;
+            throw;
         }
 
-        // Filter: keep only the shortest path per scenery package
-        std::map<std::string, fs::path> shortest_per_package;
-        
-        for (const auto& apt_file : all_apt_files) {
-            // Extract scenery package name (directory right after Custom Scenery or Global Scenery)
-            std::string package_name;
-            bool found_scenery = false;
-            
-            for (auto it = apt_file.begin(); it != apt_file.end(); ++it) {
-                if (found_scenery && std::next(it) != apt_file.end()) {
-                    package_name = it->string();
-                    break;
-                }
-                if (*it == "Custom Scenery" || *it == "Global Scenery") {
-                    found_scenery = true;
-                }
+        // Packages from the lowest priority to the highest, an empty path standing for Global Airports. The files are
+        // written in this order and the last one to have an airport wins it.
+        if (m_logging_enabled) {
+            std::cout << "Scanning " << m_custom_scenery_path.string() << "..." << std::endl;
+        }
+        SceneryScanner scanner(m_custom_scenery_path, m_scan_manifest_path, exclusion_patterns);
+        std::vector<fs::path> installed_packages = scanner.list_packages();
+        std::vector<fs::path> packages_by_priority;
+        m_packages_disabled = 0;
+        if (std::optional<std::vector<SceneryPack>> packs = read_scenery_packs(m_custom_scenery_path)) {
+            // X-Plane adds the packages installed since it last wrote the file at the top, so they come last here
+            std::unordered_set<std::string> listed;
+            for (const auto& pack : *packs) {
+                if (!pack.directory.empty()) listed.insert(fs::absolute(pack.directory).lexically_normal().string());
             }
-            
-            // If we haven't seen this package, or this path is shorter, keep it
-            if (shortest_per_package.find(package_name) == shortest_per_package.end() ||
-                apt_file.string().length() < shortest_per_package[package_name].string().length()) {
-                
-                if (shortest_per_package.find(package_name) != shortest_per_package.end() && m_logging_enabled) {
-                    std::cout << "  -> Skipping subdirectory apt.dat: " << shortest_per_package[package_name].string() << std::endl;
+            bool has_global = false;
+            for (auto pack = packs->rbegin(); pack != packs->rend(); ++pack) {
+                if (pack->directory.empty()) {
+                    if (!has_global) packages_by_priority.emplace_back();
+                    has_global = true;
+                } else if (!pack->enabled) {
+                    m_packages_disabled++;
+                    if (m_logging_enabled) {
+                        std::cout << "  -> Skipping disabled scenery package: " << pack->directory.string() << std::endl;
+                    }
+                } else if (scanner.is_excluded(pack->directory)) {
+                    // Ortho and library packs are listed in the file too, they are no more worth a walk there
+                    if (m_logging_enabled) {
+                        std::cout << "  -> Skipping excluded scenery package: " << pack->directory.string() << std::endl;
+                    }
+                } else if (fs::is_directory(pack->directory)) {
+                    packages_by_priority.push_back(pack->directory);
                 }
-                shortest_per_package[package_name] = apt_file;
-            } else if (m_logging_enabled) {
-                std::cout << "  -> Skipping subdirectory apt.dat: " << apt_file.string() << std::endl;
             }
-        }
-
-        // Add the shortest paths to m_all_apt_files
-        // First add Global Scenery files
-        for (const auto& [package, path] : shortest_per_package) {
-            // Check if this is a Global Scenery file
-            if (path.string().find("Global Scenery") != std::string::npos) {
-                m_all_apt_files.push_back(path);
-                if (m_logging_enabled) {
-                    std::cout << "  -> Located File: " << path.string() << std::endl;
+            if (!has_global) packages_by_priority.insert(packages_by_priority.begin(), fs::path());
+            for (const auto& package_dir : installed_packages) {
+                if (listed.count(fs::absolute(package_dir).lexically_normal().string()) == 0) {
+                    packages_by_priority.push_back(package_dir);
                 }
             }
+        } else {
+            // Without scenery_packs.ini, Global Airports first and then the packages by name
+            packages_by_priority.emplace_back();
+            packages_by_priority.insert(packages_by_priority.end(), installed_packages.begin(), installed_packages.end());
         }
 
-        // Then add Custom Scenery files
-        for (const auto& [package, path] : shortest_per_package) {
-            // Check if this is a Custom Scenery file
-            if (path.string().find("Custom Scenery") != std::string::npos) {
-                m_all_apt_files.push_back(path);
-                if (m_logging_enabled) {
-                    std::cout << "  -> Located File: " << path.string() << std::endl;
-                }
+        // The packages are walked in parallel, unless the scan manifest says they are unchanged
+        std::vector<fs::path> package_dirs;
+        std::copy_if(packages_by_priority.begin(), packages_by_priority.end(), std::back_inserter(package_dirs),
+                     [](const fs::path& package_dir) { return !package_dir.empty(); });
+        SceneryScanResult scan;
+        try {
+            scan = scanner.scan(package_dirs, ThreadPool::resolve_thread_count(m_thread_count));
+        } catch (const fs::filesystem_error& e) {
+            std::cerr << "Filesystem error while scanning: " << e.what() << std::endl;
+            throw;
+        }
+        m_packages_walked = scan.packages_walked;
+        m_packages_cached = scan.packages_cached;
+
+        size_t next_scan = 0;
+        for (const auto& package_dir : packages_by_priority) {
+            if (package_dir.empty()) {
+                add_shortest(global_apt_files);
+                continue;
             }
+            std::vector<fs::path> apt_files;
+            for (const auto& apt_file : scan.packages[next_scan++].apt_files) {
+                apt_files.push_back(package_dir / fs::u8path(apt_file));
+            }
+            add_shortest(apt_files);
+        }
+        m_apt_priorities.clear();
+        for (size_t i = 0; i < m_all_apt_files.size(); ++i) {
+            m_apt_priorities[m_all_apt_files[i].string()] = static_cast<int>(i + 1);
         }
     } catch (const std::exception& e) {
         std::cerr << "Error in get_airport_dat_paths: " << e.what() << std::endl;
@@ -621,17 +2127,164 @@ void NavDataManager::Impl::get_airport_dat_paths(const std::string& xp_dir) {
     }
 }
 
+// X-Plane reads each nav .dat file from Custom Data when a navdata update is installed there, and from
+// Resources/default data otherwise. An installation without a file simply has none of its records.
+void NavDataManager::Impl::get_nav_dat_paths(const std::string& xp_dir) {
+    fs::path xp_dir_path(xp_dir);
+    for (const char* file_name : {"earth_nav.dat", "earth_fix.dat", "earth_awy.dat"}) {
+        bool found = false;
+        for (const fs::path& candidate : {xp_dir_path / "Custom Data" / file_name,
+                                          xp_dir_path / "Resources" / "default data" / file_name}) {
+            if (fs::is_regular_file(candidate)) {
+                m_all_nav_files.push_back(candidate);
+                found = true;
+                if (m_logging_enabled) {
+                    std::cout << "  -> Located File: " << candidate.string() << std::endl;
+                }
+                break;
+            }
+        }
+        if (!found && m_logging_enabled) {
+            std::cout << "No " << file_name << " found, its records will not be loaded." << std::endl;
+        }
+    }
+}
+
+// One CIFP file per airport, named after it. As with the other nav data, a navdata update in Custom Data/CIFP
+// replaces the file of the same airport in Resources/default data/CIFP. Only the directories are listed, the files are
+// not opened or stat'ed here.
+void NavDataManager::Impl::get_cifp_paths(const std::string& xp_dir) {
+    fs::path xp_dir_path(xp_dir);
+    std::unordered_set<std::string> airports_found;
+    for (const fs::path& cifp_dir : {xp_dir_path / "Custom Data" / "CIFP", xp_dir_path / "Resources" / "default data" / "CIFP"}) {
+        std::error_code ec;
+        for (fs::directory_iterator entry(cifp_dir, ec), end; !ec && entry != end; entry.increment(ec)) {
+            const fs::path& path = entry->path();
+            if (path.extension() != ".dat") continue;
+            if (airports_found.insert(path.stem().string()).second) {
+                m_all_cifp_files.push_back(path);
+            }
+        }
+    }
+    std::sort(m_all_cifp_files.begin(), m_all_cifp_files.end(), [](const fs::path& a, const fs::path& b) {
+        return a.stem() < b.stem();
+    });
+    if (m_logging_enabled) {
+        std::cout << "Found " << m_all_cifp_files.size() << " CIFP procedure files." << std::endl;
+    }
+}
+
 void NavDataManager::Impl::apply_schema() {
     try {
+        migrate_schema();
         m_db->exec(navdata_schema);
+        create_navaid_spatial_index();
     } catch (const SQLite::Exception& e) {
         std::cerr << "Error creating tables: " << e.what() << std::endl;
     }
 }
 
+// Nothing has been ingested into the database yet (or every ingest so far rolled back)
+bool NavDataManager::Impl::is_database_empty() {
+    SQLite::Statement select_any(*m_db, "SELECT EXISTS (SELECT 1 FROM scenery_paths) OR EXISTS (SELECT 1 FROM airports)");
+    return select_any.executeStep() && select_any.getColumn(0).getInt() == 0;
+}
+
+// Drops the indexes a bulk load would otherwise update row by row, and returns the statements that build them again.
+// Those of scenery_paths stay, the load looks its files up there. The indexes behind PRIMARY KEY and UNIQUE constraints
+// stay too (they have no SQL), INSERT OR REPLACE relies on them.
+std::vector<std::string> NavDataManager::Impl::drop_secondary_indexes() {
+    std::vector<std::pair<std::string, std::string>> indexes;
+    SQLite::Statement select_indexes(*m_db, R"(
+        SELECT name, sql FROM sqlite_master
+        WHERE type = 'index' AND sql IS NOT NULL AND tbl_name <> 'scenery_paths'
+    )");
+    while (select_indexes.executeStep()) {
+        indexes.emplace_back(select_indexes.getColumn(0).getString(), select_indexes.getColumn(1).getString());
+    }
+    std::vector<std::string> create_statements;
+    for (const auto& [name, sql] : indexes) {
+        m_db->exec("DROP INDEX \"" + name + "\"");
+        create_statements.push_back(sql);
+    }
+    return create_statements;
+}
+
+// Databases created before scenery_paths tracked file contents get the new columns. Their rows have no stats yet,
+// which the next ingest takes as unchanged files (see check_scenery_file). Records indexed before the scenery order
+// was known get priority 0, and the next ingest sets it.
+void NavDataManager::Impl::migrate_schema() {
+    const std::vector<std::tuple<const char*, const char*, const char*>> added_columns = {
+        {"scenery_paths", "file_size", "INTEGER"},
+        {"scenery_paths", "modified_time", "INTEGER"},
+        {"scenery_paths", "content_hash", "INTEGER"},
+        {"airport_records", "scenery_priority", "INTEGER NOT NULL DEFAULT 0"},
+    };
+    for (const auto& [table, column, type] : added_columns) {
+        std::unordered_set<std::string> columns;
+        SQLite::Statement table_info(*m_db, std::string("PRAGMA table_info(") + table + ")");
+        while (table_info.executeStep()) {
+            columns.insert(table_info.getColumn(1).getString());
+        }
+        if (columns.empty()) continue;        // New table, the schema creates it
+        if (columns.count(column) == 0) {
+            m_db->exec(std::string("ALTER TABLE ") + table + " ADD COLUMN " + column + " " + type);
+        }
+    }
+}
+
+// R*Tree over the navaid coordinates, keyed by navaid_id. SQLite may be built without the R*Tree module, in which case
+// radius queries pre-filter on a latitude index instead.
+void NavDataManager::Impl::create_navaid_spatial_index() {
+    try {
+        m_db->exec("CREATE VIRTUAL TABLE IF NOT EXISTS navaids_rtree USING rtree(id, min_lat, max_lat, min_lon, max_lon)");
+        m_has_navaid_rtree = true;
+    } catch (const SQLite::Exception&) {
+        m_db->exec("CREATE INDEX IF NOT EXISTS idx_navaids_latitude ON navaids(latitude)");
+        m_has_navaid_rtree = false;
+    }
+}
+
+void NavDataManager::Impl::rebuild_navaid_spatial_index() {
+    if (!m_has_navaid_rtree) return;
+    m_db->exec("DELETE FROM navaids_rtree");
+    m_db->exec(R"(
+        INSERT INTO navaids_rtree (id, min_lat, max_lat, min_lon, max_lon)
+        SELECT navaid_id, latitude, latitude, longitude, longitude FROM navaids
+    )");
+}
+
 AirportQuery& NavDataManager::airport_data() {
     if (!m_impl->airport_query) {
         throw std::runtime_error("Database not connected. Call connect_database() first.");
     }
     return *m_impl->airport_query;
+}
+
+NavaidQuery& NavDataManager::navaid_data() {
+    if (!m_impl->navaid_query) {
+        throw std::runtime_error("Database not connected. Call connect_database() first.");
+    }
+    return *m_impl->navaid_query;
+}
+
+AirwayRouter& NavDataManager::airway_routing() {
+    if (!m_impl->airway_router) {
+        throw std::runtime_error("Database not connected. Call connect_database() first.");
+    }
+    return *m_impl->airway_router;
+}
+
+ProcedureQuery& NavDataManager::procedure_data() {
+    if (!m_impl->procedure_query) {
+        throw std::runtime_error("Database not connected. Call connect_database() first.");
+    }
+    return *m_impl->procedure_query;
+}
+
+SQLite::Database& NavDataManager::database() {
+    if (!m_impl->m_db) {
+        throw std::runtime_error("Database not connected. Call connect_database() first.");
+    }
+    return *m_impl->m_db;
 }
\ No newline at end of file
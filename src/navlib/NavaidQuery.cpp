@@ -0,0 +1,218 @@
+#include <NavDataManager/NavaidQuery.h>
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <sstream>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+namespace {
+    constexpr double EARTH_RADIUS_KM = 6371.0;
+    constexpr double KM_PER_DEGREE = EARTH_RADIUS_KM * M_PI / 180.0;
+
+    double to_radians(double degrees) { return degrees * M_PI / 180.0; }
+
+    // Great-circle (haversine) distance
+    double distance_km(double lat1, double lon1, double lat2, double lon2) {
+        const double delta_lat = to_radians(lat2 - lat1);
+        const double delta_lon = to_radians(lon2 - lon1);
+        const double a = std::sin(delta_lat / 2) * std::sin(delta_lat / 2) +
+                         std::cos(to_radians(lat1)) * std::cos(to_radians(lat2)) *
+                         std::sin(delta_lon / 2) * std::sin(delta_lon / 2);
+        return EARTH_RADIUS_KM * 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+    }
+
+    // Latitude/longitude box that contains a circle. The longitude span is split in two where the box crosses the
+    // antimeridian, and covers every longitude when the circle reaches a pole.
+    struct BoundingBox {
+        double min_lat, max_lat;
+        std::vector<std::pair<double, double>> lon_ranges;
+    };
+
+    BoundingBox bounding_box(double lat, double lon, double radius_km) {
+        BoundingBox box;
+        const double delta_lat = radius_km / KM_PER_DEGREE;
+        box.min_lat = std::max(-90.0, lat - delta_lat);
+        box.max_lat = std::min(90.0, lat + delta_lat);
+
+        // Widest longitude span is at the box edge farthest from the equator
+        const double cos_edge = std::cos(to_radians(std::max(std::abs(box.min_lat), std::abs(box.max_lat))));
+        const double delta_lon = (cos_edge > 1e-9) ? delta_lat / cos_edge : 360.0;
+        if (delta_lon >= 180.0) {
+            box.lon_ranges = {{-180.0, 180.0}};
+        } else if (lon - delta_lon < -180.0) {
+            box.lon_ranges = {{lon - delta_lon + 360.0, 180.0}, {-180.0, lon + delta_lon}};
+        } else if (lon + delta_lon > 180.0) {
+            box.lon_ranges = {{lon - delta_lon, 180.0}, {-180.0, lon + delta_lon - 360.0}};
+        } else {
+            box.lon_ranges = {{lon - delta_lon, lon + delta_lon}};
+        }
+        return box;
+    }
+
+    // Pre-filter for near(): the navaids inside the bounding box, through the R*Tree if there is one
+    std::string bounding_box_condition(const BoundingBox& box, bool spatial_index) {
+        std::ostringstream condition;
+        if (spatial_index) {
+            condition << "n.navaid_id IN (";
+            for (size_t i = 0; i < box.lon_ranges.size(); ++i) {
+                if (i > 0) condition << " UNION ALL ";
+                condition << "SELECT id FROM navaids_rtree WHERE max_lat >= ? AND min_lat <= ? AND max_lon >= ? AND min_lon <= ?";
+            }
+            condition << ")";
+        } else {
+            condition << "n.latitude BETWEEN ? AND ? AND (";
+            for (size_t i = 0; i < box.lon_ranges.size(); ++i) {
+                if (i > 0) condition << " OR ";
+                condition << "n.longitude BETWEEN ? AND ?";
+            }
+            condition << ")";
+        }
+        return condition.str();
+    }
+
+    void bind_bounding_box(SQLite::Statement& stmt, int& param_index, const BoundingBox& box, bool spatial_index) {
+        if (spatial_index) {
+            for (const auto& [min_lon, max_lon] : box.lon_ranges) {
+                stmt.bind(param_index++, box.min_lat);
+                stmt.bind(param_index++, box.max_lat);
+                stmt.bind(param_index++, min_lon);
+                stmt.bind(param_index++, max_lon);
+            }
+        } else {
+            stmt.bind(param_index++, box.min_lat);
+            stmt.bind(param_index++, box.max_lat);
+            for (const auto& [min_lon, max_lon] : box.lon_ranges) {
+                stmt.bind(param_index++, min_lon);
+                stmt.bind(param_index++, max_lon);
+            }
+        }
+    }
+}
+
+std::vector<NavaidData> NavaidQueryBuilder::execute() {
+    std::vector<NavaidData> results;
+    const bool by_distance = latitude && longitude && radius;
+    std::optional<BoundingBox> box;
+    if (by_distance) box = bounding_box(*latitude, *longitude, *radius);
+
+    // Build dynamic query
+    std::ostringstream query;
+    query << "SELECT n.ident, n.navaid_type, n.row_code, n.latitude, n.longitude, n.elevation, n.frequency, n.range, "
+          << "n.bearing, n.glideslope_angle, n.airport_icao, n.icao_region, n.name FROM navaids n";
+
+    std::vector<std::string> conditions;
+    if (ident_filter) conditions.push_back("n.ident = ?");
+    if (type_filter) conditions.push_back("n.navaid_type = ?");
+    if (airport_filter) conditions.push_back("n.airport_icao = ?");
+    if (region_filter) conditions.push_back("n.icao_region = ?");
+    if (box) conditions.push_back(bounding_box_condition(*box, m_spatial_index));
+
+    if (!conditions.empty()) {
+        query << " WHERE " << conditions[0];
+        for (size_t i = 1; i < conditions.size(); ++i) {
+            query << " AND " << conditions[i];
+        }
+    }
+
+    // Radius queries are ordered and limited below, once the exact distances are known
+    if (!by_distance) {
+        query << " ORDER BY n.ident";
+        if (limit > 0) query << " LIMIT " << limit;
+    }
+
+    try {
+        SQLite::Statement stmt(*m_db, query.str());
+
+        // Bind parameters
+        int param_index = 1;
+        if (ident_filter) stmt.bind(param_index++, *ident_filter);
+        if (type_filter) stmt.bind(param_index++, *type_filter);
+        if (airport_filter) stmt.bind(param_index++, *airport_filter);
+        if (region_filter) stmt.bind(param_index++, *region_filter);
+        if (box) bind_bounding_box(stmt, param_index, *box, m_spatial_index);
+
+        while (stmt.executeStep()) {
+            NavaidData navaid;
+
+            if (!stmt.isColumnNull(0)) navaid.ident = stmt.getColumn(0).getString();
+            if (!stmt.isColumnNull(1)) navaid.type = stmt.getColumn(1).getString();
+            if (!stmt.isColumnNull(2)) navaid.row_code = stmt.getColumn(2).getInt();
+            if (!stmt.isColumnNull(3)) navaid.latitude = stmt.getColumn(3).getDouble();
+            if (!stmt.isColumnNull(4)) navaid.longitude = stmt.getColumn(4).getDouble();
+            if (!stmt.isColumnNull(5)) navaid.elevation = stmt.getColumn(5).getInt();
+            if (!stmt.isColumnNull(6)) navaid.frequency = stmt.getColumn(6).getInt();
+            if (!stmt.isColumnNull(7)) navaid.range = stmt.getColumn(7).getInt();
+            if (!stmt.isColumnNull(8)) navaid.bearing = stmt.getColumn(8).getDouble();
+            if (!stmt.isColumnNull(9)) navaid.glideslope_angle = stmt.getColumn(9).getDouble();
+            if (!stmt.isColumnNull(10)) navaid.airport_icao = stmt.getColumn(10).getString();
+            if (!stmt.isColumnNull(11)) navaid.icao_region = stmt.getColumn(11).getString();
+            if (!stmt.isColumnNull(12)) navaid.name = stmt.getColumn(12).getString();
+
+            if (by_distance) {
+                navaid.distance_km = distance_km(*latitude, *longitude, *navaid.latitude, *navaid.longitude);
+                if (*navaid.distance_km > *radius) continue;
+            }
+            results.push_back(navaid);
+        }
+    } catch (const SQLite::Exception& e) {
+        throw std::runtime_error("Navaid query failed: " + std::string(e.what()));
+    }
+
+    if (by_distance) {
+        std::sort(results.begin(), results.end(), [](const NavaidData& a, const NavaidData& b) {
+            return *a.distance_km < *b.distance_km;
+        });
+        if (limit > 0 && results.size() > static_cast<size_t>(limit)) results.resize(limit);
+    }
+
+    return results;
+}
+
+std::optional<NavaidData> NavaidQueryBuilder::first() {
+    limit = 1;
+    auto results = execute();
+    return results.empty() ? std::nullopt : std::make_optional(results[0]);
+}
+
+size_t NavaidQueryBuilder::count() {
+    // Only the exact distances tell which navaids of the bounding box are within the radius
+    if (latitude && longitude && radius) {
+        limit = 0;
+        return execute().size();
+    }
+
+    std::ostringstream query;
+    query << "SELECT COUNT(*) FROM navaids n";
+
+    std::vector<std::string> conditions;
+    if (ident_filter) conditions.push_back("n.ident = ?");
+    if (type_filter) conditions.push_back("n.navaid_type = ?");
+    if (airport_filter) conditions.push_back("n.airport_icao = ?");
+    if (region_filter) conditions.push_back("n.icao_region = ?");
+
+    if (!conditions.empty()) {
+        query << " WHERE " << conditions[0];
+        for (size_t i = 1; i < conditions.size(); ++i) {
+            query << " AND " << conditions[i];
+        }
+    }
+
+    try {
+        SQLite::Statement stmt(*m_db, query.str());
+
+        // Bind parameters (same as execute)
+        int param_index = 1;
+        if (ident_filter) stmt.bind(param_index++, *ident_filter);
+        if (type_filter) stmt.bind(param_index++, *type_filter);
+        if (airport_filter) stmt.bind(param_index++, *airport_filter);
+        if (region_filter) stmt.bind(param_index++, *region_filter);
+
+        if (stmt.executeStep()) {
+            return static_cast<size_t>(stmt.getColumn(0).getInt64());
+        }
+    } catch (const SQLite::Exception& e) {
+        throw std::runtime_error("Navaid count query failed: " + std::string(e.what()));
+    }
+
+    return 0;
+}
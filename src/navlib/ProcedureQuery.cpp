@@ -0,0 +1,81 @@
+#include <NavDataManager/ProcedureQuery.h>
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <sstream>
+
+std::vector<ProcedureData> ProcedureQueryBuilder::execute() {
+    std::vector<ProcedureData> results;
+
+    // Build dynamic query
+    std::ostringstream query;
+    query << "SELECT p.airport_icao, p.procedure_type, p.procedure_ident, p.transition_ident, p.route_type, p.sequence, "
+          << "p.fix_ident, p.fix_region, p.description_code, p.turn_direction, p.path_terminator, p.recommended_navaid "
+          << "FROM procedure_legs p";
+
+    std::vector<std::string> conditions;
+    if (airport_filter) conditions.push_back("p.airport_icao = ?");
+    if (type_filter) conditions.push_back("p.procedure_type = ?");
+    if (ident_filter) conditions.push_back("p.procedure_ident = ?");
+    if (transition_filter) conditions.push_back("p.transition_ident = ?");
+
+    if (!conditions.empty()) {
+        query << " WHERE " << conditions[0];
+        for (size_t i = 1; i < conditions.size(); ++i) {
+            query << " AND " << conditions[i];
+        }
+    }
+    // The rows of one procedure and transition are adjacent, so they are grouped in a single pass
+    query << " ORDER BY p.airport_icao, p.procedure_type, p.procedure_ident, p.transition_ident, p.sequence";
+
+    try {
+        SQLite::Statement stmt(*m_db, query.str());
+
+        // Bind parameters
+        int param_index = 1;
+        if (airport_filter) stmt.bind(param_index++, *airport_filter);
+        if (type_filter) stmt.bind(param_index++, *type_filter);
+        if (ident_filter) stmt.bind(param_index++, *ident_filter);
+        if (transition_filter) stmt.bind(param_index++, *transition_filter);
+
+        auto optional_text = [&stmt](int column) -> std::optional<std::string> {
+            if (stmt.isColumnNull(column)) return std::nullopt;
+            return stmt.getColumn(column).getString();
+        };
+
+        while (stmt.executeStep()) {
+            std::optional<std::string> airport_icao = optional_text(0);
+            std::optional<std::string> procedure_type = optional_text(1);
+            std::optional<std::string> ident = optional_text(2);
+            std::optional<std::string> transition = optional_text(3);
+
+            if (results.empty() || results.back().airport_icao != airport_icao || results.back().procedure_type != procedure_type ||
+                results.back().ident != ident || results.back().transition != transition) {
+                ProcedureData procedure;
+                procedure.airport_icao = airport_icao;
+                procedure.procedure_type = procedure_type;
+                procedure.ident = ident;
+                procedure.transition = transition;
+                procedure.route_type = optional_text(4);
+                results.push_back(std::move(procedure));
+            }
+
+            ProcedureLegData leg;
+            if (!stmt.isColumnNull(5)) leg.sequence = stmt.getColumn(5).getInt();
+            leg.fix_ident = optional_text(6);
+            leg.fix_region = optional_text(7);
+            leg.description_code = optional_text(8);
+            leg.turn_direction = optional_text(9);
+            leg.path_terminator = optional_text(10);
+            leg.recommended_navaid = optional_text(11);
+            results.back().legs.push_back(std::move(leg));
+        }
+    } catch (const SQLite::Exception& e) {
+        throw std::runtime_error("Procedure query failed: " + std::string(e.what()));
+    }
+
+    return results;
+}
+
+std::optional<ProcedureData> ProcedureQueryBuilder::first() {
+    auto results = execute();
+    return results.empty() ? std::nullopt : std::make_optional(results[0]);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <chrono>
+#include <algorithm>
+
+/*
+    Blocking single-consumer queue with a fixed capacity, used to hand parsed batches from parser threads to the
+    database writer. push() blocks while the queue is full and pop() blocks while it is empty. close() ends the stream:
+    pop() drains what is left and then returns std::nullopt, while push() on a closed queue drops the item and returns
+    false so producers can stop early when the consumer has given up.
+    The queue also keeps the statistics we use to size it: the high-water mark and how long each side spent waiting.
+*/
+
+template <typename T>
+class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : m_capacity(std::max<size_t>(1, capacity)) {}
+
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_items.size() >= m_capacity && !m_closed) {
+                auto wait_start = std::chrono::steady_clock::now();
+                m_not_full.wait(lock, [this] { return m_items.size() < m_capacity || m_closed; });
+                m_push_wait += std::chrono::steady_clock::now() - wait_start;
+            }
+            if (m_closed) return false;
+            m_items.push_back(std::move(item));
+            m_high_water_mark = std::max(m_high_water_mark, m_items.size());
+            lock.unlock();
+            m_not_empty.notify_one();
+            return true;
+        }
+
+        std::optional<T> pop() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_items.empty() && !m_closed) {
+                auto wait_start = std::chrono::steady_clock::now();
+                m_not_empty.wait(lock, [this] { return !m_items.empty() || m_closed; });
+                m_pop_wait += std::chrono::steady_clock::now() - wait_start;
+            }
+            if (m_items.empty()) return std::nullopt;
+            T item = std::move(m_items.front());
+            m_items.pop_front();
+            lock.unlock();
+            m_not_full.notify_one();
+            return item;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+            m_not_empty.notify_all();
+            m_not_full.notify_all();
+        }
+
+        size_t capacity() const { return m_capacity; }
+
+        size_t high_water_mark() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_high_water_mark;
+        }
+
+        // Time producers spent blocked on a full queue
+        std::chrono::steady_clock::duration push_wait_time() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_push_wait;
+        }
+
+        // Time the consumer spent blocked on an empty queue
+        std::chrono::steady_clock::duration pop_wait_time() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_pop_wait;
+        }
+
+    private:
+        const size_t m_capacity;
+        std::deque<T> m_items;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        bool m_closed = false;
+
+        size_t m_high_water_mark = 0;
+        std::chrono::steady_clock::duration m_push_wait{0};
+        std::chrono::steady_clock::duration m_pop_wait{0};
+};
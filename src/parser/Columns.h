@@ -0,0 +1,209 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <unordered_map>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Building blocks for the columnar (structure-of-arrays) form of parsed records.
+    A column stores its values contiguously and tracks missing values in a packed bitmap (one bit per row) instead of
+    wrapping every value in std::optional. StringColumn keeps all of its strings in one character buffer; each value is
+    stored NUL-terminated so it can be bound to SQLite without copying.
+    Columns are append-only, apart from rewriting or dropping the most recent rows while a record is still being built.
+    All storage comes from the std::pmr::memory_resource given at construction (the parse arena, see ParseArena.h).
+*/
+
+class NullBitmap {
+    public:
+        explicit NullBitmap(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_words(resource) {}
+
+        size_t size() const { return m_size; }
+        bool test(size_t row) const { return (m_words[row / 64] >> (row % 64)) & 1u; }
+
+        void push_back(bool present) {
+            if (m_size % 64 == 0) m_words.push_back(0);
+            ++m_size;
+            set(m_size - 1, present);
+        }
+
+        void set(size_t row, bool present) {
+            uint64_t mask = uint64_t(1) << (row % 64);
+            if (present) m_words[row / 64] |= mask;
+            else m_words[row / 64] &= ~mask;
+        }
+
+        void truncate(size_t rows) {
+            if (rows >= m_size) return;
+            m_size = rows;
+            m_words.resize((rows + 63) / 64);
+            if (rows % 64 != 0) m_words.back() &= (uint64_t(1) << (rows % 64)) - 1;
+        }
+
+        void reserve(size_t rows) { m_words.reserve((rows + 63) / 64); }
+
+    private:
+        std::pmr::vector<uint64_t> m_words;
+        size_t m_size = 0;
+};
+
+// Fixed-size values with a null bitmap. Fields that are never missing use a plain std::pmr::vector.
+template <typename T>
+class Column {
+    public:
+        explicit Column(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_values(resource), m_present(resource) {}
+
+        size_t size() const { return m_values.size(); }
+        bool has_value(size_t row) const { return m_present.test(row); }
+        const T& operator[](size_t row) const { return m_values[row]; }    // Only meaningful if has_value(row)
+
+        std::optional<T> get(size_t row) const {
+            if (!has_value(row)) return std::nullopt;
+            return m_values[row];
+        }
+
+        void push_back(T value) {
+            m_values.push_back(std::move(value));
+            m_present.push_back(true);
+        }
+
+        void push_null() {
+            m_values.push_back(T{});
+            m_present.push_back(false);
+        }
+
+        void push_back(const std::optional<T>& value) {
+            if (value) push_back(*value);
+            else push_null();
+        }
+
+        // Overwrite the last row
+        void assign_back(T value) {
+            m_values.back() = std::move(value);
+            m_present.set(m_values.size() - 1, true);
+        }
+
+        void truncate(size_t rows) {
+            if (rows >= m_values.size()) return;
+            m_values.resize(rows);
+            m_present.truncate(rows);
+        }
+
+        void append(const Column& other) {
+            m_values.reserve(m_values.size() + other.size());
+            for (size_t row = 0; row < other.size(); ++row) {
+                m_values.push_back(other.m_values[row]);
+                m_present.push_back(other.has_value(row));
+            }
+        }
+
+        void reserve(size_t rows) {
+            m_values.reserve(rows);
+            m_present.reserve(rows);
+        }
+
+    private:
+        std::pmr::vector<T> m_values;
+        NullBitmap m_present;
+};
+
+class StringColumn {
+    public:
+        explicit StringColumn(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_chars(resource), m_offsets(1, 0, resource), m_present(resource) {}
+
+        size_t size() const { return m_offsets.size() - 1; }
+        bool has_value(size_t row) const { return m_present.test(row); }
+
+        std::string_view view(size_t row) const {
+            return std::string_view(m_chars.data() + m_offsets[row], m_offsets[row + 1] - m_offsets[row] - 1);
+        }
+        const char* c_str(size_t row) const { return m_chars.data() + m_offsets[row]; }
+
+        std::optional<std::string> get(size_t row) const {
+            if (!has_value(row)) return std::nullopt;
+            return std::string(view(row));
+        }
+
+        void push_back(std::string_view value) {
+            m_chars.append(value.data(), value.size());
+            m_chars.push_back('\0');
+            m_offsets.push_back(static_cast<uint32_t>(m_chars.size()));
+            m_present.push_back(true);
+        }
+
+        void push_null() {
+            m_chars.push_back('\0');
+            m_offsets.push_back(static_cast<uint32_t>(m_chars.size()));
+            m_present.push_back(false);
+        }
+
+        // Overwrite the last row, which is stored at the end of the character buffer
+        void assign_back(std::string_view value) {
+            size_t last = size() - 1;
+            m_chars.resize(m_offsets[last]);
+            m_chars.append(value.data(), value.size());
+            m_chars.push_back('\0');
+            m_offsets.back() = static_cast<uint32_t>(m_chars.size());
+            m_present.set(last, true);
+        }
+
+        void truncate(size_t rows) {
+            if (rows >= size()) return;
+            m_chars.resize(m_offsets[rows]);
+            m_offsets.resize(rows + 1);
+            m_present.truncate(rows);
+        }
+
+        void append(const StringColumn& other) {
+            for (size_t row = 0; row < other.size(); ++row) {
+                if (other.has_value(row)) push_back(other.view(row));
+                else push_null();
+            }
+        }
+
+        void reserve(size_t rows, size_t chars) {
+            m_offsets.reserve(rows + 1);
+            m_chars.reserve(chars);
+            m_present.reserve(rows);
+        }
+
+    private:
+        std::pmr::string m_chars;
+        std::pmr::vector<uint32_t> m_offsets;    // Row i spans [m_offsets[i], m_offsets[i + 1]), including its terminator
+        NullBitmap m_present;
+};
+
+// Airport ICAO codes referenced by records, stored once per batch and referred to by a small integer id
+class AirportIdTable {
+    public:
+        explicit AirportIdTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_icaos(resource), m_ids(resource) {}
+
+        uint32_t intern(std::string_view icao) {
+            // Records arrive grouped by airport, so the most recent id is almost always the one asked for
+            if (m_last_id < m_icaos.size() && m_icaos[m_last_id] == icao) return m_last_id;
+            auto found = m_ids.find(std::pmr::string(icao));
+            if (found != m_ids.end()) {
+                m_last_id = found->second;
+            } else {
+                m_last_id = static_cast<uint32_t>(m_icaos.size());
+                m_icaos.emplace_back(icao);
+                m_ids.emplace(m_icaos.back(), m_last_id);
+            }
+            return m_last_id;
+        }
+
+        std::string_view operator[](uint32_t id) const { return m_icaos[id]; }
+        const char* c_str(uint32_t id) const { return m_icaos[id].c_str(); }
+        size_t size() const { return m_icaos.size(); }
+
+    private:
+        std::pmr::vector<std::pmr::string> m_icaos;
+        std::pmr::unordered_map<std::pmr::string, uint32_t> m_ids;
+        uint32_t m_last_id = 0;
+};
@@ -0,0 +1,195 @@
+#include "DecompressingReader.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <optional>
+
+#ifdef NAVDATA_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef NAVDATA_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    // Size of the compressed reads and of the decompressed blocks handed to the reader
+    constexpr size_t INPUT_BLOCK_SIZE = 256 * 1024;
+    constexpr size_t OUTPUT_BLOCK_SIZE = 1 << 20;
+    // Decompressed blocks the background thread may run ahead of the tokenizer
+    constexpr size_t BLOCKS_IN_FLIGHT = 4;
+}
+
+Compression DecompressingReader::compression_of(const fs::path& file) {
+    fs::path extension = file.extension();
+    if (extension == ".gz") return Compression::Gzip;
+    if (extension == ".zst") return Compression::Zstd;
+    return Compression::None;
+}
+
+bool DecompressingReader::is_supported(Compression compression) {
+    switch (compression) {
+        case Compression::None:
+            return true;
+        case Compression::Gzip:
+#ifdef NAVDATA_HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::Zstd:
+#ifdef NAVDATA_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+DecompressingReader::DecompressingReader(const fs::path& file, Compression compression)
+    : m_path(file), m_compression(compression), m_blocks(BLOCKS_IN_FLIGHT) {
+    if (compression == Compression::None || !is_supported(compression)) {
+        throw std::runtime_error("Compressed input not supported by this build: " + m_path.string());
+    }
+    m_input.open(file, std::ios::binary);
+    if (!m_input.is_open()) {
+        throw std::runtime_error("Could not open file: " + m_path.string());
+    }
+    m_thread = std::thread([this] { decompress(); });
+}
+
+DecompressingReader::~DecompressingReader() {
+    // Stops the thread if the reader is abandoned before the end of the stream
+    m_blocks.close();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+size_t DecompressingReader::read(char* buffer, size_t size) {
+    size_t copied = 0;
+    while (copied < size) {
+        if (m_current_pos == m_current_block.size()) {
+            std::optional<std::vector<char>> block = m_blocks.pop();
+            if (!block) {
+                if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+                break;
+            }
+            m_current_block = std::move(*block);
+            m_current_pos = 0;
+            continue;
+        }
+        size_t count = std::min(size - copied, m_current_block.size() - m_current_pos);
+        std::memcpy(buffer + copied, m_current_block.data() + m_current_pos, count);
+        m_current_pos += count;
+        copied += count;
+    }
+    return copied;
+}
+
+void DecompressingReader::decompress() {
+    try {
+        if (m_compression == Compression::Gzip) {
+            inflate_gzip();
+        } else {
+            decompress_zstd();
+        }
+    } catch (...) {
+        m_error = std::current_exception();
+    }
+    m_blocks.close();
+}
+
+size_t DecompressingReader::read_input(std::vector<char>& buffer) {
+    m_input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    size_t bytes_read = static_cast<size_t>(m_input.gcount());
+    m_compressed_bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
+    return bytes_read;
+}
+
+bool DecompressingReader::emit_block(std::vector<char>& block) {
+    if (block.empty()) return true;
+    bool accepted = m_blocks.push(std::move(block));
+    block = std::vector<char>();
+    return accepted;
+}
+
+void DecompressingReader::inflate_gzip() {
+#ifdef NAVDATA_HAVE_ZLIB
+    z_stream stream{};
+    // 15 + 32: maximum window, and detect the gzip (or zlib) header automatically
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("Could not initialize gzip decompression for " + m_path.string());
+    }
+    struct StreamGuard {
+        z_stream& stream;
+        ~StreamGuard() { inflateEnd(&stream); }
+    } guard{stream};
+
+    std::vector<char> input(INPUT_BLOCK_SIZE);
+    std::vector<char> block;
+    bool member_complete = false;
+    while (size_t bytes_read = read_input(input)) {
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = static_cast<uInt>(bytes_read);
+        // Keep inflating while input is left or the last block came out full (zlib may still hold output)
+        do {
+            block.resize(OUTPUT_BLOCK_SIZE);
+            stream.next_out = reinterpret_cast<Bytef*>(block.data());
+            stream.avail_out = static_cast<uInt>(block.size());
+            int result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                // Archives may concatenate several gzip members, the next one starts from a reset stream
+                member_complete = true;
+                inflateReset(&stream);
+            } else if (result == Z_OK) {
+                member_complete = false;
+            } else if (result != Z_BUF_ERROR) {
+                throw std::runtime_error("gzip data error in " + m_path.string() + ": " + (stream.msg ? stream.msg : "unknown error"));
+            }
+            block.resize(block.size() - stream.avail_out);
+            if (!emit_block(block)) return;
+        } while (stream.avail_out == 0 || stream.avail_in > 0);
+    }
+    if (!member_complete) {
+        throw std::runtime_error("Unexpected end of gzip data in " + m_path.string());
+    }
+#endif
+}
+
+void DecompressingReader::decompress_zstd() {
+#ifdef NAVDATA_HAVE_ZSTD
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (stream == nullptr) {
+        throw std::runtime_error("Could not initialize zstd decompression for " + m_path.string());
+    }
+    struct StreamGuard {
+        ZSTD_DStream* stream;
+        ~StreamGuard() { ZSTD_freeDStream(stream); }
+    } guard{stream};
+    ZSTD_initDStream(stream);
+
+    std::vector<char> input(INPUT_BLOCK_SIZE);
+    std::vector<char> block;
+    size_t frame_remaining = 0;     // 0 once the current frame has been fully decoded and flushed
+    while (size_t bytes_read = read_input(input)) {
+        ZSTD_inBuffer in_buffer = { input.data(), bytes_read, 0 };
+        bool output_full = false;
+        // Keep decoding while input is left or the last block came out full (zstd may still hold output)
+        while (in_buffer.pos < in_buffer.size || output_full) {
+            block.resize(OUTPUT_BLOCK_SIZE);
+            ZSTD_outBuffer out_buffer = { block.data(), block.size(), 0 };
+            frame_remaining = ZSTD_decompressStream(stream, &out_buffer, &in_buffer);
+            if (ZSTD_isError(frame_remaining)) {
+                throw std::runtime_error("zstd data error in " + m_path.string() + ": " + ZSTD_getErrorName(frame_remaining));
+            }
+            output_full = out_buffer.pos == out_buffer.size;
+            block.resize(out_buffer.pos);
+            if (!emit_block(block)) return;
+        }
+    }
+    if (frame_remaining != 0) {
+        throw std::runtime_error("Unexpected end of zstd data in " + m_path.string());
+    }
+#endif
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "BoundedQueue.h"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+namespace fs = std::filesystem;
+
+/*
+    Streaming decompression of an apt.dat.gz / apt.dat.zst file. A background thread reads the compressed file and
+    inflates it into blocks that are handed over through a BoundedQueue, so decompression overlaps with tokenizing
+    and only a few blocks are held in memory at a time. read() hands out the decompressed bytes in order, the way
+    std::istream::read would. A decompression error is rethrown from read() once the blocks before it are consumed.
+    gzip needs zlib (NAVDATA_HAVE_ZLIB) and zstd needs libzstd (NAVDATA_HAVE_ZSTD); is_supported() reports what this
+    build can read.
+*/
+
+enum class Compression { None, Gzip, Zstd };
+
+class DecompressingReader {
+    public:
+        // Compression of a file, from its extension (.gz / .zst)
+        static Compression compression_of(const fs::path& file);
+        static bool is_supported(Compression compression);
+
+        // Throws std::runtime_error if the file can not be opened or the format is not supported by this build
+        DecompressingReader(const fs::path& file, Compression compression);
+        ~DecompressingReader();
+
+        DecompressingReader(const DecompressingReader&) = delete;
+        DecompressingReader& operator=(const DecompressingReader&) = delete;
+
+        // Copies up to 'size' decompressed bytes into 'buffer'. Returns 0 at the end of the stream.
+        size_t read(char* buffer, size_t size);
+
+        // Compressed bytes the background thread has consumed so far
+        uintmax_t compressed_bytes_read() const { return m_compressed_bytes_read.load(std::memory_order_relaxed); }
+
+    private:
+        fs::path m_path;
+        Compression m_compression;
+        std::ifstream m_input;                      // Only touched by the background thread once it has started
+        BoundedQueue<std::vector<char>> m_blocks;
+        std::vector<char> m_current_block;
+        size_t m_current_pos = 0;
+        std::atomic<uintmax_t> m_compressed_bytes_read{0};
+        std::exception_ptr m_error;                 // Set by the thread before it closes m_blocks
+        std::thread m_thread;                       // Declared last, so it starts after everything it uses
+
+        void decompress();
+        size_t read_input(std::vector<char>& buffer);
+        void inflate_gzip();
+        void decompress_zstd();
+        bool emit_block(std::vector<char>& block);  // false once the reader has been destroyed
+};
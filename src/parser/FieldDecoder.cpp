@@ -0,0 +1,82 @@
+#include "FieldDecoder.h"
+#include <charconv>
+#include <limits>
+
+namespace {
+    // std::from_chars rejects a leading '+', std::stoi/std::stod did not
+    inline const char* skip_plus_sign(const char* first, const char* last) {
+        if (first != last && *first == '+' && (last - first) > 1 && *(first + 1) != '-') return first + 1;
+        return first;
+    }
+
+    constexpr size_t NO_FIELD_INDEX = std::numeric_limits<size_t>::max();
+}
+
+bool decode_int(std::string_view token, int& value) noexcept {
+    const char* last = token.data() + token.size();
+    const char* first = skip_plus_sign(token.data(), last);
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    return ec == std::errc();
+}
+
+bool decode_double(std::string_view token, double& value) noexcept {
+    const char* last = token.data() + token.size();
+    const char* first = skip_plus_sign(token.data(), last);
+    auto [ptr, ec] = std::from_chars(first, last, value, std::chars_format::general);
+    return ec == std::errc();
+}
+
+std::string_view FieldDecoder::token(size_t index, const char* field_name) const {
+    if (index >= m_tokens.size()) {
+        fail(index, field_name, std::string_view(), "is missing");
+    }
+    return m_tokens[index];
+}
+
+int FieldDecoder::to_int(size_t index, const char* field_name) const {
+    std::string_view field = token(index, field_name);
+    int value = 0;
+    if (!decode_int(field, value)) {
+        fail(index, field_name, field, "is not a valid integer");
+    }
+    return value;
+}
+
+double FieldDecoder::to_double(size_t index, const char* field_name) const {
+    std::string_view field = token(index, field_name);
+    double value = 0.0;
+    if (!decode_double(field, value)) {
+        fail(index, field_name, field, "is not a valid number");
+    }
+    return value;
+}
+
+int FieldDecoder::to_int(std::string_view value, const char* field_name) const {
+    int result = 0;
+    if (!decode_int(value, result)) {
+        fail(NO_FIELD_INDEX, field_name, value, "is not a valid integer");
+    }
+    return result;
+}
+
+double FieldDecoder::to_double(std::string_view value, const char* field_name) const {
+    double result = 0.0;
+    if (!decode_double(value, result)) {
+        fail(NO_FIELD_INDEX, field_name, value, "is not a valid number");
+    }
+    return result;
+}
+
+void FieldDecoder::fail(size_t index, const char* field_name, std::string_view value, const char* reason) const {
+    std::string message = "Line " + std::to_string(m_line_number) + ": ";
+    if (index != NO_FIELD_INDEX) {
+        message += "field " + std::to_string(index) + " ";
+    }
+    message += "(" + std::string(field_name) + ")";
+    if (!value.empty()) {
+        message += " '" + std::string(value) + "'";
+    }
+    message += " ";
+    message += reason;
+    throw FieldDecodeError(m_line_number, index, message);
+}
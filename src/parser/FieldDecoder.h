@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+
+/*
+    Allocation-free, locale-independent decoding of numeric .dat fields.
+    The free functions are thin wrappers around std::from_chars that keep the leniency of std::stoi/std::stod the parser
+    used to rely on (an optional leading '+' is accepted and trailing garbage such as a '\r' is ignored), but work
+    directly on the std::string_view tokens, so no std::string is built per field.
+    FieldDecoder binds a tokenized line to its line number so a bad or missing field is reported precisely.
+*/
+
+bool decode_int(std::string_view token, int& value) noexcept;
+bool decode_double(std::string_view token, double& value) noexcept;
+
+class FieldDecodeError : public std::runtime_error {
+    public:
+        FieldDecodeError(int line_number, size_t field_index, const std::string& message)
+            : std::runtime_error(message), m_line_number(line_number), m_field_index(field_index) {}
+
+        int line_number() const { return m_line_number; }
+        size_t field_index() const { return m_field_index; }
+
+    private:
+        int m_line_number;
+        size_t m_field_index;
+};
+
+class FieldDecoder {
+    public:
+        FieldDecoder(const std::vector<std::string_view>& tokens, int line_number) : m_tokens(tokens), m_line_number(line_number) {}
+
+        std::string_view token(size_t index, const char* field_name) const;
+        int to_int(size_t index, const char* field_name) const;
+        double to_double(size_t index, const char* field_name) const;
+
+        // Decode a value that was assembled from several tokens (e.g. a 1302 metadata value)
+        int to_int(std::string_view value, const char* field_name) const;
+        double to_double(std::string_view value, const char* field_name) const;
+
+    private:
+        const std::vector<std::string_view>& m_tokens;
+        int m_line_number;
+
+        [[noreturn]] void fail(size_t index, const char* field_name, std::string_view value, const char* reason) const;
+};
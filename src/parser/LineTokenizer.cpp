@@ -0,0 +1,109 @@
+#include "LineTokenizer.h"
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NAVDATA_TOKENIZER_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NAVDATA_TOKENIZER_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+    inline bool is_delimiter(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    inline unsigned count_trailing_zeros(uint32_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+    }
+
+    // Tracks the token currently being scanned while we walk the line block by block
+    struct TokenScanState {
+        std::string_view line;
+        std::vector<std::string_view>& tokens;
+        bool in_token = false;
+        size_t token_start = 0;
+
+        void flip(size_t pos) {
+            if (in_token) {
+                tokens.emplace_back(line.data() + token_start, pos - token_start);
+            } else {
+                token_start = pos;
+            }
+            in_token = !in_token;
+        }
+
+        // 'delimiters' has bit i set when line[block_pos + i] is a space or tab, 'width' is the block size in bytes
+        void consume_block(size_t block_pos, uint32_t delimiters, unsigned width) {
+            uint32_t live = (width == 32) ? 0xFFFFFFFFu : ((1u << width) - 1u);
+            while (live) {
+                // Inside a token we look for the next delimiter, outside of one for the next non-delimiter
+                uint32_t transitions = (in_token ? delimiters : ~delimiters) & live;
+                if (!transitions) break;
+                unsigned bit = count_trailing_zeros(transitions);
+                flip(block_pos + bit);
+                // Drop every bit up to and including the transition we just handled
+                live &= (bit == 31) ? 0u : ~((2u << bit) - 1u);
+            }
+        }
+    };
+}
+
+size_t tokenize_whitespace(std::string_view line, std::vector<std::string_view>& tokens) {
+    tokens.clear();
+    TokenScanState state{line, tokens};
+    const char* data = line.data();
+    const size_t size = line.size();
+    size_t pos = 0;
+
+#if defined(NAVDATA_TOKENIZER_AVX2)
+    const __m256i spaces = _mm256_set1_epi8(' ');
+    const __m256i tabs = _mm256_set1_epi8('\t');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(block, spaces), _mm256_cmpeq_epi8(block, tabs));
+        state.consume_block(pos, static_cast<uint32_t>(_mm256_movemask_epi8(matches)), 32);
+    }
+#endif
+#if defined(NAVDATA_TOKENIZER_AVX2) || defined(NAVDATA_TOKENIZER_SSE2)
+    const __m128i spaces_128 = _mm_set1_epi8(' ');
+    const __m128i tabs_128 = _mm_set1_epi8('\t');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(block, spaces_128), _mm_cmpeq_epi8(block, tabs_128));
+        state.consume_block(pos, static_cast<uint32_t>(_mm_movemask_epi8(matches)), 16);
+    }
+#endif
+
+    // Scalar tail (or the whole line when no vector unit is available)
+    for (; pos < size; ++pos) {
+        if (is_delimiter(data[pos]) == state.in_token) {
+            state.flip(pos);
+        }
+    }
+    if (state.in_token) {
+        state.flip(size);
+    }
+    return tokens.size();
+}
+
+const char* tokenizer_backend_name() {
+#if defined(NAVDATA_TOKENIZER_AVX2)
+    return "avx2";
+#elif defined(NAVDATA_TOKENIZER_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
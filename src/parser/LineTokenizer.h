@@ -0,0 +1,20 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+/*
+    Whitespace tokenizer used by the .dat parsers. Splits a line on spaces and tabs (runs of delimiters are collapsed,
+    just like the old find_first_of(" \t") loop) and writes the token views into a caller-owned buffer. The buffer is
+    cleared but never shrunk, so once it has grown to the widest line in a file there is no heap traffic per line.
+
+    Delimiters are located 32 bytes (AVX2) or 16 bytes (SSE2) at a time, with a scalar loop for the tail of the line
+    and for targets without either instruction set. AVX2 is only used when the library is compiled for it
+    (NAVDATA_ENABLE_AVX2), SSE2 is part of every x86-64 baseline.
+*/
+
+// Returns the number of tokens written to 'tokens'. Views point into 'line'.
+size_t tokenize_whitespace(std::string_view line, std::vector<std::string_view>& tokens);
+
+// Name of the delimiter scanner compiled into this build ("avx2", "sse2" or "scalar")
+const char* tokenizer_backend_name();
@@ -1,126 +1,135 @@
 #include "LookaheadLineReader.h"
+#include "LineTokenizer.h"
 #include <iostream>
 #include <cctype>
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
 
 namespace fs = std::filesystem;
 
-LookaheadLineReader::LookaheadLineReader(const fs::path& file, bool logging) : m_path(file), m_line_number(0), m_bytes_processed(0), m_logging_enabled(logging) {
-    // Open in binary mode for accurate byte counting
+namespace {
+    // Block size for the buffered fallback when the file can not be memory-mapped
+    constexpr size_t READ_BLOCK_SIZE = 1 << 20;
+}
+
+LookaheadLineReader::LookaheadLineReader(const fs::path& file) : m_path(file), m_line_number(0), m_bytes_processed(0) {
+    Compression compression = DecompressingReader::compression_of(file);
+    if (compression != Compression::None) {
+        m_decompressor = std::make_unique<DecompressingReader>(file, compression);
+        m_read_buffer.resize(READ_BLOCK_SIZE);
+        return;
+    }
+
+    if (m_mapping.open(file)) {
+        m_data = m_mapping.data();
+        return;
+    }
+
+    // Fall back to block reads (binary mode for accurate byte counting)
     m_fstream.open(file, std::ios::binary);
     
     if (!m_fstream.is_open()) {
         throw std::runtime_error("Could not open file: " + m_path.string());
     }
-    if (fs::exists(m_path) && fs::is_regular_file(m_path)) {
-        m_file_size = fs::file_size(file);
-    }
+    m_read_buffer.resize(READ_BLOCK_SIZE);
 }
 
+LookaheadLineReader::LookaheadLineReader(std::string_view data, const fs::path& source, int lines_before)
+    : m_path(source), m_line_number(lines_before), m_bytes_processed(0), m_data(data) {}
+
 bool LookaheadLineReader::get_next_line() {
     bool success = false;
-    if (m_buffered_line) {
-        m_current_line = std::move(*m_buffered_line);
-        m_buffered_line.reset();
+    if (m_has_buffered_line) {
+        m_has_buffered_line = false;
         success = true;
     } else {
-        success = static_cast<bool>(std::getline(m_fstream, m_current_line));
+        success = read_line();
         m_line_number += 1; 
     }
 
     if (success) {
         m_bytes_processed += m_current_line.length() + 1;
     }
-    
-    get_progress(success);
     return success;
 }
 
 void LookaheadLineReader::put_line_back() {
-    if (m_buffered_line) {
+    if (m_has_buffered_line) {
         throw std::logic_error("Cannot put back more than one line at a time.");
     }
-    m_buffered_line = m_current_line;
+    // The view stays valid until the next read, so there is nothing to copy
+    m_has_buffered_line = true;
     m_bytes_processed -= m_current_line.length() + 1;
-    
-    // We want to clear the tokens vector to prepare for getting it again and re-tokenizing
-    m_line_tokens.clear();
 }
 
-std::vector<std::string_view> LookaheadLineReader::get_line_tokens() {
-    tokenize_line(m_current_line);
-    return m_line_tokens;
-}
+bool LookaheadLineReader::read_line() {
+    while (true) {
+        std::string_view remaining = m_data.substr(m_data_pos);
+        size_t newline = remaining.find('\n');
+        if (newline != std::string_view::npos) {
+            m_current_line = remaining.substr(0, newline);
+            m_data_pos += newline + 1;
+            return true;
+        }
 
-int LookaheadLineReader::get_row_code() {
-    if (!m_line_tokens.empty()) {
-        try {
-            std::string rc_line_token = std::string(m_line_tokens[0]);
-            if (std::isdigit(rc_line_token[0])) {
-                m_row_code = std::stoi(rc_line_token);
-            } else {
-                m_row_code = -1;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "Error computing row code: " << e.what() << std::endl;
-            throw;
+        if (!refill_read_buffer()) {
+            // No more input, hand out a last line that is missing its trailing newline
+            remaining = m_data.substr(m_data_pos);
+            if (remaining.empty()) return false;
+            m_current_line = remaining;
+            m_data_pos = m_data.size();
+            return true;
         }
     }
-    return m_row_code;
 }
 
-void LookaheadLineReader::tokenize_line(std::string_view line) {
-    std::vector<std::string_view> tokens;
-    size_t start = 0, end;
-    while ((end = line.find_first_of(" \t", start)) != std::string_view::npos) {
-        if (end > start) {
-            tokens.emplace_back(line.substr(start, end - start));
-        }
-        start = line.find_first_not_of(" \t", end);
-        if (start == std::string_view::npos) break;
+bool LookaheadLineReader::refill_read_buffer() {
+    // Mapped files are fully available up front
+    if (!m_decompressor && (!m_fstream.is_open() || m_fstream.eof())) return false;
+
+    // Keep the unconsumed tail (a partial line) at the front of the buffer
+    size_t remaining = m_data.size() - m_data_pos;
+    if (remaining > 0 && m_data_pos > 0) {
+        std::memmove(m_read_buffer.data(), m_data.data() + m_data_pos, remaining);
+    }
+    if (remaining == m_read_buffer.size()) {
+        // A single line longer than the buffer, make room for it
+        m_read_buffer.resize(m_read_buffer.size() * 2);
     }
-    if (start < line.size()) {
-        tokens.emplace_back(line.substr(start));
+
+    size_t bytes_read = 0;
+    if (m_decompressor) {
+        bytes_read = m_decompressor->read(m_read_buffer.data() + remaining, m_read_buffer.size() - remaining);
+    } else {
+        m_fstream.read(m_read_buffer.data() + remaining, static_cast<std::streamsize>(m_read_buffer.size() - remaining));
+        bytes_read = static_cast<size_t>(m_fstream.gcount());
     }
-    m_line_tokens = tokens;
+    m_data = std::string_view(m_read_buffer.data(), remaining + bytes_read);
+    m_data_pos = 0;
+    return bytes_read > 0;
 }
 
-void LookaheadLineReader::get_progress(bool in_progress) {
-    if (m_file_size == 0) return;
-
-    int bar_width = 50, update_interval = 50;
-    if (in_progress && m_logging_enabled) {
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - m_last_progress_update).count() < update_interval) return;
-        m_last_progress_update = now;
-
-        float percent = static_cast<float>(m_bytes_processed) / m_file_size;
-        if (percent > 1.0f) percent = 1.0f;
-
-        int pos = static_cast<int>(bar_width * percent);
-
-        m_progress_stream.str("");
-        m_progress_stream.clear();
-        m_progress_stream << "\r[";
-        for (int i = 0; i < bar_width; ++i) {
-            if (i < pos) {
-                m_progress_stream << "=";
-            } else if (i == pos) {
-                m_progress_stream << ">";
-            } else {
-                m_progress_stream << " ";
-            }
-        }
+std::vector<std::string_view>& LookaheadLineReader::get_line_tokens(std::vector<std::string_view>& tokens) {
+    tokenize_whitespace(m_current_line, tokens);
+    return tokens;
+}
 
-        m_progress_stream << "] " << std::setw(3) << static_cast<int>(percent * 100.0) << "%" << std::setw(11) << m_bytes_processed << "/" << m_file_size << " bytes | " << m_path;
-        std::cout << m_progress_stream.str();
-        std::cout.flush();
-    } else if (!in_progress && m_logging_enabled) {
-        std::cout << "\r[";
-        for (int i = 0; i < bar_width; ++i) {
-            std::cout << "=";
+int LookaheadLineReader::get_row_code() {
+    // The row code is the first token of the line, so we decode it in place rather than copying it into a std::string for stoi
+    size_t start = m_current_line.find_first_not_of(" \t");
+    if (start != std::string_view::npos) {
+        const char* first = m_current_line.data() + start;
+        const char* last = m_current_line.data() + m_current_line.size();
+        if (std::isdigit(static_cast<unsigned char>(*first))) {
+            auto [ptr, ec] = std::from_chars(first, last, m_row_code);
+            if (ec != std::errc()) {
+                std::cerr << "Error computing row code: value out of range at line " << m_line_number << std::endl;
+                throw std::out_of_range("Row code out of range: " + std::string(m_current_line.substr(start, ptr - first)));
+            }
+        } else {
+            m_row_code = -1;
         }
-        std::cout << "] 100%" << std::setw(11) << m_bytes_processed << "/" << m_file_size << " bytes | " << m_path << std::endl;
-    } else {
-        return;
     }
-}
\ No newline at end of file
+    return m_row_code;
+}
@@ -1,50 +1,66 @@
 #pragma once
+#include "MappedFile.h"
+#include "DecompressingReader.h"
 #include <string>
 #include <string_view>
-#include <sstream>
 #include <vector>
 #include <fstream>
 #include <filesystem>
 #include <optional>
-#include <chrono>
+#include <memory>
 
 namespace fs = std::filesystem;
 
 /*
-    The purpose of this class is to act as a wrapper for getline() that allows for "putting back" lines.
-    The pattern is simple: We use a private buffer to hold lines we have "put back". So any time get_next_line() is called,
-    we check m_buffered_line: If it's empty, we call getline() as per usual, but if something is in m_buffered_line, we std::move() it
-    into the current_line, and clear the buffer. When we call put_line_back() we check if the buffer is full, and add the line to it or throw
-    an error (only one line is allowed in the buffer at a time). We also incorporate tokenization here as a convenience, since the parser design
-    revolves around it, as well as row_code generation.
+    The purpose of this class is to act as a line reader that allows for "putting back" lines.
+    Lines are handed out as std::string_views into the input instead of being copied into a std::string. The input is
+    memory-mapped whenever the platform allows it, so a line is just a view into the mapping. If mapping fails we fall
+    back to reading the file in large blocks into m_read_buffer, and lines are views into that buffer (it is only
+    refilled when the next line is requested, so the current line always stays valid). Compressed inputs (apt.dat.gz,
+    apt.dat.zst) fill the same block buffer from a DecompressingReader, which inflates on its own thread.
+    Putting back a line is therefore free: we simply remember that the current view should be returned again by the
+    next call to get_next_line() (only one line is allowed to be put back at a time). We also incorporate tokenization
+    here as a convenience, since the parser design revolves around it, as well as row_code generation. Tokens are written
+    into a buffer owned by the caller (see LineTokenizer.h) so they can be reused from line to line.
 */
 
 class LookaheadLineReader {
     public:
-        LookaheadLineReader(const fs::path& file, bool logging = false);
+        explicit LookaheadLineReader(const fs::path& file);
+        // Reads lines from a slice of a buffer the caller keeps alive (used to parse chunks of a mapped file).
+        // 'lines_before' is the number of lines preceding the slice, so line numbers stay absolute.
+        LookaheadLineReader(std::string_view data, const fs::path& source, int lines_before);
         bool get_next_line();
         void put_line_back();
-        std::vector<std::string_view> get_line_tokens();
+        std::string_view get_line() const { return m_current_line; }
+        std::vector<std::string_view>& get_line_tokens(std::vector<std::string_view>& tokens);
         int get_row_code();
         int get_line_number() { return m_line_number; }
+        uintmax_t get_bytes_processed() const { return m_bytes_processed; }
+        // Bytes of the file on disk behind the lines read so far. For compressed input this counts the compressed
+        // bytes the decompressor has consumed, which runs a few blocks ahead of the lines handed out.
+        uintmax_t get_source_bytes_processed() const {
+            return m_decompressor ? m_decompressor->compressed_bytes_read() : m_bytes_processed;
+        }
+        bool is_memory_mapped() const { return m_mapping.is_open(); }
 
     private:
         fs::path m_path;
         int m_line_number;
         uintmax_t m_bytes_processed;
-        bool m_logging_enabled;
+
+        // Input backends: the whole file mapped, or a block buffer filled from m_fstream or m_decompressor
+        MappedFile m_mapping;
         std::ifstream m_fstream;
-        uintmax_t m_file_size;                          // File size in bytes
-        
-        // Progress Tracking (mutable because it's internal bookkeeping)
-        mutable std::chrono::steady_clock::time_point m_last_progress_update;
-        mutable std::ostringstream m_progress_stream;
-        
-        std::string m_current_line;
-        std::optional<std::string> m_buffered_line;
-        int m_row_code;
-        std::vector<std::string_view> m_line_tokens;
+        std::unique_ptr<DecompressingReader> m_decompressor;
+        std::vector<char> m_read_buffer;
+        std::string_view m_data;                        // Bytes currently available to split into lines
+        size_t m_data_pos = 0;                          // Start of the next line within m_data
+
+        std::string_view m_current_line;
+        bool m_has_buffered_line = false;
+        int m_row_code = -1;
 
-        void tokenize_line(std::string_view line);
-        void get_progress(bool in_progress = true);
-};
\ No newline at end of file
+        bool read_line();
+        bool refill_read_buffer();
+};
@@ -0,0 +1,190 @@
+#include "MappedFile.h"
+#include <utility>
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+void prefetch_file(const fs::path&) noexcept {
+    // No cheap whole-file read-ahead hint on Windows, FILE_FLAG_SEQUENTIAL_SCAN on open does the job once parsing starts
+}
+#else
+void prefetch_file(const fs::path& file) noexcept {
+#ifdef POSIX_FADV_WILLNEED
+    int fd = ::open(file.c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0) return;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    (void)file;
+#endif
+}
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_file_handle = std::exchange(other.m_file_handle, nullptr);
+        m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const fs::path& file) noexcept {
+    close();
+    HANDLE file_handle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    m_file_handle = file_handle;
+    m_mapping_handle = mapping_handle;
+    m_data = static_cast<const char*>(view);
+    m_size = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() noexcept {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping_handle) CloseHandle(static_cast<HANDLE>(m_mapping_handle));
+    if (m_file_handle) CloseHandle(static_cast<HANDLE>(m_file_handle));
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping_handle = nullptr;
+    m_file_handle = nullptr;
+}
+#else
+bool MappedFile::open(const fs::path& file) noexcept {
+    close();
+    // Check before opening, opening a FIFO would block until a writer shows up
+    struct stat file_stat;
+    if (::stat(file.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) {
+        return false;
+    }
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    size_t size = static_cast<size_t>(file_stat.st_size);
+    void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file, the descriptor is no longer needed
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+
+    // We only ever walk the file front to back, so let the kernel read ahead aggressively
+    ::madvise(view, size, MADV_SEQUENTIAL);
+
+    m_data = static_cast<const char*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::close() noexcept {
+    if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
+
+namespace {
+    constexpr uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+
+    uint64_t rotate_left(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Folds whole 8-byte words into the state and returns the bytes left over (fewer than 8)
+    size_t hash_words(uint64_t& state, const char* data, size_t size) {
+        size_t words = size / 8;
+        for (size_t i = 0; i < words; ++i) {
+            uint64_t word;
+            std::memcpy(&word, data + i * 8, sizeof(word));
+            state = rotate_left(state ^ (word * HASH_PRIME_2), 31) * HASH_PRIME_1;
+        }
+        return size - words * 8;
+    }
+
+    uint64_t finish_hash(uint64_t state, const char* tail, size_t tail_size, uint64_t total_size) {
+        for (size_t i = 0; i < tail_size; ++i) {
+            state = rotate_left(state ^ (static_cast<unsigned char>(tail[i]) * HASH_PRIME_2), 11) * HASH_PRIME_1;
+        }
+        state ^= total_size;
+        state ^= state >> 33;
+        state *= HASH_PRIME_2;
+        state ^= state >> 29;
+        return state;
+    }
+}
+
+uint64_t hash_file_contents(const fs::path& file) {
+    uint64_t state = HASH_PRIME_1;
+    MappedFile mapping;
+    if (mapping.open(file)) {
+        std::string_view data = mapping.data();
+        size_t tail = hash_words(state, data.data(), data.size());
+        return finish_hash(state, data.data() + data.size() - tail, tail, data.size());
+    }
+
+    // Read in blocks instead (also for empty files, which cannot be mapped)
+    std::ifstream input(file, std::ios::binary);
+    if (!input) return 0;
+    std::vector<char> buffer(1 << 20);
+    uint64_t total_size = 0;
+    size_t pending = 0;         // Bytes carried over to complete a word
+    while (input) {
+        input.read(buffer.data() + pending, static_cast<std::streamsize>(buffer.size() - pending));
+        size_t available = pending + static_cast<size_t>(input.gcount());
+        total_size += static_cast<uint64_t>(input.gcount());
+        size_t tail = hash_words(state, buffer.data(), available);
+        std::memmove(buffer.data(), buffer.data() + available - tail, tail);
+        pending = tail;
+    }
+    return finish_hash(state, buffer.data(), pending, total_size);
+}
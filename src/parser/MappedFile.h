@@ -0,0 +1,48 @@
+#pragma once
+#include <string_view>
+#include <filesystem>
+#include <cstddef>
+#include <cstdint>
+
+namespace fs = std::filesystem;
+
+/*
+    Read-only memory mapping of a whole file. The mapping is released when the object is destroyed, so any
+    std::string_view handed out from data() must not outlive it. open() returns false (instead of throwing) when
+    the platform refuses the mapping (empty files, pipes, some network shares...), which lets callers fall back
+    to regular buffered reads.
+*/
+
+class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool open(const fs::path& file) noexcept;
+        void close() noexcept;
+
+        bool is_open() const { return m_data != nullptr; }
+        std::string_view data() const { return std::string_view(m_data, m_size); }
+        size_t size() const { return m_size; }
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file_handle = nullptr;
+        void* m_mapping_handle = nullptr;
+#endif
+};
+
+// Hints the OS to start reading a whole file into the page cache in the background, so that a later open/mmap
+// finds it warm. Does nothing on platforms without such a hint.
+void prefetch_file(const fs::path& file) noexcept;
+
+// Fast 64-bit hash of a file's bytes, to tell whether a file changed or two files are identical. Not cryptographic.
+// A file that cannot be read hashes to 0, the parse that follows reports the actual error.
+uint64_t hash_file_contents(const fs::path& file);
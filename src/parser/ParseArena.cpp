@@ -0,0 +1,46 @@
+#include "ParseArena.h"
+
+namespace {
+    void store_max(std::atomic<size_t>& target, size_t value) {
+        size_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+}
+
+void ArenaStats::on_reserve(size_t bytes) {
+    size_t live = m_live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    store_max(m_peak_live_bytes, live);
+}
+
+void ArenaStats::on_arena_destroyed(size_t reserved_bytes) {
+    store_max(m_largest_arena_bytes, reserved_bytes);
+}
+
+ArenaUsage ArenaStats::usage() const {
+    ArenaUsage usage;
+    usage.arenas_created = m_arenas_created.load(std::memory_order_relaxed);
+    usage.largest_arena_bytes = m_largest_arena_bytes.load(std::memory_order_relaxed);
+    usage.peak_live_bytes = m_peak_live_bytes.load(std::memory_order_relaxed);
+    return usage;
+}
+
+ParseArena::ParseArena(std::shared_ptr<ArenaStats> stats, size_t initial_size)
+    : m_stats(std::move(stats)), m_buffer(initial_size, this) {
+    m_stats->on_arena_created();
+}
+
+ParseArena::~ParseArena() {
+    m_stats->on_arena_destroyed(m_reserved_bytes);
+}
+
+void* ParseArena::do_allocate(size_t bytes, size_t alignment) {
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    m_reserved_bytes += bytes;
+    m_stats->on_reserve(bytes);
+    return p;
+}
+
+void ParseArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    m_stats->on_release(bytes);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <memory_resource>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+
+/*
+    Monotonic arena that owns everything allocated while parsing one parse unit (a small file, or about
+    PARSE_UNIT_BYTES of a large one). Columns allocate from resource() with no per-allocation bookkeeping, nothing is
+    freed piece by piece, and the whole arena is released at once when the last batch that refers to it is destroyed
+    (batches hold it through a std::shared_ptr).
+    Memory the arena takes from the system is counted in a shared ArenaStats, which the parser exposes so the initial
+    arena size can be tuned.
+*/
+
+struct ArenaUsage {
+    size_t arenas_created = 0;
+    size_t largest_arena_bytes = 0;     // Most memory any single arena reserved
+    size_t peak_live_bytes = 0;         // Most memory reserved by all live arenas at once
+};
+
+class ArenaStats {
+    public:
+        void on_arena_created() { m_arenas_created.fetch_add(1, std::memory_order_relaxed); }
+        void on_reserve(size_t bytes);
+        void on_release(size_t bytes) { m_live_bytes.fetch_sub(bytes, std::memory_order_relaxed); }
+        void on_arena_destroyed(size_t reserved_bytes);
+
+        ArenaUsage usage() const;
+
+    private:
+        std::atomic<size_t> m_arenas_created{0};
+        std::atomic<size_t> m_largest_arena_bytes{0};
+        std::atomic<size_t> m_live_bytes{0};
+        std::atomic<size_t> m_peak_live_bytes{0};
+};
+
+// The arena is its own upstream resource: it forwards to new/delete and counts what its monotonic buffer reserves
+class ParseArena : private std::pmr::memory_resource {
+    public:
+        ParseArena(std::shared_ptr<ArenaStats> stats, size_t initial_size);
+        ~ParseArena() override;
+
+        ParseArena(const ParseArena&) = delete;
+        ParseArena& operator=(const ParseArena&) = delete;
+
+        std::pmr::memory_resource* resource() { return &m_buffer; }
+        size_t reserved_bytes() const { return m_reserved_bytes; }
+
+    private:
+        std::shared_ptr<ArenaStats> m_stats;
+        size_t m_reserved_bytes = 0;
+        std::pmr::monotonic_buffer_resource m_buffer;   // Declared last so it is released while the counters still exist
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
@@ -0,0 +1,164 @@
+#include "ParsedAptData.h"
+
+namespace {
+    template <typename T>
+    void append_values(std::pmr::vector<T>& into, const std::pmr::vector<T>& from) {
+        into.insert(into.end(), from.begin(), from.end());
+    }
+
+    void append_airport_ids(std::pmr::vector<uint32_t>& into, const std::pmr::vector<uint32_t>& from, const std::vector<uint32_t>& airport_id_map) {
+        into.reserve(into.size() + from.size());
+        for (uint32_t id : from) {
+            into.push_back(airport_id_map[id]);
+        }
+    }
+}
+
+void AirportColumns::append_null_row() {
+    icao.push_null();
+    type.push_null();
+    elevation.push_null();
+    airport_name.push_null();
+    iata.push_null();
+    faa.push_null();
+    city.push_null();
+    country.push_null();
+    state.push_null();
+    region.push_null();
+    transition_alt.push_null();
+    transition_level.push_null();
+    latitude.push_null();
+    longitude.push_null();
+    record.emplace_back();
+}
+
+void AirportColumns::truncate(size_t rows) {
+    icao.truncate(rows);
+    type.truncate(rows);
+    elevation.truncate(rows);
+    airport_name.truncate(rows);
+    iata.truncate(rows);
+    faa.truncate(rows);
+    city.truncate(rows);
+    country.truncate(rows);
+    state.truncate(rows);
+    region.truncate(rows);
+    transition_alt.truncate(rows);
+    transition_level.truncate(rows);
+    latitude.truncate(rows);
+    longitude.truncate(rows);
+    record.resize(rows);
+}
+
+void AirportColumns::append(const AirportColumns& other) {
+    icao.append(other.icao);
+    type.append(other.type);
+    elevation.append(other.elevation);
+    airport_name.append(other.airport_name);
+    iata.append(other.iata);
+    faa.append(other.faa);
+    city.append(other.city);
+    country.append(other.country);
+    state.append(other.state);
+    region.append(other.region);
+    transition_alt.append(other.transition_alt);
+    transition_level.append(other.transition_level);
+    latitude.append(other.latitude);
+    longitude.append(other.longitude);
+    append_values(record, other.record);
+}
+
+void RunwayEndColumns::append(const RunwayEndColumns& other) {
+    rw_number.append(other.rw_number);
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    append_values(d_threshold, other.d_threshold);
+    append_values(rw_marking_code, other.rw_marking_code);
+    append_values(rw_app_light_code, other.rw_app_light_code);
+}
+
+void RunwayColumns::append(const RunwayColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(width, other.width);
+    append_values(surface, other.surface);
+    end1.append(other.end1);
+    end2.append(other.end2);
+}
+
+void TaxiwayNodeColumns::append(const TaxiwayNodeColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(node_id, other.node_id);
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    node_type.append(other.node_type);
+}
+
+void TaxiwayEdgeColumns::append(const TaxiwayEdgeColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(start_node_id, other.start_node_id);
+    append_values(end_node_id, other.end_node_id);
+    append_values(is_two_way, other.is_two_way);
+    width_class.append(other.width_class);
+    taxiway_name.append(other.taxiway_name);
+}
+
+void LinearFeatureColumns::append(const LinearFeatureColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(feature_sequence, other.feature_sequence);
+    line_type.append(other.line_type);
+}
+
+void LinearFeatureNodeColumns::truncate(size_t rows) {
+    if (rows >= size()) return;
+    airport.resize(rows);
+    feature_sequence.resize(rows);
+    latitude.resize(rows);
+    longitude.resize(rows);
+    bezier_latitude.truncate(rows);
+    bezier_longitude.truncate(rows);
+    node_order.resize(rows);
+}
+
+void LinearFeatureNodeColumns::append(const LinearFeatureNodeColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(feature_sequence, other.feature_sequence);
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    bezier_latitude.append(other.bezier_latitude);
+    bezier_longitude.append(other.bezier_longitude);
+    append_values(node_order, other.node_order);
+}
+
+void TaxiwaySignColumns::append(const TaxiwaySignColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    append_values(heading, other.heading);
+    append_values(size_class, other.size_class);
+    sign_text.append(other.sign_text);
+}
+
+void StartupLocationColumns::append(const StartupLocationColumns& other, const std::vector<uint32_t>& airport_id_map) {
+    append_airport_ids(airport, other.airport, airport_id_map);
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    append_values(heading, other.heading);
+    location_type.append(other.location_type);
+    ramp_name.append(other.ramp_name);
+}
+
+void ParsedAptData::append(const ParsedAptData& other) {
+    std::vector<uint32_t> airport_id_map(other.airport_ids.size());
+    for (uint32_t id = 0; id < other.airport_ids.size(); ++id) {
+        airport_id_map[id] = airport_ids.intern(other.airport_ids[id]);
+    }
+
+    airports.append(other.airports);
+    runways.append(other.runways, airport_id_map);
+    taxiway_nodes.append(other.taxiway_nodes, airport_id_map);
+    taxiway_edges.append(other.taxiway_edges, airport_id_map);
+    linear_features.append(other.linear_features, airport_id_map);
+    linear_feature_nodes.append(other.linear_feature_nodes, airport_id_map);
+    taxiway_signs.append(other.taxiway_signs, airport_id_map);
+    startup_locations.append(other.startup_locations, airport_id_map);
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include "Columns.h"
+#include "ParseArena.h"
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+
+/*
+    Columnar form of the records parsed from an apt.dat file. Every record group is a structure of arrays: one column
+    per field, coordinates in contiguous double arrays, and a null bitmap only for fields the file may leave out.
+    Records refer to their airport through an id into ParsedAptData::airport_ids rather than carrying their own copy
+    of the ICAO code. This is the form the parser produces and the insert functions consume; the public Types.h structs
+    are only built when reading from the database.
+    Every column of a batch allocates from the batch's parse arena, which the batch keeps alive (see ParseArena.h).
+*/
+
+// Where an airport's record lies in its apt.dat: from the header line up to the next airport header. Offsets count
+// bytes of the decompressed input.
+struct AptRecordSpan {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    int first_line = 0;             // Line number of the header
+};
+
+struct AirportColumns {
+    explicit AirportColumns(std::pmr::memory_resource* resource)
+        : icao(resource), type(resource), elevation(resource), airport_name(resource), iata(resource), faa(resource),
+          city(resource), country(resource), state(resource), region(resource), transition_alt(resource),
+          transition_level(resource), latitude(resource), longitude(resource), record(resource) {}
+
+    // Set from the 1/16/17 header (icao may be replaced by a 1302 icao_code)
+    StringColumn icao;
+    StringColumn type;
+    Column<int> elevation;
+    StringColumn airport_name;
+
+    // Optional 1302 metadata
+    StringColumn iata;
+    StringColumn faa;
+    StringColumn city;
+    StringColumn country;
+    StringColumn state;
+    StringColumn region;
+    StringColumn transition_alt;
+    StringColumn transition_level;
+    Column<double> latitude;
+    Column<double> longitude;
+
+    // Set by the parser, indexed so a single airport can be parsed again (see XPlaneDatParser::parse_airport_record)
+    std::pmr::vector<AptRecordSpan> record;
+
+    size_t size() const { return icao.size(); }
+    void append_null_row();                 // Starts an airport whose fields are filled in with assign_back()
+    void truncate(size_t rows);
+    void append(const AirportColumns& other);
+};
+
+struct RunwayEndColumns {
+    explicit RunwayEndColumns(std::pmr::memory_resource* resource)
+        : rw_number(resource), latitude(resource), longitude(resource), d_threshold(resource),
+          rw_marking_code(resource), rw_app_light_code(resource) {}
+
+    StringColumn rw_number;
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    std::pmr::vector<double> d_threshold;
+    std::pmr::vector<int> rw_marking_code;
+    std::pmr::vector<int> rw_app_light_code;
+
+    void append(const RunwayEndColumns& other);
+};
+
+struct RunwayColumns {
+    explicit RunwayColumns(std::pmr::memory_resource* resource)
+        : airport(resource), width(resource), surface(resource), end1(resource), end2(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<double> width;
+    std::pmr::vector<int> surface;
+    RunwayEndColumns end1;
+    RunwayEndColumns end2;
+
+    size_t size() const { return airport.size(); }
+    void append(const RunwayColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+struct TaxiwayNodeColumns {
+    explicit TaxiwayNodeColumns(std::pmr::memory_resource* resource)
+        : airport(resource), node_id(resource), latitude(resource), longitude(resource), node_type(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<int> node_id;
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    StringColumn node_type;
+
+    size_t size() const { return airport.size(); }
+    void append(const TaxiwayNodeColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+struct TaxiwayEdgeColumns {
+    explicit TaxiwayEdgeColumns(std::pmr::memory_resource* resource)
+        : airport(resource), start_node_id(resource), end_node_id(resource), is_two_way(resource),
+          width_class(resource), taxiway_name(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<int> start_node_id;
+    std::pmr::vector<int> end_node_id;
+    std::pmr::vector<uint8_t> is_two_way;
+    StringColumn width_class;
+    StringColumn taxiway_name;
+
+    size_t size() const { return airport.size(); }
+    void append(const TaxiwayEdgeColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+struct LinearFeatureColumns {
+    explicit LinearFeatureColumns(std::pmr::memory_resource* resource)
+        : airport(resource), feature_sequence(resource), line_type(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<int> feature_sequence;
+    StringColumn line_type;
+
+    size_t size() const { return airport.size(); }
+    void append(const LinearFeatureColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+struct LinearFeatureNodeColumns {
+    explicit LinearFeatureNodeColumns(std::pmr::memory_resource* resource)
+        : airport(resource), feature_sequence(resource), latitude(resource), longitude(resource),
+          bezier_latitude(resource), bezier_longitude(resource), node_order(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<int> feature_sequence;
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    Column<double> bezier_latitude;
+    Column<double> bezier_longitude;
+    std::pmr::vector<int> node_order;
+
+    size_t size() const { return airport.size(); }
+    void truncate(size_t rows);
+    void append(const LinearFeatureNodeColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+struct TaxiwaySignColumns {
+    explicit TaxiwaySignColumns(std::pmr::memory_resource* resource)
+        : airport(resource), latitude(resource), longitude(resource), heading(resource), size_class(resource),
+          sign_text(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    std::pmr::vector<double> heading;
+    std::pmr::vector<int> size_class;
+    StringColumn sign_text;
+
+    size_t size() const { return airport.size(); }
+    void append(const TaxiwaySignColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+struct StartupLocationColumns {
+    explicit StartupLocationColumns(std::pmr::memory_resource* resource)
+        : airport(resource), latitude(resource), longitude(resource), heading(resource), location_type(resource),
+          ramp_name(resource) {}
+
+    std::pmr::vector<uint32_t> airport;
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    std::pmr::vector<double> heading;
+    StringColumn location_type;     // Null for legacy (row code 15) startup locations
+    StringColumn ramp_name;
+
+    size_t size() const { return airport.size(); }
+    void append(const StartupLocationColumns& other, const std::vector<uint32_t>& airport_id_map);
+};
+
+// Container for parsed data from a .dat file: a whole file, or a single airport when parsed in streaming mode
+struct ParsedAptData {
+    // Without an arena the batch uses the default memory resource
+    ParsedAptData() : ParsedAptData(nullptr) {}
+    explicit ParsedAptData(std::shared_ptr<ParseArena> parse_arena)
+        : arena(std::move(parse_arena)), airport_ids(resource()), airports(resource()), runways(resource()),
+          taxiway_nodes(resource()), taxiway_edges(resource()), linear_features(resource()), linear_feature_nodes(resource()),
+          taxiway_signs(resource()), startup_locations(resource()) {}
+
+    ParsedAptData(ParsedAptData&&) = default;
+    ParsedAptData& operator=(ParsedAptData&&) = delete;     // Would copy element-wise into the old arena
+
+    std::shared_ptr<ParseArena> arena;      // Declared first so it outlives the columns that allocate from it
+    AirportIdTable airport_ids;
+    AirportColumns airports;
+    RunwayColumns runways;
+    TaxiwayNodeColumns taxiway_nodes;
+    TaxiwayEdgeColumns taxiway_edges;
+    LinearFeatureColumns linear_features;
+    LinearFeatureNodeColumns linear_feature_nodes;
+    TaxiwaySignColumns taxiway_signs;
+    StartupLocationColumns startup_locations;
+
+    bool empty() const {
+        return airports.size() == 0 && runways.size() == 0 && taxiway_nodes.size() == 0 && taxiway_edges.size() == 0 &&
+               linear_features.size() == 0 && linear_feature_nodes.size() == 0 && taxiway_signs.size() == 0 &&
+               startup_locations.size() == 0;
+    }
+
+    // Appends another batch, re-interning its airport ids into this one
+    void append(const ParsedAptData& other);
+
+    std::pmr::memory_resource* resource() const { return arena ? arena->resource() : std::pmr::get_default_resource(); }
+};
@@ -0,0 +1,69 @@
+#include "ParsedNavData.h"
+
+namespace {
+    template <typename T>
+    void append_values(std::pmr::vector<T>& into, const std::pmr::vector<T>& from) {
+        into.insert(into.end(), from.begin(), from.end());
+    }
+}
+
+void NavaidColumns::append(const NavaidColumns& other) {
+    append_values(row_code, other.row_code);
+    navaid_type.append(other.navaid_type);
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    append_values(elevation, other.elevation);
+    append_values(frequency, other.frequency);
+    append_values(range, other.range);
+    append_values(bearing, other.bearing);
+    glideslope_angle.append(other.glideslope_angle);
+    ident.append(other.ident);
+    airport_icao.append(other.airport_icao);
+    icao_region.append(other.icao_region);
+    name.append(other.name);
+}
+
+void FixColumns::append(const FixColumns& other) {
+    append_values(latitude, other.latitude);
+    append_values(longitude, other.longitude);
+    ident.append(other.ident);
+    airport_icao.append(other.airport_icao);
+    icao_region.append(other.icao_region);
+    waypoint_type.append(other.waypoint_type);
+}
+
+void AirwaySegmentColumns::append(const AirwaySegmentColumns& other) {
+    airway_name.append(other.airway_name);
+    from_ident.append(other.from_ident);
+    from_region.append(other.from_region);
+    append_values(from_type, other.from_type);
+    to_ident.append(other.to_ident);
+    to_region.append(other.to_region);
+    append_values(to_type, other.to_type);
+    direction.append(other.direction);
+    append_values(airway_level, other.airway_level);
+    append_values(base_fl, other.base_fl);
+    append_values(top_fl, other.top_fl);
+}
+
+void ProcedureLegColumns::append(const ProcedureLegColumns& other) {
+    airport_icao.append(other.airport_icao);
+    procedure_type.append(other.procedure_type);
+    route_type.append(other.route_type);
+    procedure_ident.append(other.procedure_ident);
+    transition_ident.append(other.transition_ident);
+    append_values(sequence, other.sequence);
+    fix_ident.append(other.fix_ident);
+    fix_region.append(other.fix_region);
+    description_code.append(other.description_code);
+    turn_direction.append(other.turn_direction);
+    path_terminator.append(other.path_terminator);
+    recommended_navaid.append(other.recommended_navaid);
+}
+
+void ParsedNavData::append(const ParsedNavData& other) {
+    navaids.append(other.navaids);
+    fixes.append(other.fixes);
+    airway_segments.append(other.airway_segments);
+    procedure_legs.append(other.procedure_legs);
+}
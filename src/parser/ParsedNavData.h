@@ -0,0 +1,126 @@
+#pragma once
+#include "Columns.h"
+#include "ParseArena.h"
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+
+/*
+    Columnar form of the records parsed from the earth_nav.dat, earth_fix.dat and earth_awy.dat files and the per-airport
+    CIFP files, laid out like ParsedAptData (see ParsedAptData.h). These files hold independent single-line records, so
+    a batch is simply the next run of records in file order (of one file, or of several small CIFP files).
+*/
+
+struct NavaidColumns {
+    explicit NavaidColumns(std::pmr::memory_resource* resource)
+        : row_code(resource), navaid_type(resource), latitude(resource), longitude(resource), elevation(resource),
+          frequency(resource), range(resource), bearing(resource), glideslope_angle(resource), ident(resource),
+          airport_icao(resource), icao_region(resource), name(resource) {}
+
+    std::pmr::vector<int> row_code;
+    StringColumn navaid_type;               // 'NDB', 'VOR', 'ILS', 'LOC', 'GS', 'OM', 'MM', 'IM', 'DME', ...
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    std::pmr::vector<int> elevation;
+    std::pmr::vector<int> frequency;
+    std::pmr::vector<int> range;
+    std::pmr::vector<double> bearing;       // VOR slaved variation, LOC/GS/marker bearing or DME bias, per row code
+    Column<double> glideslope_angle;        // Only set for glideslopes (row code 6)
+    StringColumn ident;
+    StringColumn airport_icao;              // Null for enroute navaids ('ENRT')
+    StringColumn icao_region;
+    StringColumn name;
+
+    size_t size() const { return row_code.size(); }
+    void append(const NavaidColumns& other);
+};
+
+struct FixColumns {
+    explicit FixColumns(std::pmr::memory_resource* resource)
+        : latitude(resource), longitude(resource), ident(resource), airport_icao(resource), icao_region(resource),
+          waypoint_type(resource) {}
+
+    std::pmr::vector<double> latitude;
+    std::pmr::vector<double> longitude;
+    StringColumn ident;
+    StringColumn airport_icao;              // Null for enroute fixes ('ENRT')
+    StringColumn icao_region;
+    Column<int> waypoint_type;              // ARINC 424 waypoint type, packed as in the file (optional there)
+
+    size_t size() const { return ident.size(); }
+    void append(const FixColumns& other);
+};
+
+// One row per airway a segment belongs to (the file joins the names of a shared segment with '-')
+struct AirwaySegmentColumns {
+    explicit AirwaySegmentColumns(std::pmr::memory_resource* resource)
+        : airway_name(resource), from_ident(resource), from_region(resource), from_type(resource), to_ident(resource),
+          to_region(resource), to_type(resource), direction(resource), airway_level(resource), base_fl(resource),
+          top_fl(resource) {}
+
+    StringColumn airway_name;
+    StringColumn from_ident;
+    StringColumn from_region;
+    std::pmr::vector<int> from_type;        // 11 = fix, 2 = NDB, 3 = VHF navaid
+    StringColumn to_ident;
+    StringColumn to_region;
+    std::pmr::vector<int> to_type;
+    StringColumn direction;                 // 'N' both ways, 'F' from -> to only, 'B' to -> from only
+    std::pmr::vector<int> airway_level;     // 1 = low, 2 = high
+    std::pmr::vector<int> base_fl;
+    std::pmr::vector<int> top_fl;
+
+    size_t size() const { return airway_name.size(); }
+    void append(const AirwaySegmentColumns& other);
+};
+
+// One row per leg of a SID, STAR or approach, from the CIFP file of an airport
+struct ProcedureLegColumns {
+    explicit ProcedureLegColumns(std::pmr::memory_resource* resource)
+        : airport_icao(resource), procedure_type(resource), route_type(resource), procedure_ident(resource),
+          transition_ident(resource), sequence(resource), fix_ident(resource), fix_region(resource),
+          description_code(resource), turn_direction(resource), path_terminator(resource), recommended_navaid(resource) {}
+
+    StringColumn airport_icao;              // From the file name (CIFP/KJFK.dat)
+    StringColumn procedure_type;            // 'SID', 'STAR', 'APPCH'
+    StringColumn route_type;                // ARINC 424 route type of the procedure type
+    StringColumn procedure_ident;
+    StringColumn transition_ident;          // Null for the common route
+    std::pmr::vector<int> sequence;
+    StringColumn fix_ident;                 // Null for legs that do not end at a fix (e.g. heading to an altitude)
+    StringColumn fix_region;
+    StringColumn description_code;
+    StringColumn turn_direction;
+    StringColumn path_terminator;           // ARINC 424 leg type: 'IF', 'TF', 'CF', 'VA', ...
+    StringColumn recommended_navaid;
+
+    size_t size() const { return sequence.size(); }
+    void append(const ProcedureLegColumns& other);
+};
+
+// Container for parsed data from a nav .dat file: a whole file, or a run of records when parsed in streaming mode.
+// Only the columns of the file's record type are filled.
+struct ParsedNavData {
+    // Without an arena the batch uses the default memory resource
+    ParsedNavData() : ParsedNavData(nullptr) {}
+    explicit ParsedNavData(std::shared_ptr<ParseArena> parse_arena)
+        : arena(std::move(parse_arena)), navaids(resource()), fixes(resource()), airway_segments(resource()),
+          procedure_legs(resource()) {}
+
+    ParsedNavData(ParsedNavData&&) = default;
+    ParsedNavData& operator=(ParsedNavData&&) = delete;     // Would copy element-wise into the old arena
+
+    std::shared_ptr<ParseArena> arena;      // Declared first so it outlives the columns that allocate from it
+    NavaidColumns navaids;
+    FixColumns fixes;
+    AirwaySegmentColumns airway_segments;
+    ProcedureLegColumns procedure_legs;
+
+    bool empty() const { return size() == 0; }
+    size_t size() const { return navaids.size() + fixes.size() + airway_segments.size() + procedure_legs.size(); }
+
+    void append(const ParsedNavData& other);
+
+    std::pmr::memory_resource* resource() const { return arena ? arena->resource() : std::pmr::get_default_resource(); }
+};
@@ -0,0 +1,233 @@
+#include "SceneryScanner.h"
+#include "DecompressingReader.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+namespace {
+    constexpr const char* MANIFEST_HEADER = "NavDataManager scan manifest 1";
+
+    int64_t modified_time(const fs::path& path, std::error_code& ec) {
+        return static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    }
+
+    // The manifest is written in UTF-8 so that it reads back the same on every platform, as is scenery_packs.ini
+    fs::path utf8_path(const std::string& utf8) {
+        return fs::u8path(utf8);
+    }
+
+    std::string relative_utf8(const fs::path& path, const fs::path& base) {
+        return path.lexically_relative(base).generic_u8string();
+    }
+
+    // Packages are keyed by their full path, scenery_packs.ini can list packages outside Custom Scenery
+    std::string package_key(const fs::path& package_dir) {
+        return fs::absolute(package_dir).lexically_normal().generic_u8string();
+    }
+
+    // A random suffix per write, two processes scanning the same installation never share a temporary file
+    std::string temporary_suffix() {
+        std::random_device random;
+        std::ostringstream suffix;
+        suffix << ".tmp" << std::hex << std::setfill('0') << std::setw(8) << random() << std::setw(8) << random();
+        return suffix.str();
+    }
+}
+
+bool is_apt_dat_file(const fs::path& file) {
+    if (file.filename() == "apt.dat") return true;
+    Compression compression = DecompressingReader::compression_of(file);
+    return file.stem() == "apt.dat" && compression != Compression::None && DecompressingReader::is_supported(compression);
+}
+
+// Lines look like "SCENERY_PACK Custom Scenery/KSEA Demo Area/", with the path relative to the X-Plane root or
+// absolute. Header lines and anything unknown are skipped.
+std::optional<std::vector<SceneryPack>> read_scenery_packs(const fs::path& custom_scenery) {
+    std::ifstream input(custom_scenery / "scenery_packs.ini", std::ios::binary);
+    if (!input) return std::nullopt;
+
+    std::vector<SceneryPack> packs;
+    std::string line;
+    while (std::getline(input, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        SceneryPack pack;
+        size_t path_start;
+        if (line.rfind("SCENERY_PACK_DISABLED ", 0) == 0) {
+            pack.enabled = false;
+            path_start = std::strlen("SCENERY_PACK_DISABLED ");
+        } else if (line.rfind("SCENERY_PACK ", 0) == 0) {
+            path_start = std::strlen("SCENERY_PACK ");
+        } else {
+            continue;
+        }
+        std::string path = line.substr(path_start);
+        while (!path.empty() && (path.back() == '/' || path.back() == '\\')) path.pop_back();
+        if (path.empty()) continue;
+        if (path != "*GLOBAL_AIRPORTS*") {
+            pack.directory = (custom_scenery.parent_path() / utf8_path(path)).lexically_normal();
+        }
+        packs.push_back(std::move(pack));
+    }
+    return packs;
+}
+
+SceneryScanner::SceneryScanner(fs::path custom_scenery, fs::path manifest_path, std::vector<std::string> exclusion_patterns)
+    : m_custom_scenery(std::move(custom_scenery)), m_manifest_path(std::move(manifest_path)),
+      m_exclusion_patterns(std::move(exclusion_patterns)) {}
+
+bool SceneryScanner::is_excluded(const fs::path& directory) const {
+    std::string dir_name = directory.filename().string();
+    std::transform(dir_name.begin(), dir_name.end(), dir_name.begin(), [](unsigned char c){return std::tolower(c);});
+    for (const auto& pattern : m_exclusion_patterns) {
+        if (dir_name.find(pattern) != std::string::npos) return true;
+    }
+    return false;
+}
+
+PackageScan SceneryScanner::walk_package(const fs::path& package_dir) const {
+    PackageScan scan;
+    std::error_code ec;
+    int64_t package_time = modified_time(package_dir, ec);
+    if (ec) throw fs::filesystem_error("Cannot read scenery package", package_dir, ec);
+    scan.directories.emplace_back(".", package_time);
+
+    auto iterator = fs::recursive_directory_iterator(package_dir);
+    for (const auto& entry : iterator) {
+        if (entry.is_directory()) {
+            if (is_excluded(entry.path())) {
+                iterator.disable_recursion_pending();
+                continue;
+            }
+            // A directory that vanishes mid-walk gets no mtime, so the next scan walks the package again
+            int64_t directory_time = modified_time(entry.path(), ec);
+            scan.directories.emplace_back(relative_utf8(entry.path(), package_dir), ec ? -1 : directory_time);
+        } else if (entry.is_regular_file() && is_apt_dat_file(entry.path())) {
+            scan.apt_files.push_back(relative_utf8(entry.path(), package_dir));
+        }
+    }
+    return scan;
+}
+
+std::vector<fs::path> SceneryScanner::list_packages() const {
+    std::vector<fs::path> package_dirs;
+    for (const auto& entry : fs::directory_iterator(m_custom_scenery)) {
+        if (entry.is_directory() && !is_excluded(entry.path())) {
+            package_dirs.push_back(entry.path());
+        }
+    }
+    std::sort(package_dirs.begin(), package_dirs.end());
+    return package_dirs;
+}
+
+SceneryScanResult SceneryScanner::scan(const std::vector<fs::path>& package_dirs, unsigned thread_count) const {
+    std::map<std::string, PackageScan> previous = load_manifest();
+
+    // Checking a cached package costs one stat per directory, a walk lists every directory, so both run on the pool
+    ThreadPool pool(static_cast<unsigned>(std::min<size_t>(thread_count, package_dirs.size())));
+    std::vector<std::future<PackageScan>> scans;
+    scans.reserve(package_dirs.size());
+    for (const fs::path& package_dir : package_dirs) {
+        auto cached = previous.find(package_key(package_dir));
+        const PackageScan* cached_scan = cached == previous.end() ? nullptr : &cached->second;
+        scans.push_back(pool.submit([this, package_dir, cached_scan] {
+            if (cached_scan) {
+                bool unchanged = std::all_of(cached_scan->directories.begin(), cached_scan->directories.end(), [&](const auto& directory) {
+                    std::error_code ec;
+                    int64_t time = modified_time(package_dir / utf8_path(directory.first), ec);
+                    return !ec && time == directory.second;
+                });
+                if (unchanged) {
+                    PackageScan scan = *cached_scan;
+                    scan.from_manifest = true;
+                    return scan;
+                }
+            }
+            return walk_package(package_dir);
+        }));
+    }
+
+    SceneryScanResult result;
+    result.packages.reserve(package_dirs.size());
+    for (auto& scan : scans) {
+        result.packages.push_back(scan.get());
+        (result.packages.back().from_manifest ? result.packages_cached : result.packages_walked)++;
+    }
+
+    if (!m_manifest_path.empty()) {
+        save_manifest(package_dirs, result.packages);
+    }
+    return result;
+}
+
+// Line based: the Custom Scenery path the manifest belongs to, then per package a "P" line followed by its "D"
+// (directory mtime) and "A" (apt.dat) lines. Anything unexpected discards the whole manifest.
+std::map<std::string, PackageScan> SceneryScanner::load_manifest() const {
+    std::map<std::string, PackageScan> packages;
+    if (m_manifest_path.empty()) return packages;
+    std::ifstream input(m_manifest_path, std::ios::binary);
+    std::string line;
+    if (!input || !std::getline(input, line) || line != MANIFEST_HEADER) return packages;
+    if (!std::getline(input, line) || line != package_key(m_custom_scenery)) return packages;
+
+    PackageScan* current = nullptr;
+    while (std::getline(input, line)) {
+        if (line.size() < 2 || line[1] != '\t') return {};
+        std::string value = line.substr(2);
+        if (line[0] == 'P') {
+            current = &packages[value];
+        } else if (current == nullptr) {
+            return {};
+        } else if (line[0] == 'D') {
+            size_t tab = value.find('\t');
+            if (tab == std::string::npos) return {};
+            try {
+                current->directories.emplace_back(value.substr(tab + 1), std::stoll(value.substr(0, tab)));
+            } catch (const std::exception&) {
+                return {};
+            }
+        } else if (line[0] == 'A') {
+            current->apt_files.push_back(value);
+        } else {
+            return {};
+        }
+    }
+    return packages;
+}
+
+// Written to a file of its own next to the manifest and renamed over it, so that a scan running at the same time never
+// reads half a file
+void SceneryScanner::save_manifest(const std::vector<fs::path>& package_dirs, const std::vector<PackageScan>& packages) const {
+    std::error_code ec;
+    if (m_manifest_path.has_parent_path()) fs::create_directories(m_manifest_path.parent_path(), ec);
+    fs::path temporary = m_manifest_path;
+    temporary += temporary_suffix();
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        if (!output) return;
+        output << MANIFEST_HEADER << '\n' << package_key(m_custom_scenery) << '\n';
+        for (size_t i = 0; i < packages.size(); ++i) {
+            const PackageScan& scan = packages[i];
+            output << "P\t" << package_key(package_dirs[i]) << '\n';
+            for (const auto& [directory, time] : scan.directories) {
+                output << "D\t" << time << '\t' << directory << '\n';
+            }
+            for (const auto& apt_file : scan.apt_files) {
+                output << "A\t" << apt_file << '\n';
+            }
+        }
+        if (!output.flush()) {
+            output.close();
+            fs::remove(temporary, ec);
+            return;
+        }
+    }
+    fs::rename(temporary, m_manifest_path, ec);
+    if (ec) fs::remove(temporary, ec);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+namespace fs = std::filesystem;
+
+/*
+    Finds the apt.dat files of the Custom Scenery packages. Each package is walked by a task of its own,
+    and what a walk found is kept in a scan manifest together with the modification time of every directory it
+    visited. Adding, removing or renaming an entry changes the mtime of the directory holding it, so a package whose
+    directories all still have their recorded mtimes holds the same files as before and is not walked again. Editing
+    a file in place does not change any directory, which is fine: the ingest compares file contents by itself.
+*/
+
+// apt.dat, or an apt.dat.gz / apt.dat.zst this build can decompress
+bool is_apt_dat_file(const fs::path& file);
+
+struct PackageScan {
+    std::vector<std::pair<std::string, int64_t>> directories;   // Relative to the package ("." for the package itself), with their mtimes
+    std::vector<std::string> apt_files;                         // Relative to the package, in walk order
+    bool from_manifest = false;                                 // Taken over from the manifest, not walked
+};
+
+struct SceneryScanResult {
+    std::vector<PackageScan> packages;                          // In the order of the package directories scanned
+    size_t packages_walked = 0;
+    size_t packages_cached = 0;
+};
+
+// One SCENERY_PACK or SCENERY_PACK_DISABLED line of Custom Scenery/scenery_packs.ini
+struct SceneryPack {
+    fs::path directory;             // Resolved against the X-Plane root, empty for the *GLOBAL_AIRPORTS* line
+    bool enabled = true;
+};
+
+// The packs of scenery_packs.ini in file order, which is X-Plane's priority order (the first one wins an airport).
+// std::nullopt if there is no such file, X-Plane writes it on its first start.
+std::optional<std::vector<SceneryPack>> read_scenery_packs(const fs::path& custom_scenery);
+
+class SceneryScanner {
+    public:
+        /**
+         * @param custom_scenery Custom Scenery directory.
+         * @param manifest_path Scan manifest to read and update, empty to walk every package on each scan.
+         * @param exclusion_patterns Lowercase name fragments of directories that are not walked (ortho, libraries...).
+         * They apply to the directories inside a package, and to list_packages().
+         */
+        SceneryScanner(fs::path custom_scenery, fs::path manifest_path, std::vector<std::string> exclusion_patterns);
+
+        // The package directories of Custom Scenery whose names match no exclusion pattern, in name order
+        std::vector<fs::path> list_packages() const;
+
+        /**
+         * @brief Walks the packages that changed since the manifest was written, with up to thread_count at a time,
+         * and writes the manifest again with the packages of this scan.
+         * @throws fs::filesystem_error if a package cannot be walked. Failing to read or write the manifest only
+         * makes the next scan walk everything.
+         */
+        SceneryScanResult scan(const std::vector<fs::path>& package_dirs, unsigned thread_count) const;
+
+        bool is_excluded(const fs::path& directory) const;
+
+    private:
+        fs::path m_custom_scenery;
+        fs::path m_manifest_path;
+        std::vector<std::string> m_exclusion_patterns;
+
+        PackageScan walk_package(const fs::path& package_dir) const;
+        std::map<std::string, PackageScan> load_manifest() const;
+        void save_manifest(const std::vector<fs::path>& package_dirs, const std::vector<PackageScan>& packages) const;
+};
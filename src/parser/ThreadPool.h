@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+/*
+    Minimal fixed-size worker pool. Tasks run in submission (FIFO) order and results come back through std::future,
+    which also carries any exception thrown by the task. The destructor finishes the queued tasks before joining.
+*/
+
+class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned thread_count) {
+            if (thread_count == 0) thread_count = 1;
+            m_workers.reserve(thread_count);
+            for (unsigned i = 0; i < thread_count; ++i) {
+                m_workers.emplace_back([this] { worker_loop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_condition.notify_all();
+            for (auto& worker : m_workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template <typename F>
+        auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+            // std::function needs a copyable target, so the packaged_task lives behind a shared_ptr
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            std::future<Result> result = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace_back([packaged] { (*packaged)(); });
+            }
+            m_condition.notify_one();
+            return result;
+        }
+
+        unsigned size() const { return static_cast<unsigned>(m_workers.size()); }
+
+        // Resolves a requested thread count, where 0 means "one per hardware thread"
+        static unsigned resolve_thread_count(unsigned requested) {
+            if (requested != 0) return requested;
+            unsigned hardware = std::thread::hardware_concurrency();
+            return hardware == 0 ? 1 : hardware;
+        }
+
+    private:
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopping = false;
+
+        void worker_loop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                    if (m_tasks.empty()) return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+};
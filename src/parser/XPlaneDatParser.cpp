@@ -1,452 +1,1126 @@
 #include "XPlaneDatParser.h"
+#include "FieldDecoder.h"
+#include "MappedFile.h"
 #include <iostream>
 #include <cctype>
 #include <algorithm>
-#include <set>
+#include <optional>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <cmath>
+#include <utility>
 
 namespace fs = std::filesystem;
 
-XPlaneDatParser::XPlaneDatParser(bool logging) : m_logging_enabled(logging) {}
+namespace {
+    // Files smaller than this are parsed serially, splitting them is not worth the overhead
+    constexpr uintmax_t PARALLEL_PARSE_MIN_BYTES = 16 * 1024 * 1024;
+    constexpr size_t PARALLEL_PARSE_CHUNK_BYTES = 4 * 1024 * 1024;
+    // Input covered by one parse arena. Matches the chunk size, so each chunk of a parallel parse gets its own arena.
+    constexpr uintmax_t PARSE_UNIT_BYTES = PARALLEL_PARSE_CHUNK_BYTES;
+    // First block of a parse arena. Small files rarely need more; large units grow geometrically from here.
+    constexpr size_t PARSE_ARENA_INITIAL_BYTES = 256 * 1024;
+    // Parsed chunks are held until the sink has taken them, so only a few per thread may be in flight
+    constexpr unsigned PARALLEL_PARSE_CHUNKS_IN_FLIGHT_PER_THREAD = 2;
+
+    // A record a lenient parse leaves out (see XPlaneDatParser::set_lenient), carrying the reason it failed
+    class SkippedRecord : public std::runtime_error {
+        public:
+            using std::runtime_error::runtime_error;
+    };
+
+    // Nav .dat records handed to the sink at a time. Navaids, fixes and airways have no airport to group by.
+    constexpr size_t NAV_BATCH_RECORDS = 4096;
+
+    // Splits the body of a CIFP record (the text after "SID:" etc.) at its commas. The terminating ';' and the padding
+    // at the end of each field are dropped, so an absent field is an empty view.
+    void split_cifp_fields(std::string_view record, std::vector<std::string_view>& fields) {
+        fields.clear();
+        while (!record.empty() && (record.back() == ';' || std::isspace(static_cast<unsigned char>(record.back())))) {
+            record.remove_suffix(1);
+        }
+        size_t field_start = 0;
+        while (true) {
+            size_t comma = record.find(',', field_start);
+            std::string_view field = record.substr(field_start, comma == std::string_view::npos ? std::string_view::npos : comma - field_start);
+            while (!field.empty() && field.back() == ' ') field.remove_suffix(1);
+            fields.push_back(field);
+            if (comma == std::string_view::npos) break;
+            field_start = comma + 1;
+        }
+    }
+
+    void push_text_or_null(StringColumn& column, std::string_view value) {
+        if (value.empty()) {
+            column.push_null();
+        } else {
+            column.push_back(value);
+        }
+    }
+
+    // Row code of a line (its leading numeric token), or -1 if the first token is not numeric
+    int row_code_of(std::string_view line) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos || !std::isdigit(static_cast<unsigned char>(line[start]))) return -1;
+        int row_code = 0;
+        for (size_t i = start; i < line.size() && std::isdigit(static_cast<unsigned char>(line[i])) && row_code < 100000; ++i) {
+            row_code = row_code * 10 + (line[i] - '0');
+        }
+        return row_code;
+    }
+
+    bool is_airport_header(std::string_view data, size_t line_start) {
+        std::string_view line = data.substr(line_start, 3);
+        for (std::string_view code : {"1", "16", "17"}) {
+            if (line.size() > code.size() && line.substr(0, code.size()) == code &&
+                (line[code.size()] == ' ' || line[code.size()] == '\t')) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A header may only start a chunk if the record before it has already closed the previous airport's metadata
+    // block. If the previous non-blank line is still airport metadata (1/16/17/1302), the serial parser would fold the
+    // two headers together, so splitting there would change the output.
+    bool previous_record_closes_airport(std::string_view data, size_t line_start) {
+        size_t line_end = line_start - 1;   // The '\n' that terminates the previous line
+        while (true) {
+            size_t newline = (line_end == 0) ? std::string_view::npos : data.rfind('\n', line_end - 1);
+            size_t previous_start = (newline == std::string_view::npos) ? 0 : newline + 1;
+            std::string_view line = data.substr(previous_start, line_end - previous_start);
+            if (line.find_first_not_of(" \t") != std::string_view::npos) {
+                int row_code = row_code_of(line);
+                return row_code != 1 && row_code != 16 && row_code != 17 && row_code != 1302;
+            }
+            if (previous_start == 0) return true;
+            line_end = previous_start - 1;
+        }
+    }
+
+    // Offset of the first line at or after 'from' that can start a chunk, or npos
+    size_t find_airport_boundary(std::string_view data, size_t from) {
+        size_t newline = data.find('\n', from);
+        while (newline != std::string_view::npos && newline + 1 < data.size()) {
+            size_t line_start = newline + 1;
+            if (is_airport_header(data, line_start) && previous_record_closes_airport(data, line_start)) {
+                return line_start;
+            }
+            newline = data.find('\n', line_start);
+        }
+        return std::string_view::npos;
+    }
+
+    std::vector<std::string_view> split_at_airport_headers(std::string_view data, size_t chunk_count) {
+        std::vector<std::string_view> chunks;
+        size_t chunk_start = 0;
+        for (size_t i = 1; i < chunk_count; ++i) {
+            size_t target = data.size() / chunk_count * i;
+            if (target <= chunk_start) continue;
+            size_t boundary = find_airport_boundary(data, target);
+            if (boundary == std::string_view::npos) break;
+            chunks.push_back(data.substr(chunk_start, boundary - chunk_start));
+            chunk_start = boundary;
+        }
+        chunks.push_back(data.substr(chunk_start));
+        return chunks;
+    }
+
+    // Tokens from 'first' to the end of the line, separated by single spaces (names may contain spaces)
+    std::string join_tokens(const std::vector<std::string_view>& tokens, size_t first) {
+        std::string joined;
+        for (size_t i = first; i < tokens.size(); ++i) {
+            if (i > first) joined += ' ';
+            joined += tokens[i];
+        }
+        return joined;
+    }
+
+    // Line types of the taxiway features we keep (check apt.dat specification for more details)
+    // NOTE: We are trying to capture centerlines, centerline lights, hold-short lines, runway lead-off lights
+    // We are NOT trying to capture edge lighting or boundary features, as this will not add value (at the moment) to our Navigational data.
+    bool is_taxiway_line_code(int code) {
+        switch (code) {
+            case 1: case 4: case 5: case 6: case 7:
+            case 51: case 54: case 55: case 56: case 57:
+            case 101: case 103: case 104: case 105: case 107: case 108:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Navaid type stored for an earth_nav.dat row code, or nullptr if the row is not a navaid (file header, version)
+    const char* navaid_type_of(int row_code) {
+        switch (row_code) {
+            case 2: return "NDB";
+            case 3: return "VOR";
+            case 4: return "ILS";       // Localizer of a full ILS
+            case 5: return "LOC";       // Stand-alone localizer (LOC, LDA, SDF)
+            case 6: return "GS";
+            case 7: return "OM";
+            case 8: return "MM";
+            case 9: return "IM";
+            case 12:                    // Paired with a VOR or localizer
+            case 13: return "DME";      // Stand-alone, or paired with an NDB
+            case 14: return "FPAP";
+            case 15: return "GLS";
+            case 16: return "LTP";
+            default: return nullptr;
+        }
+    }
+}
+
+XPlaneDatParser::XPlaneDatParser(bool logging, unsigned parse_threads)
+    : m_logging_enabled(logging), m_parse_threads(ThreadPool::resolve_thread_count(parse_threads)),
+      m_arena_stats(std::make_shared<ArenaStats>()) {}
+
+ArenaUsage XPlaneDatParser::arena_usage() const {
+    return m_arena_stats->usage();
+}
+
+std::shared_ptr<ParseArena> XPlaneDatParser::make_parse_arena() const {
+    return std::make_shared<ParseArena>(m_arena_stats, PARSE_ARENA_INITIAL_BYTES);
+}
+
+std::vector<IngestDiagnostic> XPlaneDatParser::take_diagnostics() {
+    std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+    return std::exchange(m_diagnostics, {});
+}
+
+void XPlaneDatParser::add_diagnostic(const fs::path& file, int line, int row_code, const std::string& reason) const {
+    std::lock_guard<std::mutex> lock(m_diagnostics_mutex);
+    m_diagnostics.push_back({file.string(), line, row_code, reason});
+}
 
 ParsedAptData XPlaneDatParser::parse_airport_dat(const fs::path& file) {
-    ParsedAptData parsed_data;
-    LookaheadLineReader reader(file, m_logging_enabled);
-    int row_code = -100;
-    
-    while (reader.get_next_line()) {
-        // Tokenize the current line
-        auto tokens = reader.get_line_tokens();
-        if (tokens.empty()) continue;
+    std::optional<ParsedAptData> parsed_data;
+    parse_airport_dat(file, [&parsed_data](ParsedAptData&& batch) {
+        if (!parsed_data) {
+            parsed_data.emplace(std::move(batch));
+        } else {
+            parsed_data->append(batch);
+        }
+    });
+    return parsed_data ? std::move(*parsed_data) : ParsedAptData();
+}
+
+void XPlaneDatParser::parse_airport_dat(const fs::path& file, const AptDataSink& sink) {
+    std::error_code ec;
+    uintmax_t file_size = fs::file_size(file, ec);
+    bool is_compressed = DecompressingReader::compression_of(file) != Compression::None;
+    if (m_parse_threads > 1 && !ec && !is_compressed && file_size >= PARALLEL_PARSE_MIN_BYTES) {
+        MappedFile mapping;
+        if (mapping.open(file)) {
+            parse_airport_dat_parallel(file, mapping.data(), sink);
+            return;
+        }
+    }
+
+    LookaheadLineReader reader(file);
+    parse_records(reader, sink, file);
+}
+
+bool XPlaneDatParser::parse_airport_record(const fs::path& file, const AptRecordSpan& span, const AptDataSink& sink) const {
+    if (DecompressingReader::compression_of(file) != Compression::None) return false;
+    MappedFile mapping;
+    if (!mapping.open(file)) return false;
+    std::string_view contents = mapping.data();
+    if (span.offset >= contents.size() || (span.offset > 0 && contents[span.offset - 1] != '\n') ||
+        !is_airport_header(contents, span.offset)) {
+        return false;
+    }
+
+    // The record may have grown or shrunk since it was indexed, so it runs up to the next airport header rather than
+    // for the indexed length. Only the pages from the record on are touched.
+    size_t record_end = find_airport_boundary(contents, span.offset);
+    std::string_view record = contents.substr(span.offset, record_end == std::string_view::npos ? std::string_view::npos : record_end - span.offset);
+    LookaheadLineReader reader(record, file, span.first_line - 1);
+    parse_records(reader, sink, file, span.offset);
+    return true;
+}
+
+ParsedNavData XPlaneDatParser::parse_nav_dat(const fs::path& file) {
+    ParsedNavData parsed_data;
+    parse_nav_dat(file, [&parsed_data](ParsedNavData&& batch) { parsed_data.append(batch); });
+    return parsed_data;
+}
+
+void XPlaneDatParser::parse_nav_dat(const fs::path& file, const NavDataSink& sink) {
+    parse_nav_records(file, sink, &XPlaneDatParser::add_navaid);
+}
+
+ParsedNavData XPlaneDatParser::parse_fix_dat(const fs::path& file) {
+    ParsedNavData parsed_data;
+    parse_fix_dat(file, [&parsed_data](ParsedNavData&& batch) { parsed_data.append(batch); });
+    return parsed_data;
+}
+
+void XPlaneDatParser::parse_fix_dat(const fs::path& file, const NavDataSink& sink) {
+    parse_nav_records(file, sink, &XPlaneDatParser::add_fix);
+}
+
+ParsedNavData XPlaneDatParser::parse_awy_dat(const fs::path& file) {
+    ParsedNavData parsed_data;
+    parse_awy_dat(file, [&parsed_data](ParsedNavData&& batch) { parsed_data.append(batch); });
+    return parsed_data;
+}
+
+void XPlaneDatParser::parse_awy_dat(const fs::path& file, const NavDataSink& sink) {
+    parse_nav_records(file, sink, &XPlaneDatParser::add_airway_segment);
+}
+
+ParsedNavData XPlaneDatParser::parse_cifp_dat(const fs::path& file) const {
+    ParsedNavData parsed_data;
+    parse_cifp_files({file}, [&parsed_data](ParsedNavData&& batch) { parsed_data.append(batch); });
+    return parsed_data;
+}
+
+void XPlaneDatParser::parse_cifp_files(const std::vector<fs::path>& files, const NavDataSink& sink) const {
+    std::optional<ParsedNavData> batch(std::in_place, make_parse_arena());
+    for (const auto& file : files) {
         try {
-            // Check row code to determine what to do with the current line's data
-            row_code = reader.get_row_code();
-
-            switch (row_code) {
-                case 1:
-                case 16:
-                case 17:
-                case 1302:
-                    reader.put_line_back();
-                    process_airport_meta(reader, parsed_data);
-                    break;
-
-                // Runway case
-                case 100:
-                    reader.put_line_back();
-                    process_runway(reader, parsed_data);
-                    break;
-
-                // Taxiway Network Node
-                case 1200:
-                case 1201:
-                    reader.put_line_back();
-                    process_taxiway_node(reader, parsed_data);
-                    break;
-
-                // Taxiway Network Edge
-                case 1202:
-                    reader.put_line_back();
-                    process_taxiway_edge(reader, parsed_data);
-                    break;
-
-                // Linear Feature Cases
-                case 120:
-                    reader.put_line_back();
-                    process_linear_feature(reader, parsed_data);
-                    break;
-            }
+            parse_cifp_records(file, *batch);
         } catch (const std::exception& e) {
-            std::cerr << "\nError parsing " << file.string() << ": " << e.what() << std::endl;
-            throw;
+            // Only a file that cannot be read gets here in lenient mode. Its legs parsed so far are kept; the writer
+            // has already deleted the airport's old procedures either way.
+            if (!m_lenient) throw;
+            add_diagnostic(file, 0, -1, e.what());
+        }
+        if (batch->size() >= NAV_BATCH_RECORDS) {
+            sink(std::move(*batch));
+            batch.emplace(make_parse_arena());
         }
     }
-    return parsed_data;
+    if (!batch->empty()) {
+        sink(std::move(*batch));
+    }
 }
 
-void XPlaneDatParser::process_airport_meta(LookaheadLineReader& reader, ParsedAptData& data) {
-    AirportMeta airport_meta;
-    bool is_valid_row_code = true;
-    
-    while (reader.get_next_line()) {
-        auto tokens = reader.get_line_tokens();
-        int row_code = reader.get_row_code();
-        if (tokens.empty()) continue;
-        if (!is_valid_row_code) {
-            try {
-                // Update the context for foreign keys
-                reset_airport_context(airport_meta.icao.value());
+// Airport records (a 1/16/17 header through the next header) are independent of each other, so a large file is
+// split into chunks that each begin on an airport header. Every chunk is parsed with its own AptParseContext (the
+// per-airport context and feature_sequence numbering restart at each header anyway) and its airport batches are
+// handed to the sink in file order, which yields exactly what a serial parse would have produced. Only a window of
+// chunks is parsed ahead of the sink, so memory stays bounded by a few chunks rather than the whole file.
+void XPlaneDatParser::parse_airport_dat_parallel(const fs::path& file, std::string_view contents, const AptDataSink& sink) {
+    auto begin_time = std::chrono::steady_clock::now();
+    std::call_once(m_chunk_pool_created, [this] { m_chunk_pool = std::make_unique<ThreadPool>(m_parse_threads); });
 
-                data.airports.push_back(std::move(airport_meta));
-            } catch (...) { throw; }
-            reader.put_line_back();
-            break;
+    size_t chunk_count = std::max<size_t>(1, contents.size() / PARALLEL_PARSE_CHUNK_BYTES);
+    std::vector<std::string_view> chunks = split_at_airport_headers(contents, chunk_count);
+
+    // First pass: count the lines in each chunk so every chunk reader reports absolute line numbers
+    std::vector<std::future<int>> line_counts;
+    line_counts.reserve(chunks.size());
+    for (auto chunk : chunks) {
+        line_counts.push_back(m_chunk_pool->submit([chunk] {
+            return static_cast<int>(std::count(chunk.begin(), chunk.end(), '\n'));
+        }));
+    }
+    std::vector<int> lines_before(chunks.size(), 0);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        int chunk_lines = line_counts[i].get();
+        if (i + 1 < chunks.size()) lines_before[i + 1] = lines_before[i] + chunk_lines;
+    }
+
+    // Second pass: parse the chunks, keeping at most max_in_flight of them ahead of the sink
+    const size_t max_in_flight = static_cast<size_t>(m_parse_threads) * PARALLEL_PARSE_CHUNKS_IN_FLIGHT_PER_THREAD;
+    std::deque<std::future<std::vector<ParsedAptData>>> in_flight;
+    size_t next_chunk = 0;
+    auto submit_chunk = [&]() {
+        size_t i = next_chunk++;
+        uint64_t chunk_offset = static_cast<uint64_t>(chunks[i].data() - contents.data());
+        in_flight.push_back(m_chunk_pool->submit([this, &file, chunk = chunks[i], first_line = lines_before[i], chunk_offset] {
+            LookaheadLineReader reader(chunk, file, first_line);
+            std::vector<ParsedAptData> batches;
+            parse_records(reader, [&batches](ParsedAptData&& batch) { batches.push_back(std::move(batch)); }, file, chunk_offset);
+            return batches;
+        }));
+    };
+
+    // Deliver in file order. After an error nothing new is submitted, but every chunk already in flight is waited on
+    // before rethrowing, since they all read from the mapping.
+    std::exception_ptr first_error;
+    while (true) {
+        while (!first_error && next_chunk < chunks.size() && in_flight.size() < max_in_flight) {
+            submit_chunk();
         }
+        if (in_flight.empty()) break;
         try {
-            switch (row_code) {
-                case 1:
-                case 16:
-                case 17: {
-                    if (row_code == 1) airport_meta.type = std::string("Land");
-                    else if (row_code == 16) airport_meta.type = std::string("Seaplane");
-                    else if (row_code == 17) airport_meta.type = std::string("Heliport");
-
-                    // Check if there is a [H] or [S] token in the vector
-                    if (tokens.size() >= 6) {
-                        for (size_t i = 3; i < tokens.size(); ++i) {
-                            if (tokens[i] == "[H]" || tokens[i] == "[S]" || tokens[i] == "[X]") {
-                                // We found it, and now we can remove it from the vector
-                                tokens.erase(tokens.begin() + i);
-                                break;
-                            }
-                        }
-                    }
-                    airport_meta.elevation = std::stoi(std::string(tokens[1]));
-                    airport_meta.icao = std::string(tokens[4]);
+            std::vector<ParsedAptData> batches = in_flight.front().get();
+            if (!first_error) {
+                for (auto& batch : batches) {
+                    sink(std::move(batch));
+                }
+            }
+        } catch (...) {
+            if (!first_error) first_error = std::current_exception();
+        }
+        in_flight.pop_front();
+    }
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
 
-                    // We need to account for the usual case where an airport_name is multiple tokens
-                    std::string s_airport_name = "";
-                    for (size_t j = 5; j < tokens.size(); ++j) {
-                        s_airport_name += std::string(tokens[j]) + " ";
-                    }
+    if (m_logging_enabled) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin_time);
+        std::cout << "Parsed " << file.string() << " in " << chunks.size() << " chunks on " << m_chunk_pool->size()
+                  << " threads (" << elapsed.count() << " ms)" << std::endl;
+    }
+}
 
-                    // Strip whitespace from both ends
-                    if (!s_airport_name.empty()) {
-                        size_t start = s_airport_name.find_first_not_of(" \t\n\r\f\v");
-                        if (start != std::string::npos) {
-                            size_t end = s_airport_name.find_last_not_of(" \t\n\r\f\v");
-                            s_airport_name = s_airport_name.substr(start, end - start + 1);
-                        } else {
-                            s_airport_name.clear();
-                        }
-                    }
-                    
-                    airport_meta.airport_name = s_airport_name;
-                    break;
+// Records are collected per airport and the batch is handed to the sink when the next airport header starts, so only
+// one airport is held at a time. Records before the first header, if any, form a batch of their own.
+// Batches allocate from the arena of their parse unit. A new arena is started once the current one has seen
+// PARSE_UNIT_BYTES of input, and an arena is released when the last of its batches has been written.
+//
+// Every line is tokenized and classified once and then dispatched on the current AptParseState. A line the current
+// block does not take closes that block and is handled again, from the same tokens, in the Records state, where it is
+// either a single-line record or the start of the next block.
+void XPlaneDatParser::parse_records(LookaheadLineReader& reader, const AptDataSink& sink, const fs::path& file, uint64_t base_offset) const {
+    AptParseContext context;
+    std::shared_ptr<ParseArena> arena = make_parse_arena();
+    uintmax_t arena_start_bytes = 0;
+    std::optional<ParsedAptData> batch(std::in_place, arena);
+    uint64_t line_count = 0, reported_lines = 0, reported_bytes = 0;
+
+    // Progress counters are published once per airport rather than per line
+    auto report_progress = [&]() {
+        m_lines_parsed.fetch_add(line_count - reported_lines, std::memory_order_relaxed);
+        m_bytes_parsed.fetch_add(reader.get_source_bytes_processed() - reported_bytes, std::memory_order_relaxed);
+        reported_lines = line_count;
+        reported_bytes = reader.get_source_bytes_processed();
+    };
+
+    // Offset of the current line in the whole input, for the record spans (a chunk's reader counts from the chunk)
+    auto line_offset = [&]() { return base_offset + reader.get_bytes_processed() - reader.get_line().length() - 1; };
+
+    // The airport of the batch ends where the next header starts, or at the end of the input
+    auto flush_batch = [&](uint64_t record_end) {
+        report_progress();
+        if (batch->empty()) return;
+        for (AptRecordSpan& span : batch->airports.record) {
+            span.length = record_end - span.offset;
+        }
+        sink(std::move(*batch));
+        if (reader.get_bytes_processed() - arena_start_bytes >= PARSE_UNIT_BYTES) {
+            arena = make_parse_arena();
+            arena_start_bytes = reader.get_bytes_processed();
+        }
+        batch.emplace(arena);
+    };
+
+    bool skipping_airport = false;        // Lenient mode: dropping the rest of an airport after a bad record
+    try {
+        while (reader.get_next_line()) {
+            ++line_count;
+            auto& tokens = reader.get_line_tokens(context.line_tokens);
+            if (tokens.empty()) continue;
+            int row_code = reader.get_row_code();
+            if (skipping_airport) {
+                if (row_code != 1 && row_code != 16 && row_code != 17) continue;
+                skipping_airport = false;
+            }
+            FieldDecoder fields(tokens, reader.get_line_number());
+
+            // In lenient mode a failure becomes a SkippedRecord, handled below
+            auto handle_line = [&](AptParseState state) {
+                try {
+                    return (this->*STATE_HANDLERS[static_cast<size_t>(state)])(row_code, tokens, fields, context, *batch);
+                } catch (const std::exception& e) {
+                    if (m_lenient) throw SkippedRecord(e.what());
+                    std::ostringstream error_msg = write_parser_error(reader, tokens, e);
+                    throw std::runtime_error(error_msg.str());
                 }
-                case 1302: {
-                    std::string key = std::string(tokens[1]);
-                    std::string value;
-                    if (tokens.size() < 3) break;
-                    if (tokens.size() > 3) {
-                        for (size_t i = 2; i < tokens.size(); ++i) {
-                            value += std::string(tokens[i]);
-                            if (i < tokens.size() - 1) {
-                                value += " ";
-                            }
-                        }
-                    } else {
-                        value = std::string(tokens[2]);
-                    }
+            };
+            // The batch holds only the current airport, so dropping it drops exactly what was parsed of it
+            auto drop_airport = [&](const std::string& reason) {
+                add_diagnostic(file, reader.get_line_number(), row_code, reason);
+                batch.emplace(arena);
+                context.state = AptParseState::Records;
+                context.reset_airport_context("");
+            };
+            auto close_block = [&]() {
+                try {
+                    end_block(context, *batch, false);
+                } catch (const std::exception& e) {
+                    if (!m_lenient) throw;
+                    std::string reason = std::string("Airport block could not be closed: ") + e.what();
+                    // A header line goes on to open the next airport, any other line still belongs to the dropped one
+                    if (row_code != 1 && row_code != 16 && row_code != 17) throw SkippedRecord(reason);
+                    drop_airport(reason);
+                }
+            };
 
-                    if (key == "icao_code") {
-                        airport_meta.icao = value;
-                    } else if (key == "faa_code") {
-                        airport_meta.faa = value;
-                    } else if (key == "iata_code") {
-                        airport_meta.iata = value;
-                    } else if (key == "city") {
-                        airport_meta.city = value;
-                    } else if (key == "country") {
-                        airport_meta.country = value;
-                    } else if (key == "state") {
-                        airport_meta.state = value;
-                    } else if (key == "region_code") {
-                        airport_meta.region = value;
-                    } else if (key == "transition_alt") {
-                        airport_meta.transition_alt = value;
-                    } else if (key == "transition_level") {
-                        // We need to check for all kinds of incorrect strings here
-                        bool is_non_numeric = std::none_of(value.begin(), value.end(), [](unsigned char c) {
-                            return std::isdigit(c);
-                        });
-
-                        if (value.substr(0, 2) == "FL" || is_non_numeric) {
-                            airport_meta.transition_level = value;
-                        } else {
-                            // We need to convert all purely numerical instances to the form "FLxxx" or "FLxx"
-                            int numeric_value = std::stoi(value);
-                            numeric_value = static_cast<int>(numeric_value / 100);
-                            std::string converted_value = "FL" + std::to_string(numeric_value);
-                            airport_meta.transition_level = converted_value;
-                        }
-                    } else if (key == "datum_lat") {
-                        airport_meta.latitude = std::stod(value);
-                    } else if (key == "datum_lon") {
-                        airport_meta.longitude = std::stod(value);
-                    }
+            try {
+                if (handle_line(context.state)) continue;
+                if (context.state != AptParseState::Records) {
+                    close_block();
+                    if (handle_line(AptParseState::Records)) continue;
+                }
 
-                    // Ignore other keys
-                    break;
+                // The line opens a new block
+                if (row_code == 1 || row_code == 16 || row_code == 17) {
+                    flush_batch(line_offset());
+                }
+                begin_block(row_code, context, *batch);
+                if (context.state == AptParseState::AirportMeta) {
+                    batch->airports.record.back() = {line_offset(), 0, reader.get_line_number()};
                 }
-                default:
-                    is_valid_row_code = false;
-                    reader.put_line_back();
-                    break;
+                handle_line(context.state);
+            } catch (const SkippedRecord& e) {
+                drop_airport(e.what());
+                skipping_airport = true;
             }
-        } catch (const std::exception& e) { 
-            std::ostringstream error_msg = write_parser_error(reader, tokens, e);
-            throw std::runtime_error(error_msg.str());
         }
+        end_block(context, *batch, true);
+    } catch (const std::exception& e) {
+        std::cerr << "\nError parsing " << file.string() << ": " << e.what() << std::endl;
+        throw;
     }
+    flush_batch(base_offset + reader.get_bytes_processed());
 }
 
-void XPlaneDatParser::process_runway(LookaheadLineReader& reader, ParsedAptData& data) {
-    RunwayData runway_data;
-    bool is_valid_row_code = true;
+// Every record of the nav .dat files is a single line, so there is no block state. The I/A line and the version line
+// are skipped, a 99 line ends the data, and every other line goes to the handler of the file type (earth_fix.dat lines
+// have no row code, they start with the latitude). Batches and arenas work as in parse_records.
+void XPlaneDatParser::parse_nav_records(const fs::path& file, const NavDataSink& sink, NavLineHandler handler) const {
+    LookaheadLineReader reader(file);
+    std::vector<std::string_view> line_tokens;
+    std::shared_ptr<ParseArena> arena = make_parse_arena();
+    uintmax_t arena_start_bytes = 0;
+    std::optional<ParsedNavData> batch(std::in_place, arena);
+    uint64_t line_count = 0, reported_lines = 0, reported_bytes = 0;
 
-    while (reader.get_next_line()) {
-        auto tokens = reader.get_line_tokens();
-        int row_code = reader.get_row_code();
-        if (tokens.empty()) continue;
-        if (!is_valid_row_code) {
-            reader.put_line_back();
-            break;
+    auto flush_batch = [&]() {
+        m_lines_parsed.fetch_add(line_count - reported_lines, std::memory_order_relaxed);
+        m_bytes_parsed.fetch_add(reader.get_source_bytes_processed() - reported_bytes, std::memory_order_relaxed);
+        reported_lines = line_count;
+        reported_bytes = reader.get_source_bytes_processed();
+        if (batch->empty()) return;
+        sink(std::move(*batch));
+        if (reader.get_bytes_processed() - arena_start_bytes >= PARSE_UNIT_BYTES) {
+            arena = make_parse_arena();
+            arena_start_bytes = reader.get_bytes_processed();
         }
-        try {
-            switch (row_code) {
-                case 100: {
-                    // Convert Runway numbers to include a leading '0' if they're single digit
-                    std::string rw_numbers[2] = { std::string(tokens[8]), std::string(tokens[17]) };
-                    for (auto& rw_num : rw_numbers) {
-                        bool has_suffix = (rw_num.back() == 'L' || rw_num.back() == 'C' || rw_num.back() == 'R');
-                        if (rw_num.size() < 3 && has_suffix) {
-                            rw_num = "0" + rw_num;
-                        }
-                    }
+        batch.emplace(arena);
+    };
 
-                    runway_data.airport_icao = m_current_airport_icao;
-                    runway_data.width = std::stod(std::string(tokens[1]));
-                    runway_data.surface = std::stoi(std::string(tokens[2]));
-                    runway_data.end1_rw_number = rw_numbers[0];
-                    runway_data.end1_lat = std::stod(std::string(tokens[9]));
-                    runway_data.end1_lon = std::stod(std::string(tokens[10]));
-                    runway_data.end1_d_threshold = std::stod(std::string(tokens[11]));
-                    runway_data.end1_rw_marking_code = std::stoi(std::string(tokens[13]));
-                    runway_data.end1_rw_app_light_code = std::stoi(std::string(tokens[14]));
-                    runway_data.end2_rw_number = rw_numbers[1];
-                    runway_data.end2_lat = std::stod(std::string(tokens[18]));
-                    runway_data.end2_lon = std::stod(std::string(tokens[19]));
-                    runway_data.end2_d_threshold = std::stod(std::string(tokens[20]));
-                    runway_data.end2_rw_marking_code = std::stoi(std::string(tokens[22]));
-                    runway_data.end2_rw_app_light_code = std::stoi(std::string(tokens[23]));
-
-                    data.runways.push_back(std::move(runway_data));
-                    break;
+    try {
+        while (reader.get_next_line()) {
+            ++line_count;
+            auto& tokens = reader.get_line_tokens(line_tokens);
+            if (tokens.empty()) continue;
+            if (tokens.size() == 1) {
+                if (tokens[0] == "99") break;
+                continue;
+            }
+            if (tokens[1] == "Version") continue;
+            int row_code = reader.get_row_code();
+
+            FieldDecoder fields(tokens, reader.get_line_number());
+            try {
+                (this->*handler)(row_code, tokens, fields, *batch);
+            } catch (const std::exception& e) {
+                // Handlers decode every field before pushing any, so a failed record left nothing in the batch
+                if (m_lenient) {
+                    add_diagnostic(file, reader.get_line_number(), row_code, e.what());
+                    continue;
                 }
-                default:
-                    is_valid_row_code = false;
-                    reader.put_line_back();
-                    break;
+                std::ostringstream error_msg = write_parser_error(reader, tokens, e);
+                throw std::runtime_error(error_msg.str());
+            }
+            if (batch->size() >= NAV_BATCH_RECORDS) {
+                flush_batch();
             }
-        } catch (const std::exception& e) {
-            std::ostringstream error_msg = write_parser_error(reader, tokens, e);
-            throw std::runtime_error(error_msg.str());
         }
+    } catch (const std::exception& e) {
+        std::cerr << "\nError parsing " << file.string() << ": " << e.what() << std::endl;
+        throw;
     }
+    flush_batch();
 }
 
-void XPlaneDatParser::process_taxiway_node(LookaheadLineReader& reader, ParsedAptData& data) {
-    TaxiwayNodeData taxiway_node;
-    bool is_valid_row_code = true;
-    while (reader.get_next_line()) {
-        auto tokens = reader.get_line_tokens();
-        int row_code = reader.get_row_code();
-        if (tokens.empty()) continue;
-        if (!is_valid_row_code) {
-            reader.put_line_back();
-            break;
-        }
-        try {
-            switch (row_code) {
-                case 1200:
-                    break;
-                case 1201: {
-                    taxiway_node.node_id = std::stoi(std::string(tokens[4]));
-                    taxiway_node.airport_icao = m_current_airport_icao;
-                    taxiway_node.latitude = std::stod(std::string(tokens[1]));
-                    taxiway_node.longitude = std::stod(std::string(tokens[2]));
-                    taxiway_node.node_type = std::string(tokens[3]);
-
-                    data.taxiway_nodes.push_back(taxiway_node);
-                    break;
+// A CIFP line is an ARINC 424 record as comma separated fields behind its record type, e.g.
+// "SID:010,5,ALB2,RW04L,ALB,K6,D,,V  ,R,,VA,...;". Only procedure legs are kept, RWY and PRDAT lines are skipped.
+void XPlaneDatParser::parse_cifp_records(const fs::path& file, ParsedNavData& data) const {
+    LookaheadLineReader reader(file);
+    const std::string airport_icao = file.stem().string();
+    std::vector<std::string_view> fields;
+    uint64_t line_count = 0;
+
+    try {
+        while (reader.get_next_line()) {
+            ++line_count;
+            std::string_view line = reader.get_line();
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) continue;
+            std::string_view record_type = line.substr(0, colon);
+            if (record_type != "SID" && record_type != "STAR" && record_type != "APPCH") continue;
+
+            split_cifp_fields(line.substr(colon + 1), fields);
+            FieldDecoder decoder(fields, reader.get_line_number());
+            try {
+                add_procedure_leg(airport_icao, record_type, decoder, data);
+            } catch (const std::exception& e) {
+                if (m_lenient) {
+                    add_diagnostic(file, reader.get_line_number(), -1, e.what());
+                    continue;
                 }
-                default:
-                    is_valid_row_code = false;
-                    reader.put_line_back();
-                    break;
+                std::ostringstream error_msg = write_parser_error(reader, fields, e);
+                throw std::runtime_error(error_msg.str());
             }
-        } catch (const std::exception& e) {
-            std::ostringstream error_msg = write_parser_error(reader, tokens, e);
-            throw std::runtime_error(error_msg.str());
         }
+    } catch (const std::exception& e) {
+        std::cerr << "\nError parsing " << file.string() << ": " << e.what() << std::endl;
+        throw;
     }
+    m_lines_parsed.fetch_add(line_count, std::memory_order_relaxed);
+    m_bytes_parsed.fetch_add(reader.get_source_bytes_processed(), std::memory_order_relaxed);
 }
 
-void XPlaneDatParser::process_taxiway_edge(LookaheadLineReader& reader, ParsedAptData& data) {
-    TaxiwayEdgeData taxiway_edge;
-    bool is_valid_row_code = true;
-    while (reader.get_next_line()) {
-        auto tokens = reader.get_line_tokens();
-        int row_code = reader.get_row_code();
-        if (tokens.empty()) continue;
-        if (!is_valid_row_code) {
-            reader.put_line_back();
+// Indexed by AptParseState
+const XPlaneDatParser::LineHandler XPlaneDatParser::STATE_HANDLERS[] = {
+    &XPlaneDatParser::handle_record,
+    &XPlaneDatParser::handle_airport_meta,
+    &XPlaneDatParser::handle_linear_feature,
+};
+
+void XPlaneDatParser::begin_block(int row_code, AptParseContext& context, ParsedAptData& data) const {
+    switch (row_code) {
+        case 1:
+        case 16:
+        case 17:
+        case 1302:
+            context.airport_row = data.airports.size();
+            data.airports.append_null_row();
+            context.state = AptParseState::AirportMeta;
+            break;
+        case 120:
+            context.feature_first_node_row = data.linear_feature_nodes.size();
+            context.feature_sequence = context.current_airport_feature_sequence++;
+            context.feature_node_order = 0;
+            context.feature_header_seen = false;
+            context.is_taxiway_feature = false;
+            context.feature_line_type.reset();
+            context.bezier_latitude.reset();
+            context.bezier_longitude.reset();
+            context.state = AptParseState::LinearFeature;
+            break;
+    }
+}
+
+void XPlaneDatParser::end_block(AptParseContext& context, ParsedAptData& data, bool end_of_input) const {
+    switch (context.state) {
+        case AptParseState::Records:
+            break;
+
+        case AptParseState::AirportMeta: {
+            AirportColumns& airports = data.airports;
+            // Metadata that runs into the end of the input never closes its airport, so it is not kept
+            if (end_of_input) {
+                airports.truncate(context.airport_row);
+                break;
+            }
+            if (!airports.icao.has_value(context.airport_row)) {
+                throw std::bad_optional_access();
+            }
+            // Update the context for foreign keys
+            context.reset_airport_context(std::string(airports.icao.view(context.airport_row)));
             break;
         }
-        try {
-            switch (row_code) {
-                case 1202: {
-                    taxiway_edge.airport_icao = m_current_airport_icao;
-                    taxiway_edge.start_node_id = std::stoi(std::string(tokens[1]));
-                    taxiway_edge.end_node_id = std::stoi(std::string(tokens[2]));
-                    std::string is_twoway_string = std::string(tokens[3]);
-                    bool is_two_way = true;
-                    if (is_twoway_string != "twoway") {
-                        is_two_way = false;
-                    }
-                    taxiway_edge.is_two_way = is_two_way;
-                    
-                    std::string width_code = std::string(tokens[4]);
-                    if (!width_code.empty()) {
-                        char last_char = width_code.back();
-                        taxiway_edge.width_class = std::string(1, last_char);
-                    }
-                    
-                    if (tokens.size() > 5) {
-                        taxiway_edge.taxiway_name = std::string(tokens[5]);
-                    } else {
-                        taxiway_edge.taxiway_name = std::nullopt;
-                    }
 
-                    data.taxiway_edges.push_back(taxiway_edge);
-                    break;
+        case AptParseState::LinearFeature:
+            // Keep the feature header and its nodes, or drop the nodes again
+            if (context.is_taxiway_feature) {
+                LinearFeatureColumns& features = data.linear_features;
+                features.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+                features.feature_sequence.push_back(context.feature_sequence);
+                if (context.feature_line_type) {
+                    features.line_type.push_back(*context.feature_line_type);
+                } else {
+                    features.line_type.push_null();
                 }
-                default:
-                    is_valid_row_code = false;
-                    reader.put_line_back();
-                    break;
+            } else {
+                data.linear_feature_nodes.truncate(context.feature_first_node_row);
             }
-        } catch (const std::exception& e) {
-            std::ostringstream error_msg = write_parser_error(reader, tokens, e);
-            throw std::runtime_error(error_msg.str());
-        }
+            break;
     }
+    context.state = AptParseState::Records;
 }
 
-void XPlaneDatParser::process_linear_feature(LookaheadLineReader& reader, ParsedAptData& data) {
-    LinearFeatureData linear_feature;
-    LinearFeatureNodeData linear_feature_node;
-    std::vector<LinearFeatureNodeData> linear_feature_cache;
-    bool is_valid_row_code = true, feature_header_processed = false;
-    bool is_taxiway_feature = false;
-    int node_order = 0;
-    int assigned_feature_sequence = -1;
+bool XPlaneDatParser::handle_record(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    switch (row_code) {
+        // Airport metadata and linear features are blocks of their own
+        case 1:
+        case 16:
+        case 17:
+        case 1302:
+        case 120:
+            return false;
 
-    // Set of line type codes relating to taxiways that are important for our purposes (check apt.dat specification for more details)
-    // NOTE: We are trying to capture centerlines, centerline lights, hold-short lines, runway lead-off lights
-    // We are NOT trying to capture edge lighting or boundary features, as this will not add value (at the moment) to our Navigational data.
-    std::set<int> taxiway_codes = {1, 4, 5, 6, 7, 51, 54, 55, 56, 57, 101, 103, 104, 105, 107, 108};
-    while (reader.get_next_line()) {
-        auto tokens = reader.get_line_tokens();
-        int row_code = reader.get_row_code();
-        if (tokens.empty()) continue;
-        if (!is_valid_row_code) {
-            reader.put_line_back();
+        case 100:
+            add_runway(fields, context, data);
             break;
-        }
-        try {
-            switch (row_code) {
-                // Linear feature header
-                case 120: {
-                    if (!feature_header_processed) {
-                        linear_feature.airport_icao = m_current_airport_icao;
-                        assigned_feature_sequence = m_current_airport_feature_sequence++;
-                        linear_feature.feature_sequence = assigned_feature_sequence;
-
-                        if (tokens.size() > 1) {
-                            linear_feature.line_type = std::string(tokens[1]);
-                        }
-                        feature_header_processed = true;
-                    } else {
-                        // We've already processed the feature header
-                        // This means we've likely encountered the next group of feature header + feature nodes
-                        // Better to send it back to the dispatcher...
-                        is_valid_row_code = false;
-                        reader.put_line_back();
+
+        // Taxiway network nodes (the 1200 network header carries nothing we keep)
+        case 1201:
+            add_taxiway_node(fields, context, data);
+            break;
+
+        case 1202:
+            add_taxiway_edge(tokens, fields, context, data);
+            break;
+
+        case 20:
+            add_taxiway_sign(tokens, fields, context, data);
+            break;
+
+        // Startup locations, current (1300) and legacy (15) form. The 1301 ramp metadata that may follow a 1300
+        // (ICAO size class, operation type, airlines) has no columns in startup_locations.
+        case 15:
+        case 1300:
+            add_startup_location(row_code, tokens, fields, context, data);
+            break;
+
+        // Every other row code is ignored, including feature nodes outside a linear feature
+    }
+    return true;
+}
+
+bool XPlaneDatParser::handle_airport_meta(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& /*context*/, ParsedAptData& data) const {
+    AirportColumns& airports = data.airports;
+    switch (row_code) {
+        case 1:
+        case 16:
+        case 17: {
+            if (row_code == 1) airports.type.assign_back("Land");
+            else if (row_code == 16) airports.type.assign_back("Seaplane");
+            else if (row_code == 17) airports.type.assign_back("Heliport");
+
+            // Check if there is a [H] or [S] token in the vector
+            if (tokens.size() >= 6) {
+                for (size_t i = 3; i < tokens.size(); ++i) {
+                    if (tokens[i] == "[H]" || tokens[i] == "[S]" || tokens[i] == "[X]") {
+                        // We found it, and now we can remove it from the vector
+                        tokens.erase(tokens.begin() + i);
+                        break;
                     }
-                    break;
                 }
-                case 111:
-                case 112:
-                case 113:
-                case 114:
-                case 115:
-                case 116: {
-                    if (!feature_header_processed) {
-                        throw std::runtime_error("Found linear feature node without a header");
-                    }
-                    
-                    int shorter_line_code = 0, longer_line_code = 0;
-                    
-                    // Fetch the data that will always be present
-                    linear_feature_node.airport_icao = m_current_airport_icao;
-                    linear_feature_node.feature_sequence = assigned_feature_sequence;
-                    linear_feature_node.latitude = std::stod(std::string(tokens[1]));
-                    linear_feature_node.longitude = std::stod(std::string(tokens[2]));
-
-                    if (row_code == 112 || row_code == 114 || row_code == 116) {
-                        // Bezier case
-                        linear_feature_node.bezier_latitude = std::stod(std::string(tokens[3]));
-                        linear_feature_node.bezier_longitude = std::stod(std::string(tokens[4]));
-
-                        if (tokens.size() > 5) {
-                            shorter_line_code = std::stoi(std::string(tokens[5]));
-                            if (tokens.size() == 7) {
-                                longer_line_code = std::stoi(std::string(tokens[6]));
-                            }
-                        }
-                    } else {
-                        // Non-Bezier case
-                        if (tokens.size() > 3 && (row_code != 112 || row_code != 114 || row_code != 116)) {
-                            shorter_line_code = std::stoi(std::string(tokens[3]));
-                            if (tokens.size() == 5) {
-                                longer_line_code = std::stoi(std::string(tokens[4]));
-                            }
-                        }
-                    }
+            }
+            airports.elevation.assign_back(fields.to_int(1, "elevation"));
+            airports.icao.assign_back(fields.token(4, "icao"));
 
-                    linear_feature_node.node_order = node_order++;
+            // We need to account for the usual case where an airport_name is multiple tokens
+            std::string s_airport_name = "";
+            for (size_t j = 5; j < tokens.size(); ++j) {
+                s_airport_name += std::string(tokens[j]) + " ";
+            }
 
-                    // Check line_code ints to determine if we have found a node that is part of our taxiway_codes set
-                    if (taxiway_codes.count(shorter_line_code) || taxiway_codes.count(longer_line_code)) {
-                        is_taxiway_feature = true;
+            // Strip whitespace from both ends
+            if (!s_airport_name.empty()) {
+                size_t start = s_airport_name.find_first_not_of(" \t\n\r\f\v");
+                if (start != std::string::npos) {
+                    size_t end = s_airport_name.find_last_not_of(" \t\n\r\f\v");
+                    s_airport_name = s_airport_name.substr(start, end - start + 1);
+                } else {
+                    s_airport_name.clear();
+                }
+            }
+            
+            airports.airport_name.assign_back(s_airport_name);
+            return true;
+        }
+        case 1302: {
+            std::string key = std::string(fields.token(1, "key"));
+            std::string value;
+            if (tokens.size() < 3) return true;
+            if (tokens.size() > 3) {
+                for (size_t i = 2; i < tokens.size(); ++i) {
+                    value += std::string(tokens[i]);
+                    if (i < tokens.size() - 1) {
+                        value += " ";
                     }
+                }
+            } else {
+                value = std::string(tokens[2]);
+            }
 
-                    linear_feature_cache.push_back(linear_feature_node);
-                    break;
+            if (key == "icao_code") {
+                airports.icao.assign_back(value);
+            } else if (key == "faa_code") {
+                airports.faa.assign_back(value);
+            } else if (key == "iata_code") {
+                airports.iata.assign_back(value);
+            } else if (key == "city") {
+                airports.city.assign_back(value);
+            } else if (key == "country") {
+                airports.country.assign_back(value);
+            } else if (key == "state") {
+                airports.state.assign_back(value);
+            } else if (key == "region_code") {
+                airports.region.assign_back(value);
+            } else if (key == "transition_alt") {
+                airports.transition_alt.assign_back(value);
+            } else if (key == "transition_level") {
+                // We need to check for all kinds of incorrect strings here
+                bool is_non_numeric = std::none_of(value.begin(), value.end(), [](unsigned char c) {
+                    return std::isdigit(c);
+                });
+
+                if (value.substr(0, 2) == "FL" || is_non_numeric) {
+                    airports.transition_level.assign_back(value);
+                } else {
+                    // We need to convert all purely numerical instances to the form "FLxxx" or "FLxx"
+                    int numeric_value = fields.to_int(value, "transition_level");
+                    numeric_value = static_cast<int>(numeric_value / 100);
+                    std::string converted_value = "FL" + std::to_string(numeric_value);
+                    airports.transition_level.assign_back(converted_value);
                 }
-                default:
-                    is_valid_row_code = false;
-                    reader.put_line_back();
-                    break;
+            } else if (key == "datum_lat") {
+                airports.latitude.assign_back(fields.to_double(value, "datum_lat"));
+            } else if (key == "datum_lon") {
+                airports.longitude.assign_back(fields.to_double(value, "datum_lon"));
             }
-        } catch (const std::exception& e) {
-            std::ostringstream error_msg = write_parser_error(reader, tokens, e);
-            throw std::runtime_error(error_msg.str());
+
+            // Ignore other keys
+            return true;
         }
+        default:
+            return false;
     }
+}
 
-    // Once we're out of the while loop, we can add the feature header and node cache to the parsed data structure
-    if (is_taxiway_feature) {
-        data.linear_features.push_back(linear_feature);
-        for (const auto& node : linear_feature_cache) {
-            data.linear_feature_nodes.push_back(node);
+bool XPlaneDatParser::handle_linear_feature(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    switch (row_code) {
+        // Linear feature header
+        case 120: {
+            // A second header starts the next feature, which goes back through the Records state
+            if (context.feature_header_seen) return false;
+            context.feature_header_seen = true;
+            if (tokens.size() > 1) {
+                context.feature_line_type = std::string(tokens[1]);
+            }
+            return true;
         }
+        case 111:
+        case 112:
+        case 113:
+        case 114:
+        case 115:
+        case 116: {
+            int shorter_line_code = 0, longer_line_code = 0;
+            
+            // Fetch the data that will always be present
+            double latitude = fields.to_double(1, "latitude");
+            double longitude = fields.to_double(2, "longitude");
+
+            if (row_code == 112 || row_code == 114 || row_code == 116) {
+                // Bezier case
+                context.bezier_latitude = fields.to_double(3, "bezier_latitude");
+                context.bezier_longitude = fields.to_double(4, "bezier_longitude");
+
+                if (tokens.size() > 5) {
+                    shorter_line_code = fields.to_int(5, "line_type");
+                    if (tokens.size() == 7) {
+                        longer_line_code = fields.to_int(6, "lighting_type");
+                    }
+                }
+            } else {
+                // Non-Bezier case
+                if (tokens.size() > 3) {
+                    shorter_line_code = fields.to_int(3, "line_type");
+                    if (tokens.size() == 5) {
+                        longer_line_code = fields.to_int(4, "lighting_type");
+                    }
+                }
+            }
+
+            LinearFeatureNodeColumns& feature_nodes = data.linear_feature_nodes;
+            feature_nodes.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+            feature_nodes.feature_sequence.push_back(context.feature_sequence);
+            feature_nodes.latitude.push_back(latitude);
+            feature_nodes.longitude.push_back(longitude);
+            feature_nodes.bezier_latitude.push_back(context.bezier_latitude);
+            feature_nodes.bezier_longitude.push_back(context.bezier_longitude);
+            feature_nodes.node_order.push_back(context.feature_node_order++);
+
+            // Check line_code ints to determine if we have found a node that is part of our taxiway line types
+            if (is_taxiway_line_code(shorter_line_code) || is_taxiway_line_code(longer_line_code)) {
+                context.is_taxiway_feature = true;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void XPlaneDatParser::add_runway(const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    RunwayColumns& runways = data.runways;
+
+    // Convert Runway numbers to include a leading '0' if they're single digit
+    std::string rw_numbers[2] = { std::string(fields.token(8, "end1_rw_number")), std::string(fields.token(17, "end2_rw_number")) };
+    for (auto& rw_num : rw_numbers) {
+        bool has_suffix = (rw_num.back() == 'L' || rw_num.back() == 'C' || rw_num.back() == 'R');
+        if (rw_num.size() < 3 && has_suffix) {
+            rw_num = "0" + rw_num;
+        }
+    }
+
+    // Decode every field before appending, so a bad field cannot leave the columns misaligned
+    double width = fields.to_double(1, "width");
+    int surface = fields.to_int(2, "surface");
+    double end1_lat = fields.to_double(9, "end1_lat");
+    double end1_lon = fields.to_double(10, "end1_lon");
+    double end1_d_threshold = fields.to_double(11, "end1_d_threshold");
+    int end1_rw_marking_code = fields.to_int(13, "end1_rw_marking_code");
+    int end1_rw_app_light_code = fields.to_int(14, "end1_rw_app_light_code");
+    double end2_lat = fields.to_double(18, "end2_lat");
+    double end2_lon = fields.to_double(19, "end2_lon");
+    double end2_d_threshold = fields.to_double(20, "end2_d_threshold");
+    int end2_rw_marking_code = fields.to_int(22, "end2_rw_marking_code");
+    int end2_rw_app_light_code = fields.to_int(23, "end2_rw_app_light_code");
+
+    runways.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+    runways.width.push_back(width);
+    runways.surface.push_back(surface);
+    runways.end1.rw_number.push_back(rw_numbers[0]);
+    runways.end1.latitude.push_back(end1_lat);
+    runways.end1.longitude.push_back(end1_lon);
+    runways.end1.d_threshold.push_back(end1_d_threshold);
+    runways.end1.rw_marking_code.push_back(end1_rw_marking_code);
+    runways.end1.rw_app_light_code.push_back(end1_rw_app_light_code);
+    runways.end2.rw_number.push_back(rw_numbers[1]);
+    runways.end2.latitude.push_back(end2_lat);
+    runways.end2.longitude.push_back(end2_lon);
+    runways.end2.d_threshold.push_back(end2_d_threshold);
+    runways.end2.rw_marking_code.push_back(end2_rw_marking_code);
+    runways.end2.rw_app_light_code.push_back(end2_rw_app_light_code);
+}
+
+void XPlaneDatParser::add_taxiway_node(const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    TaxiwayNodeColumns& taxiway_nodes = data.taxiway_nodes;
+    int node_id = fields.to_int(4, "node_id");
+    double latitude = fields.to_double(1, "latitude");
+    double longitude = fields.to_double(2, "longitude");
+    std::string_view node_type = fields.token(3, "node_type");
+
+    taxiway_nodes.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+    taxiway_nodes.node_id.push_back(node_id);
+    taxiway_nodes.latitude.push_back(latitude);
+    taxiway_nodes.longitude.push_back(longitude);
+    taxiway_nodes.node_type.push_back(node_type);
+}
+
+void XPlaneDatParser::add_taxiway_edge(std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    TaxiwayEdgeColumns& taxiway_edges = data.taxiway_edges;
+    int start_node_id = fields.to_int(1, "start_node_id");
+    int end_node_id = fields.to_int(2, "end_node_id");
+    bool is_two_way = fields.token(3, "direction") == "twoway";
+    std::string_view width_code = fields.token(4, "width_class");
+
+    taxiway_edges.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+    taxiway_edges.start_node_id.push_back(start_node_id);
+    taxiway_edges.end_node_id.push_back(end_node_id);
+    taxiway_edges.is_two_way.push_back(is_two_way ? 1 : 0);
+    // The width class is the last character of the code (e.g. taxiway_E)
+    taxiway_edges.width_class.push_back(width_code.substr(width_code.size() - 1));
+
+    if (tokens.size() > 5) {
+        taxiway_edges.taxiway_name.push_back(tokens[5]);
+    } else {
+        taxiway_edges.taxiway_name.push_null();
+    }
+}
+
+void XPlaneDatParser::add_taxiway_sign(std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    TaxiwaySignColumns& signs = data.taxiway_signs;
+    double latitude = fields.to_double(1, "latitude");
+    double longitude = fields.to_double(2, "longitude");
+    double heading = fields.to_double(3, "heading");
+    int size_class = fields.to_int(5, "size_class");
+    fields.token(6, "sign_text");       // Required, but may span several tokens
+    std::string sign_text = join_tokens(tokens, 6);
+
+    signs.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+    signs.latitude.push_back(latitude);
+    signs.longitude.push_back(longitude);
+    signs.heading.push_back(heading);
+    signs.size_class.push_back(size_class);
+    signs.sign_text.push_back(sign_text);
+}
+
+void XPlaneDatParser::add_startup_location(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const {
+    StartupLocationColumns& locations = data.startup_locations;
+    double latitude = fields.to_double(1, "latitude");
+    double longitude = fields.to_double(2, "longitude");
+    double heading = fields.to_double(3, "heading");
+    // 1300: location type and aircraft types come before the name. 15: the name follows the heading.
+    std::optional<std::string_view> location_type;
+    size_t name_index = 4;
+    if (row_code == 1300) {
+        location_type = fields.token(4, "location_type");
+        name_index = 6;
+    }
+
+    locations.airport.push_back(data.airport_ids.intern(context.current_airport_icao));
+    locations.latitude.push_back(latitude);
+    locations.longitude.push_back(longitude);
+    locations.heading.push_back(heading);
+    if (location_type) {
+        locations.location_type.push_back(*location_type);
+    } else {
+        locations.location_type.push_null();
+    }
+    if (tokens.size() > name_index) {
+        locations.ramp_name.push_back(join_tokens(tokens, name_index));
+    } else {
+        locations.ramp_name.push_null();
+    }
+}
+
+// Layout (1150 and later): row code, latitude, longitude, elevation (ft), frequency, range (nm), bearing field, ident,
+// terminal region (airport ICAO, or ENRT), ICAO region, name
+void XPlaneDatParser::add_navaid(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, ParsedNavData& data) const {
+    const char* navaid_type = navaid_type_of(row_code);
+    if (navaid_type == nullptr) return;
+
+    NavaidColumns& navaids = data.navaids;
+    double latitude = fields.to_double(1, "latitude");
+    double longitude = fields.to_double(2, "longitude");
+    int elevation = fields.to_int(3, "elevation");
+    int frequency = fields.to_int(4, "frequency");
+    int range = fields.to_int(5, "range");
+    double bearing = fields.to_double(6, "bearing");
+    std::string_view ident = fields.token(7, "ident");
+    std::string_view terminal_region = fields.token(8, "terminal_region");
+    std::string_view icao_region = fields.token(9, "icao_region");
+
+    // A glideslope packs its angle in front of the bearing: angle * 100000 + bearing (300180.343 is 3.00 at 180.343)
+    std::optional<double> glideslope_angle;
+    if (row_code == 6) {
+        glideslope_angle = std::floor(bearing / 1000.0) / 100.0;
+        bearing = std::fmod(bearing, 1000.0);
+    }
+
+    navaids.row_code.push_back(row_code);
+    navaids.navaid_type.push_back(navaid_type);
+    navaids.latitude.push_back(latitude);
+    navaids.longitude.push_back(longitude);
+    navaids.elevation.push_back(elevation);
+    navaids.frequency.push_back(frequency);
+    navaids.range.push_back(range);
+    navaids.bearing.push_back(bearing);
+    navaids.glideslope_angle.push_back(glideslope_angle);
+    navaids.ident.push_back(ident);
+    if (terminal_region == "ENRT") {
+        navaids.airport_icao.push_null();
+    } else {
+        navaids.airport_icao.push_back(terminal_region);
     }
+    navaids.icao_region.push_back(icao_region);
+    if (tokens.size() > 10) {
+        navaids.name.push_back(join_tokens(tokens, 10));
+    } else {
+        navaids.name.push_null();
+    }
+}
+
+// Layout (1101): latitude, longitude, ident, terminal region (airport ICAO, or ENRT), ICAO region, waypoint type
+void XPlaneDatParser::add_fix(int /*row_code*/, std::vector<std::string_view>& tokens, const FieldDecoder& fields, ParsedNavData& data) const {
+    FixColumns& fixes = data.fixes;
+    double latitude = fields.to_double(0, "latitude");
+    double longitude = fields.to_double(1, "longitude");
+    std::string_view ident = fields.token(2, "ident");
+    std::string_view terminal_region = fields.token(3, "terminal_region");
+    std::string_view icao_region = fields.token(4, "icao_region");
+    std::optional<int> waypoint_type;
+    if (tokens.size() > 5) {
+        waypoint_type = fields.to_int(5, "waypoint_type");
+    }
+
+    fixes.latitude.push_back(latitude);
+    fixes.longitude.push_back(longitude);
+    fixes.ident.push_back(ident);
+    if (terminal_region == "ENRT") {
+        fixes.airport_icao.push_null();
+    } else {
+        fixes.airport_icao.push_back(terminal_region);
+    }
+    fixes.icao_region.push_back(icao_region);
+    fixes.waypoint_type.push_back(waypoint_type);
+}
+
+// Layout (1100): from ident, region, type, to ident, region, type, direction, level, base FL, top FL, airway names
+void XPlaneDatParser::add_airway_segment(int /*row_code*/, std::vector<std::string_view>& /*tokens*/, const FieldDecoder& fields, ParsedNavData& data) const {
+    AirwaySegmentColumns& segments = data.airway_segments;
+    std::string_view from_ident = fields.token(0, "from_ident");
+    std::string_view from_region = fields.token(1, "from_region");
+    int from_type = fields.to_int(2, "from_type");
+    std::string_view to_ident = fields.token(3, "to_ident");
+    std::string_view to_region = fields.token(4, "to_region");
+    int to_type = fields.to_int(5, "to_type");
+    std::string_view direction = fields.token(6, "direction");
+    int airway_level = fields.to_int(7, "airway_level");
+    int base_fl = fields.to_int(8, "base_fl");
+    int top_fl = fields.to_int(9, "top_fl");
+    std::string_view airway_names = fields.token(10, "airway_name");
+
+    size_t name_start = 0;
+    while (name_start <= airway_names.size()) {
+        size_t name_end = airway_names.find('-', name_start);
+        if (name_end == std::string_view::npos) name_end = airway_names.size();
+        std::string_view airway_name = airway_names.substr(name_start, name_end - name_start);
+        name_start = name_end + 1;
+        if (airway_name.empty()) continue;
+
+        segments.airway_name.push_back(airway_name);
+        segments.from_ident.push_back(from_ident);
+        segments.from_region.push_back(from_region);
+        segments.from_type.push_back(from_type);
+        segments.to_ident.push_back(to_ident);
+        segments.to_region.push_back(to_region);
+        segments.to_type.push_back(to_type);
+        segments.direction.push_back(direction);
+        segments.airway_level.push_back(airway_level);
+        segments.base_fl.push_back(base_fl);
+        segments.top_fl.push_back(top_fl);
+    }
+}
+
+// Fields: sequence, route type, procedure ident, transition ident, fix ident, fix region, fix section, fix subsection,
+// waypoint description code, turn direction, RNP, path terminator, turn direction valid, recommended navaid, ...
+void XPlaneDatParser::add_procedure_leg(std::string_view airport_icao, std::string_view procedure_type, const FieldDecoder& fields, ParsedNavData& data) const {
+    ProcedureLegColumns& legs = data.procedure_legs;
+    int sequence = fields.to_int(0, "sequence");
+    std::string_view route_type = fields.token(1, "route_type");
+    std::string_view procedure_ident = fields.token(2, "procedure_ident");
+    std::string_view transition_ident = fields.token(3, "transition_ident");
+    std::string_view fix_ident = fields.token(4, "fix_ident");
+    std::string_view fix_region = fields.token(5, "fix_region");
+    std::string_view description_code = fields.token(8, "description_code");
+    std::string_view turn_direction = fields.token(9, "turn_direction");
+    std::string_view path_terminator = fields.token(11, "path_terminator");
+    std::string_view recommended_navaid = fields.token(13, "recommended_navaid");
+
+    legs.airport_icao.push_back(airport_icao);
+    legs.procedure_type.push_back(procedure_type);
+    legs.route_type.push_back(route_type);
+    legs.procedure_ident.push_back(procedure_ident);
+    push_text_or_null(legs.transition_ident, transition_ident);
+    legs.sequence.push_back(sequence);
+    push_text_or_null(legs.fix_ident, fix_ident);
+    push_text_or_null(legs.fix_region, fix_region);
+    push_text_or_null(legs.description_code, description_code);
+    push_text_or_null(legs.turn_direction, turn_direction);
+    legs.path_terminator.push_back(path_terminator);
+    push_text_or_null(legs.recommended_navaid, recommended_navaid);
 }
 
 // Utility function for Parser errors
-std::ostringstream XPlaneDatParser::write_parser_error(LookaheadLineReader& reader, std::vector<std::string_view>& tokens, const std::exception& e) {
+std::ostringstream XPlaneDatParser::write_parser_error(LookaheadLineReader& reader, std::vector<std::string_view>& tokens, const std::exception& e) const {
     std::ostringstream error_msg;
     std::string line_data;
     std::string token_data_str = "[";
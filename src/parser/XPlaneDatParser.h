@@ -1,47 +1,173 @@
 #pragma once
 #include "LookaheadLineReader.h"
-#include <NavDataManager/Types.h>
+#include "ThreadPool.h"
+#include "ParsedAptData.h"
+#include "ParsedNavData.h"
+#include <NavDataManager/IngestSummary.h>
 #include <string>
 #include <string_view>
+#include <sstream>
 #include <vector>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <optional>
+#include <atomic>
+#include <cstdint>
 #include <SQLiteCpp/Database.h>
 
 namespace fs = std::filesystem;
 
-// Container for all parsed data from a single .dat file
-struct ParsedAptData {
-    std::vector<AirportMeta> airports;
-    std::vector<RunwayData> runways;
-    std::vector<TaxiwayNodeData> taxiway_nodes;
-    std::vector<TaxiwayEdgeData> taxiway_edges;
-    std::vector<LinearFeatureData> linear_features;
-    std::vector<LinearFeatureNodeData> linear_feature_nodes;
+class FieldDecoder;
+
+// What the parser is in the middle of. Airport metadata and linear features span several lines; every other record
+// is a single line and is handled in the Records state.
+enum class AptParseState {
+    Records,            // Between blocks: single-line records, or the line that opens the next block
+    AirportMeta,        // After a 1/16/17 header (or a stray 1302): header and 1302 metadata lines
+    LinearFeature       // After a 120 header: its 111-116 nodes
+};
+
+// State that belongs to a single parse task (one file, or one chunk of a large file). Keeping it out of the parser
+// lets several files and chunks be parsed concurrently by the same XPlaneDatParser.
+struct AptParseContext {
+    std::string current_airport_icao;
+    int current_airport_feature_sequence = 1;      // Reset per airport
+    std::vector<std::string_view> line_tokens;     // Reused for every line, see LineTokenizer.h
+    AptParseState state = AptParseState::Records;
+
+    // AirportMeta: the airport is built in place as this row of the airport columns
+    size_t airport_row = 0;
+
+    // LinearFeature: nodes are appended as they are read and dropped again if the feature is not a taxiway feature
+    size_t feature_first_node_row = 0;
+    int feature_sequence = -1;
+    int feature_node_order = 0;
+    bool feature_header_seen = false;
+    bool is_taxiway_feature = false;
+    std::optional<std::string> feature_line_type;
+    std::optional<double> bezier_latitude, bezier_longitude;       // Carried over to the following nodes, as before
+
+    void reset_airport_context(const std::string& new_icao) {
+        current_airport_icao = new_icao;
+        current_airport_feature_sequence = 1;
+    }
 };
 
 class XPlaneDatParser {
     public:
-        explicit XPlaneDatParser(bool logging = false);
+        // parse_threads: worker threads used to parse large files in parallel chunks (0 = one per hardware thread)
+        explicit XPlaneDatParser(bool logging = false, unsigned parse_threads = 0);
+
+        // Receives one airport at a time, in file order: its AirportMeta together with all of its runways, taxi network
+        // and linear features. Records that precede the first airport header are delivered as a batch of their own.
+        using AptDataSink = std::function<void(ParsedAptData&&)>;
 
-        // Returns all parsed data structures, ready for database insertion
+        // Streaming parse: every airport batch goes to the sink as soon as it is complete, so memory stays bounded by
+        // a single airport (or a few chunks of airports when a large file is parsed in parallel). If the sink throws,
+        // parsing stops and the exception propagates.
+        // Safe to call from several threads at once, each call parses with its own AptParseContext.
+        void parse_airport_dat(const fs::path& file, const AptDataSink& sink);
+
+        // Returns all parsed data structures of the file at once, ready for database insertion
         ParsedAptData parse_airport_dat(const fs::path& file);
 
+        // Parses the single airport record that starts at span.offset of an apt.dat file (see AirportColumns::record)
+        // and hands it to the sink, reading only that part of the file. Returns false without parsing if no airport
+        // header starts there any more, or the file is compressed and cannot be entered at an offset.
+        bool parse_airport_record(const fs::path& file, const AptRecordSpan& span, const AptDataSink& sink) const;
+
+        // Receives the records of a nav .dat file (earth_nav, earth_fix, earth_awy) in file order, a few thousand at a time
+        using NavDataSink = std::function<void(ParsedNavData&&)>;
+
+        // Streaming parse of an earth_nav.dat file (NDB, VOR, ILS components, marker beacons, DME), with the same
+        // contract as parse_airport_dat(). Expects the 1150 or later layout, which carries the terminal and ICAO
+        // region of every navaid. The file is a few MiB, so it is always parsed serially.
+        void parse_nav_dat(const fs::path& file, const NavDataSink& sink);
+
+        // Returns all navaids of the file at once
+        ParsedNavData parse_nav_dat(const fs::path& file);
+
+        // Streaming parse of earth_fix.dat (1101 layout) into ParsedNavData::fixes
+        void parse_fix_dat(const fs::path& file, const NavDataSink& sink);
+        ParsedNavData parse_fix_dat(const fs::path& file);
+
+        // Streaming parse of earth_awy.dat (1100 layout, with segment directions) into ParsedNavData::airway_segments
+        void parse_awy_dat(const fs::path& file, const NavDataSink& sink);
+        ParsedNavData parse_awy_dat(const fs::path& file);
+
+        // Streaming parse of CIFP files (SID, STAR and APPCH records) into ParsedNavData::procedure_legs. There is one
+        // small file per airport, named after it (CIFP/KJFK.dat), so the files are parsed in list order into shared
+        // batches. Safe to call from several threads at once.
+        void parse_cifp_files(const std::vector<fs::path>& files, const NavDataSink& sink) const;
+        ParsedNavData parse_cifp_dat(const fs::path& file) const;
+
+        // Lenient parsing: a record that fails to parse is reported as a diagnostic instead of throwing. In apt.dat
+        // the rest of its airport is skipped up to the next airport header, since the airport's records depend on each
+        // other; in the nav .dat and CIFP files only the line is skipped, and a CIFP file that cannot be read is skipped.
+        void set_lenient(bool lenient) { m_lenient = lenient; }
+        bool is_lenient() const { return m_lenient; }
+
+        // Diagnostics collected by lenient parses since the last call, in no particular order. Thread safe.
+        std::vector<IngestDiagnostic> take_diagnostics();
+
+        // Memory taken by the parse arenas so far (see ParseArena.h)
+        ArenaUsage arena_usage() const;
+
+        // Input read by all parses so far, updated as each airport completes. Safe to read while parsing.
+        uint64_t lines_parsed() const { return m_lines_parsed.load(std::memory_order_relaxed); }
+        uint64_t bytes_parsed() const { return m_bytes_parsed.load(std::memory_order_relaxed); }
+
     private:
         bool m_logging_enabled;
-        AirportMeta m_current_airport;
-        std::string m_current_airport_icao;
-        int m_current_airport_feature_sequence = 1; // Reset per airport
-        
-        void reset_airport_context(const std::string& new_icao) {
-            m_current_airport_icao = new_icao;
-            m_current_airport_feature_sequence = 1;
-        }
-
-        void process_airport_meta(LookaheadLineReader& reader, ParsedAptData& data);
-        void process_runway(LookaheadLineReader& reader, ParsedAptData& data);
-        void process_taxiway_node(LookaheadLineReader& reader, ParsedAptData& data);
-        void process_taxiway_edge(LookaheadLineReader& reader, ParsedAptData& data);
-        void process_linear_feature(LookaheadLineReader& reader, ParsedAptData& data);
-
-        std::ostringstream write_parser_error(LookaheadLineReader& reader, std::vector<std::string_view>& tokens, const std::exception& e);
+        unsigned m_parse_threads;
+        std::unique_ptr<ThreadPool> m_chunk_pool;       // Created on the first file large enough to split
+        std::once_flag m_chunk_pool_created;
+        std::shared_ptr<ArenaStats> m_arena_stats;
+        mutable std::atomic<uint64_t> m_lines_parsed{0};
+        mutable std::atomic<uint64_t> m_bytes_parsed{0};
+        bool m_lenient = false;
+        mutable std::mutex m_diagnostics_mutex;
+        mutable std::vector<IngestDiagnostic> m_diagnostics;
+
+        std::shared_ptr<ParseArena> make_parse_arena() const;
+        void add_diagnostic(const fs::path& file, int line, int row_code, const std::string& reason) const;
+
+        // base_offset: where the reader's input starts in the file, so record spans are file offsets
+        void parse_records(LookaheadLineReader& reader, const AptDataSink& sink, const fs::path& file, uint64_t base_offset = 0) const;
+        // Record handler of a nav .dat file, given every line that is not part of the file header
+        using NavLineHandler = void (XPlaneDatParser::*)(int row_code, std::vector<std::string_view>& tokens,
+                                                         const FieldDecoder& fields, ParsedNavData& data) const;
+        void parse_nav_records(const fs::path& file, const NavDataSink& sink, NavLineHandler handler) const;
+        void parse_cifp_records(const fs::path& file, ParsedNavData& data) const;
+        void parse_airport_dat_parallel(const fs::path& file, std::string_view contents, const AptDataSink& sink);
+
+        // Line handlers, one per AptParseState. Each line is tokenized once and given to the handler of the current
+        // state, which returns false if the line does not belong to that state (see parse_records).
+        using LineHandler = bool (XPlaneDatParser::*)(int row_code, std::vector<std::string_view>& tokens,
+                                                      const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        static const LineHandler STATE_HANDLERS[];
+
+        bool handle_record(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        bool handle_airport_meta(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        bool handle_linear_feature(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+
+        void add_runway(const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        void add_taxiway_node(const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        void add_taxiway_edge(std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        void add_taxiway_sign(std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+        void add_startup_location(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, AptParseContext& context, ParsedAptData& data) const;
+
+        void add_navaid(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, ParsedNavData& data) const;
+        void add_fix(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, ParsedNavData& data) const;
+        void add_airway_segment(int row_code, std::vector<std::string_view>& tokens, const FieldDecoder& fields, ParsedNavData& data) const;
+        void add_procedure_leg(std::string_view airport_icao, std::string_view procedure_type, const FieldDecoder& fields, ParsedNavData& data) const;
+
+        // Enters the block a 1/16/17/1302 or 120 line opens, before the line itself is handled in that block
+        void begin_block(int row_code, AptParseContext& context, ParsedAptData& data) const;
+        // Closes the current block and returns to Records. At the end of the input an unfinished airport is dropped.
+        void end_block(AptParseContext& context, ParsedAptData& data, bool end_of_input) const;
+
+        std::ostringstream write_parser_error(LookaheadLineReader& reader, std::vector<std::string_view>& tokens, const std::exception& e) const;
 };
\ No newline at end of file
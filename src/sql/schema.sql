@@ -155,14 +155,114 @@ CREATE TABLE IF NOT EXISTS startup_locations (
     FOREIGN KEY (airport_icao) REFERENCES airports (icao) ON DELETE CASCADE
 );
 
+-- ====================================================================
+-- Navaids (earth_nav.dat) Row Codes: 2-9, 12-16
+-- The spatial index (navaids_rtree) is created by NavDataManager, since it
+-- needs the SQLite R*Tree module.
+-- ====================================================================
+CREATE TABLE IF NOT EXISTS navaids (
+    navaid_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    row_code INTEGER NOT NULL,
+    navaid_type TEXT NOT NULL,   -- 'NDB', 'VOR', 'ILS', 'LOC', 'GS', 'OM', 'MM', 'IM', 'DME', 'FPAP', 'GLS', 'LTP'
+    ident TEXT NOT NULL,
+    latitude REAL NOT NULL,
+    longitude REAL NOT NULL,
+    elevation INTEGER,           -- Feet MSL
+    frequency INTEGER,           -- NDB in kHz, VHF in 10 kHz units (11680 = 116.80 MHz)
+    range INTEGER,               -- Nautical miles
+    bearing REAL,                -- VOR slaved variation, LOC/GS/marker bearing or DME bias, depending on row_code
+    glideslope_angle REAL,       -- Glideslopes only
+    airport_icao TEXT,           -- Airport a terminal navaid belongs to, NULL for enroute navaids
+    icao_region TEXT,
+    name TEXT
+);
+
+-- ====================================================================
+-- Fixes (earth_fix.dat) and Airways (earth_awy.dat)
+-- Airway segments name their end points by (ident, region, type) and are
+-- resolved against fixes (type 11) and navaids (2 = NDB, 3 = VHF).
+-- ====================================================================
+CREATE TABLE IF NOT EXISTS fixes (
+    fix_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    ident TEXT NOT NULL,
+    latitude REAL NOT NULL,
+    longitude REAL NOT NULL,
+    airport_icao TEXT,           -- Airport a terminal fix belongs to, NULL for enroute fixes
+    icao_region TEXT NOT NULL,
+    waypoint_type INTEGER        -- ARINC 424 waypoint type
+);
+
+CREATE TABLE IF NOT EXISTS airway_segments (
+    segment_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    airway_name TEXT NOT NULL,   -- One row per airway when a segment is shared, e.g. "J13-J14"
+    from_ident TEXT NOT NULL,
+    from_region TEXT NOT NULL,
+    from_type INTEGER NOT NULL,  -- 11 = fix, 2 = NDB, 3 = VHF navaid
+    to_ident TEXT NOT NULL,
+    to_region TEXT NOT NULL,
+    to_type INTEGER NOT NULL,
+    direction TEXT NOT NULL,     -- 'N' both ways, 'F' from -> to only, 'B' to -> from only
+    airway_level INTEGER,        -- 1 = low, 2 = high
+    base_fl INTEGER,
+    top_fl INTEGER
+);
+
+-- ====================================================================
+-- Procedures (CIFP/<ICAO>.dat): one row per leg of a SID, STAR or approach
+-- ====================================================================
+CREATE TABLE IF NOT EXISTS procedure_legs (
+    leg_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    airport_icao TEXT NOT NULL,
+    procedure_type TEXT NOT NULL,    -- 'SID', 'STAR', 'APPCH'
+    route_type TEXT,
+    procedure_ident TEXT NOT NULL,
+    transition_ident TEXT,           -- NULL for the common route
+    sequence INTEGER NOT NULL,
+    fix_ident TEXT,
+    fix_region TEXT,
+    description_code TEXT,
+    turn_direction TEXT,
+    path_terminator TEXT NOT NULL,   -- ARINC 424 leg type ('IF', 'TF', 'CF', 'VA', ...)
+    recommended_navaid TEXT
+);
+
+-- ====================================================================
+-- Where each airport's record lies in the apt.dat files, so one airport can be parsed again without the rest
+-- ====================================================================
+CREATE TABLE IF NOT EXISTS airport_records (
+    record_id INTEGER PRIMARY KEY AUTOINCREMENT,
+    source_file TEXT NOT NULL,
+    airport_icao TEXT NOT NULL,
+    byte_offset INTEGER NOT NULL,    -- Start of the 1/16/17 header line, in the decompressed file
+    byte_length INTEGER NOT NULL,    -- Up to the next airport header
+    first_line INTEGER NOT NULL,
+    is_custom_scenery INTEGER NOT NULL,
+    scenery_priority INTEGER NOT NULL DEFAULT 0,  -- Position of the file in the scenery order, the highest has the airport
+    UNIQUE (source_file, airport_icao)
+);
+
+-- Every .dat file ingested, with what it looked like at the time so the next run can tell whether it changed
 CREATE TABLE IF NOT EXISTS scenery_paths (
     scenery_path_id INTEGER PRIMARY KEY AUTOINCREMENT,
     scenery_path TEXT NOT NULL,
-    created_at TEXT NOT NULL DEFAULT (datetime('now'))
+    created_at TEXT NOT NULL DEFAULT (datetime('now')),
+    file_size INTEGER,
+    modified_time INTEGER,           -- Last write time, in ticks of the filesystem clock
+    content_hash INTEGER             -- 64-bit hash of the file's bytes
 );
 
 -- Indexes for increased performance
 CREATE INDEX IF NOT EXISTS idx_airports_country_id ON airports(country_id);
 CREATE INDEX IF NOT EXISTS idx_airports_state_id ON airports(state_id);
 CREATE INDEX IF NOT EXISTS idx_airports_city_id ON airports(city_id);
-CREATE INDEX IF NOT EXISTS idx_airports_region_id ON airports(region_id);
\ No newline at end of file
+CREATE INDEX IF NOT EXISTS idx_airports_region_id ON airports(region_id);
+CREATE INDEX IF NOT EXISTS idx_taxiway_signs_airport_icao ON taxiway_signs(airport_icao);
+CREATE INDEX IF NOT EXISTS idx_startup_locations_airport_icao ON startup_locations(airport_icao);
+CREATE INDEX IF NOT EXISTS idx_navaids_ident ON navaids(ident);
+CREATE INDEX IF NOT EXISTS idx_navaids_airport_icao ON navaids(airport_icao);
+CREATE INDEX IF NOT EXISTS idx_fixes_ident ON fixes(ident);
+CREATE INDEX IF NOT EXISTS idx_airway_segments_airway_name ON airway_segments(airway_name);
+CREATE INDEX IF NOT EXISTS idx_procedure_legs_airport_icao ON procedure_legs(airport_icao);
+CREATE INDEX IF NOT EXISTS idx_airport_records_airport_icao ON airport_records(airport_icao);
+CREATE INDEX IF NOT EXISTS idx_taxi_nodes_airport_icao ON taxi_nodes(airport_icao);
+CREATE INDEX IF NOT EXISTS idx_scenery_paths_scenery_path ON scenery_paths(scenery_path);
\ No newline at end of file
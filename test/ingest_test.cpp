@@ -0,0 +1,268 @@
+#include "gtest/gtest.h"
+#include "temp_install_test_base.h"
+#include <NavDataManager/NavDataManager.h>
+#include <NavDataManager/AirportQuery.h>
+#include <SQLiteCpp/Database.h>
+#include <filesystem>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Incremental ingests of a temp installation that the tests change between runs
+class IngestTest : public TempInstallTestBase {
+};
+
+TEST_F(IngestTest, ReturnsIngestSummary) {
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A") + airport("KBBB", "Global B"));
+    write_apt("Custom Scenery/C Pack", airport("KCCC", "Pack C"));
+
+    IngestSummary summary = ingest();
+    EXPECT_TRUE(summary.clean());
+    EXPECT_EQ(summary.files_parsed, 2u);
+    EXPECT_EQ(summary.files_skipped, 0u);
+    EXPECT_EQ(summary.airports_written, 3u);
+    EXPECT_EQ(summary.lines_parsed, 14u) << "Eight lines in Global Airports and six in the pack";
+
+    // Everything is in the database now, so a second run parses nothing
+    IngestSummary second = manager->parse_all_dat_files();
+    EXPECT_TRUE(second.clean());
+    EXPECT_EQ(second.files_parsed, 0u);
+    EXPECT_EQ(second.files_skipped, 2u);
+    EXPECT_EQ(second.airports_written, 0u);
+    EXPECT_EQ(second.lines_parsed, 0u);
+}
+
+TEST_F(IngestTest, LoadsEmptyDatabaseInBulk) {
+    // Enough airports for the page fill to mean something, a few dozen leave half of each table's last page empty
+    std::string airports;
+    for (int i = 0; i < 20000; ++i) {
+        airports += airport("X" + std::to_string(10000 + i), "Generated Field " + std::to_string(i));
+    }
+    write_apt(GLOBAL_AIRPORTS, airports);
+
+    NavDataManager& ndm = open();
+    auto pragma = [&ndm](const std::string& name) {
+        SQLite::Statement query(ndm.database(), "PRAGMA " + name);
+        return query.executeStep() ? query.getColumn(0).getString() : std::string();
+    };
+    const std::string synchronous = pragma("synchronous"), cache_size = pragma("cache_size");
+
+    IngestSummary summary = ndm.parse_all_dat_files();
+    EXPECT_TRUE(summary.bulk_load);
+    EXPECT_EQ(summary.airports_written, 20000u);
+    EXPECT_GT(summary.page_count, 0u);
+    // Written in key order, the pages are full enough to do without VACUUM (0 when SQLite has no dbstat to tell)
+    if (summary.fill_factor > 0.0) {
+        EXPECT_GT(summary.fill_factor, 0.9);
+        EXPECT_FALSE(summary.vacuumed);
+    }
+
+    // The relaxed settings are undone on the manager's connection
+    EXPECT_EQ(pragma("synchronous"), synchronous);
+    EXPECT_EQ(pragma("cache_size"), cache_size);
+    EXPECT_EQ(pragma("locking_mode"), "normal");
+
+    // The deferred indexes are built, and the database is not left locked to the manager's connection
+    SQLite::Database db(db_path.string(), SQLite::OPEN_READWRITE);
+    {
+        SQLite::Statement index(db, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name = 'idx_procedure_legs_airport_icao'");
+        ASSERT_TRUE(index.executeStep());
+        EXPECT_EQ(index.getColumn(0).getInt(), 1);
+    }
+    EXPECT_NO_THROW(db.exec("CREATE TABLE bulk_load_probe (id INTEGER); DROP TABLE bulk_load_probe;"));
+
+    EXPECT_FALSE(ndm.parse_all_dat_files(true).bulk_load);
+}
+
+TEST_F(IngestTest, FollowsChangedCopiedAndRemovedFiles) {
+    fs::path custom_apt = xp_root / "Custom Scenery" / "KBBB Custom" / "Earth nav data" / "apt.dat";
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A") + airport("KBBB", "Global B"));
+    write_apt("Custom Scenery/KBBB Custom", airport("KBBB", "Custom B"));
+
+    IngestSummary first = ingest();
+    EXPECT_EQ(first.files_parsed, 2u);
+    EXPECT_EQ(airport_name("KBBB"), "Custom B");
+
+    // Touching a file does not make it changed, editing it does
+    fs::last_write_time(custom_apt, fs::file_time_type::clock::now() + std::chrono::hours(1));
+    IngestSummary touched = ingest();
+    EXPECT_EQ(touched.files_parsed, 0u);
+    EXPECT_EQ(touched.files_skipped, 2u);
+
+    write_apt("Custom Scenery/KBBB Custom", airport("KBBB", "Edited B"));
+    IngestSummary edited = ingest();
+    EXPECT_EQ(edited.files_changed, 1u);
+    EXPECT_EQ(edited.files_parsed, 1u);
+    EXPECT_EQ(airport_name("KBBB"), "Edited B");
+
+    // An identical package is indexed from the one already parsed
+    fs::copy(xp_root / "Custom Scenery" / "KBBB Custom", xp_root / "Custom Scenery" / "KBBB Custom Copy", fs::copy_options::recursive);
+    IngestSummary copied = ingest();
+    EXPECT_EQ(copied.files_deduplicated, 1u);
+    EXPECT_EQ(copied.files_parsed, 0u);
+
+    // Without the overrides, Global Airports has KBBB again
+    fs::remove_all(xp_root / "Custom Scenery" / "KBBB Custom");
+    fs::remove_all(xp_root / "Custom Scenery" / "KBBB Custom Copy");
+    IngestSummary removed = ingest();
+    EXPECT_EQ(removed.files_removed, 2u);
+    EXPECT_EQ(airport_name("KBBB"), "Global B");
+}
+
+TEST_F(IngestTest, WalksOnlyChangedPackages) {
+    manifest_path = fs::temp_directory_path() / "ingest_test_scan_manifest.txt";
+    fs::remove(manifest_path);
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Scan Test"));
+    write_apt("Custom Scenery/KBBB Package", airport("KBBB", "Scan Test"));
+    fs::create_directories(xp_root / "Custom Scenery" / "KCCC Package" / "Earth nav data");
+
+    IngestSummary first = ingest();
+    EXPECT_EQ(first.packages_walked, 2u);
+    EXPECT_EQ(first.packages_cached, 0u);
+    EXPECT_EQ(airport_name("KCCC"), "");
+    EXPECT_TRUE(fs::exists(manifest_path));
+
+    IngestSummary unchanged = ingest();
+    EXPECT_EQ(unchanged.packages_walked, 0u);
+    EXPECT_EQ(unchanged.packages_cached, 2u);
+    EXPECT_EQ(unchanged.files_parsed, 0u);
+
+    // A file added to a subdirectory changes that directory's mtime
+    write_apt("Custom Scenery/KCCC Package", airport("KCCC", "Scan Test"));
+    IngestSummary added = ingest();
+    EXPECT_EQ(added.packages_walked, 1u);
+    EXPECT_EQ(added.packages_cached, 1u);
+    EXPECT_EQ(added.files_parsed, 1u);
+    EXPECT_EQ(airport_name("KCCC"), "Scan Test");
+}
+
+TEST_F(IngestTest, FollowsSceneryOrderAndSkipsDisabledPackages) {
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A"));
+    write_apt("Custom Scenery/A Pack", airport("KAAA", "Pack A"));
+    write_apt("Custom Scenery/B Pack", airport("KAAA", "Pack B"));
+    write_apt("Custom Scenery/C Pack", airport("KCCC", "Pack C"));
+    write_apt("Custom Scenery/zOrtho4XP_+40-075", airport("KZZZ", "Ortho Z"));
+    auto write_packs = [&](const std::string& packs) {
+        write_file("Custom Scenery/scenery_packs.ini", "I\n1000 Version\nSCENERY\n\n" + packs);
+    };
+
+    // The first pack listed wins, where name order would have let B Pack win. Excluded packs are not walked even when
+    // they are listed.
+    write_packs("SCENERY_PACK Custom Scenery/A Pack/\nSCENERY_PACK Custom Scenery/B Pack/\n"
+                "SCENERY_PACK_DISABLED Custom Scenery/C Pack/\nSCENERY_PACK Custom Scenery/zOrtho4XP_+40-075/\n"
+                "SCENERY_PACK *GLOBAL_AIRPORTS*\n");
+    IngestSummary first = ingest();
+    EXPECT_EQ(first.files_parsed, 3u);
+    EXPECT_EQ(first.packages_disabled, 1u);
+    EXPECT_EQ(first.packages_walked, 2u);
+    EXPECT_EQ(airport_name("KAAA"), "Pack A");
+    EXPECT_EQ(airport_name("KCCC"), "");
+    EXPECT_EQ(airport_name("KZZZ"), "");
+
+    // Reordering moves the airport without parsing anything
+    write_packs("SCENERY_PACK Custom Scenery/B Pack/\nSCENERY_PACK Custom Scenery/A Pack/\n"
+                "SCENERY_PACK_DISABLED Custom Scenery/C Pack/\nSCENERY_PACK *GLOBAL_AIRPORTS*\n");
+    IngestSummary reordered = ingest();
+    EXPECT_EQ(reordered.files_parsed, 0u);
+    EXPECT_EQ(airport_name("KAAA"), "Pack B");
+
+    // Packs below Global Airports lose to it, and disabling a pack retracts its airports
+    write_packs("SCENERY_PACK Custom Scenery/C Pack/\nSCENERY_PACK *GLOBAL_AIRPORTS*\n"
+                "SCENERY_PACK Custom Scenery/B Pack/\nSCENERY_PACK_DISABLED Custom Scenery/A Pack/\n");
+    IngestSummary global = ingest();
+    EXPECT_EQ(global.files_parsed, 1u);
+    EXPECT_EQ(global.files_removed, 1u);
+    EXPECT_EQ(airport_name("KAAA"), "Global A");
+    EXPECT_EQ(airport_name("KCCC"), "Pack C");
+}
+
+TEST_F(IngestTest, WritesOnlyTheWinningRecord) {
+    const std::string runway_11 = "100 45.72 1 0 0.25 0 2 1 11 40.69 -74.18 0 0 3 7 1 0 29 40.69 -74.16 0 0 3 10 1 0\n";
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A", std::string(RUNWAY) + runway_11));
+    write_apt("Custom Scenery/A Pack", airport("KAAA", "Pack A"));
+
+    // The override is written alone, none of the Global Airports runways are left behind
+    ingest();
+    EXPECT_EQ(manager->airport_data().get_runways_for_airport("KAAA").size(), 1u);
+
+    // An override installed later replaces what the earlier run stored
+    write_apt("Custom Scenery/B Pack", airport("KAAA", "Pack B", runway_11));
+    ingest();
+    EXPECT_EQ(manager->airport_data().get_runways_for_airport("KAAA").size(), 1u);
+    EXPECT_EQ(airport_name("KAAA"), "Pack B");
+}
+
+TEST_F(IngestTest, ReusesLocationsStoredByEarlierRuns) {
+    auto located_airport = [](const std::string& icao, const std::string& city) {
+        return airport(icao, "Test Field", "1302 country Testland\n1302 state North Province\n1302 city " + city + "\n"
+                                           "1302 region_code TL\n");
+    };
+    write_apt(GLOBAL_AIRPORTS, located_airport("KAAA", "Alpha"));
+    ingest();
+
+    // A new connection starts from the stored names, so the second run adds only the new city
+    write_apt("Custom Scenery/B Pack", located_airport("KBBB", "Alpha"));
+    write_apt("Custom Scenery/C Pack", located_airport("KCCC", "Beta"));
+    ingest();
+    manager.reset();
+
+    SQLite::Database db(db_path.string());
+    auto count = [&db](const std::string& table) {
+        SQLite::Statement query(db, "SELECT COUNT(*) FROM " + table);
+        return query.executeStep() ? query.getColumn(0).getInt() : -1;
+    };
+    EXPECT_EQ(count("countries"), 1);
+    EXPECT_EQ(count("regions"), 1);
+    EXPECT_EQ(count("states"), 1);
+    EXPECT_EQ(count("cities"), 2);
+    SQLite::Statement shared_city(db, "SELECT COUNT(DISTINCT city_id) FROM airports WHERE icao IN ('KAAA', 'KBBB')");
+    ASSERT_TRUE(shared_city.executeStep());
+    EXPECT_EQ(shared_city.getColumn(0).getInt(), 1);
+}
+
+TEST_F(IngestTest, ScanningAgainListsEachFileOnce) {
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A"));
+    write_apt("Custom Scenery/B Pack", airport("KBBB", "Pack B"));
+
+    // A file is never a duplicate of itself, however often the installation was scanned
+    NavDataManager& twice_scanned = open();
+    twice_scanned.scan_xp();
+    IngestSummary first = twice_scanned.parse_all_dat_files();
+    EXPECT_EQ(first.files_parsed, 2u);
+    EXPECT_EQ(first.files_deduplicated, 0u);
+    EXPECT_EQ(airport_name("KAAA"), "Global A");
+    EXPECT_EQ(airport_name("KBBB"), "Pack B");
+
+    IngestSummary second = ingest();
+    EXPECT_EQ(second.files_skipped, 2u);
+    EXPECT_EQ(airport_name("KBBB"), "Pack B");
+}
+
+TEST_F(IngestTest, ReparsesSingleAirportAndPackage) {
+    const std::string runway_11 = "100 45.72 1 0 0.25 0 2 1 11 40.69 -74.18 0 0 3 7 1 0 29 40.69 -74.16 0 0 3 10 1 0\n";
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A", std::string(RUNWAY) + runway_11) + airport("KBBB", "Global B"));
+    write_apt("Custom Scenery/KAAA Custom", airport("KAAA", "Custom A"));
+    ingest();
+    ASSERT_EQ(airport_name("KAAA"), "Custom A");
+
+    // KAAA is overridden by custom scenery, so that is the record read again
+    write_apt("Custom Scenery/KAAA Custom", airport("KAAA", "Edited A", std::string(RUNWAY) + runway_11));
+    IngestSummary summary = manager->reparse_airport("KAAA");
+    EXPECT_TRUE(summary.clean());
+    EXPECT_EQ(summary.files_parsed, 1u);
+    EXPECT_EQ(summary.airports_written, 1u);
+    EXPECT_EQ(airport_name("KAAA"), "Edited A");
+    EXPECT_EQ(manager->airport_data().get_runways_for_airport("KAAA").size(), 2u);
+    EXPECT_EQ(airport_name("KBBB"), "Global B");
+
+    write_apt("Custom Scenery/KAAA Custom", airport("KAAA", "Package A"));
+    IngestSummary package = manager->reparse_package((xp_root / "Custom Scenery" / "KAAA Custom").string());
+    EXPECT_EQ(package.airports_written, 1u);
+    EXPECT_EQ(airport_name("KAAA"), "Package A");
+    EXPECT_EQ(manager->airport_data().get_runways_for_airport("KAAA").size(), 1u);
+
+    EXPECT_THROW(manager->reparse_airport("ZZZZ"), std::invalid_argument);
+    EXPECT_THROW(manager->reparse_package((xp_root / "Custom Scenery" / "No Such Package").string()), std::invalid_argument);
+}
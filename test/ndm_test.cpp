@@ -1,9 +1,14 @@
 #include "gtest/gtest.h"
+#include "temp_install_test_base.h"
 #include <NavDataManager/NavDataManager.h>
 #include <NavDataManager/AirportQuery.h>
+#include <NavDataManager/IngestObserver.h>
 #include <filesystem>
 #include <SQLiteCpp/Exception.h>
 #include <ctime>
+#include <map>
+#include <vector>
+#include <memory>
 
 class NavDataManagerTest: public ::testing::Test {
     protected:
@@ -49,4 +54,66 @@ TEST_F(NavDataManagerTest, DatabaseConnectionAndCreation) {
     
     EXPECT_TRUE(std::filesystem::exists(temp_db_path));
     EXPECT_GT(std::filesystem::file_size(temp_db_path), 0);
-}
\ No newline at end of file
+}
+
+namespace {
+    class RecordingObserver : public IngestObserver {
+        public:
+            void on_progress(const IngestProgress& progress) override { samples.push_back(progress); }
+            std::vector<IngestProgress> samples;
+    };
+}
+
+// Ingests of two small packages written by the test
+class IngestObserverTest : public TempInstallTestBase {
+};
+
+TEST_F(IngestObserverTest, ReceivesProgress) {
+    write_apt(GLOBAL_AIRPORTS, airport("KAAA", "Global A") + airport("KBBB", "Global B"));
+    write_apt("Custom Scenery/C Pack", airport("KCCC", "Pack C"));
+    const std::filesystem::path global_apt = xp_root / GLOBAL_AIRPORTS / "Earth nav data" / "apt.dat";
+    const std::filesystem::path custom_apt = xp_root / "Custom Scenery" / "C Pack" / "Earth nav data" / "apt.dat";
+    const uint64_t bytes_total = std::filesystem::file_size(global_apt) + std::filesystem::file_size(custom_apt);
+
+    NavDataManager& ndm = open();
+    auto observer = std::make_shared<RecordingObserver>();
+    ndm.set_ingest_observer(observer);
+    ndm.parse_all_dat_files();
+
+    const auto& samples = observer->samples;
+    ASSERT_FALSE(samples.empty());
+    EXPECT_EQ(samples.front().stage, IngestStage::Scanning);
+    EXPECT_EQ(samples.back().stage, IngestStage::Completed);
+
+    // Counters only move forward
+    for (size_t i = 1; i < samples.size(); ++i) {
+        EXPECT_GE(samples[i].stage, samples[i - 1].stage);
+        EXPECT_GE(samples[i].bytes_parsed, samples[i - 1].bytes_parsed);
+        EXPECT_GE(samples[i].airports_written, samples[i - 1].airports_written);
+        EXPECT_GE(samples[i].files_completed, samples[i - 1].files_completed);
+    }
+
+    // Two airports are too few for a sample inside a file, so there is one sample per file written
+    std::vector<IngestProgress> per_file;
+    for (const IngestProgress& sample : samples) {
+        EXPECT_EQ(sample.files_total, 2u);
+        if (sample.stage == IngestStage::Ingesting) per_file.push_back(sample);
+    }
+    ASSERT_EQ(per_file.size(), 2u);
+    std::map<std::string, uint64_t> airports_by_file = {{global_apt.string(), 2}, {custom_apt.string(), 1}};
+    uint64_t airports_written = 0;
+    for (size_t i = 0; i < per_file.size(); ++i) {
+        ASSERT_EQ(airports_by_file.count(per_file[i].current_file), 1u) << per_file[i].current_file;
+        airports_written += airports_by_file[per_file[i].current_file];
+        EXPECT_EQ(per_file[i].files_completed, i + 1);
+        EXPECT_EQ(per_file[i].airports_written, airports_written);
+        EXPECT_EQ(per_file[i].bytes_total, bytes_total);
+    }
+    EXPECT_NE(per_file[0].current_file, per_file[1].current_file);
+
+    const IngestProgress& last = samples.back();
+    EXPECT_EQ(last.files_completed, 2u);
+    EXPECT_EQ(last.airports_written, 3u);
+    EXPECT_EQ(last.bytes_parsed, bytes_total);
+    EXPECT_EQ(last.lines_parsed, 14u) << "Eight lines in Global Airports and six in the pack";
+}
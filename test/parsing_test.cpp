@@ -1,8 +1,18 @@
 #include "gtest/gtest.h"
 #include <NavDataManager/NavDataManager.h>
 #include <NavDataManager/AirportQuery.h>
+#include "XPlaneDatParser.h"
+#include <SQLiteCpp/Database.h>
 #include <filesystem>
 #include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#ifdef NAVDATA_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 class ParsingTest : public ::testing::Test {
 protected:
@@ -60,4 +70,369 @@ TEST_F(ParsingTest, ParsedDataIsAccurate) {
     // Test runway data
     auto runways = manager->airport_data().get_runways_for_airport("KEWR");
     EXPECT_GE(runways.size(), 2) << "KEWR should have multiple runways";
-}
\ No newline at end of file
+}
+
+TEST(ParserRecordsTest, ParsesSignsAndStartupLocations) {
+    auto apt_path = std::filesystem::temp_directory_path() / "parser_records_test_signs_apt.dat";
+    {
+        std::ofstream output(apt_path);
+        output << "I\n"
+               << "1200 Version - data cycle 2024.01\n"
+               << "\n"
+               << "1     17 0 0 KAAA First\n"
+               << "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n"
+               << "20 40.68100000 -74.17000000 45.00 0 2 {@Y}A{@R}04-22 TAXI TO RAMP\n"
+               << "1300 40.68200000 -74.17100000 180.00 gate jets|turboprops A 12\n"
+               << "1301 E airline ual\n"
+               << "15 40.68300000 -74.17200000 90.50 Ramp Start 1\n"
+               << "1     17 0 0 KBBB Second\n"
+               << "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n"
+               << "20 40.69000000 -74.18000000 270.50 0 3 {@L}B\n"
+               << "1300 40.69100000 -74.18100000 10.00 tie_down props\n"
+               << "99\n";
+    }
+
+    XPlaneDatParser parser(false, 1);
+    ParsedAptData data = parser.parse_airport_dat(apt_path);
+
+    // The sign text runs from the sixth field to the end of the line
+    const TaxiwaySignColumns& signs = data.taxiway_signs;
+    ASSERT_EQ(signs.size(), 2u);
+    EXPECT_EQ(data.airport_ids[signs.airport[0]], "KAAA");
+    EXPECT_DOUBLE_EQ(signs.latitude[0], 40.681);
+    EXPECT_DOUBLE_EQ(signs.longitude[0], -74.17);
+    EXPECT_DOUBLE_EQ(signs.heading[0], 45.0);
+    EXPECT_EQ(signs.size_class[0], 2);
+    EXPECT_EQ(signs.sign_text.view(0), "{@Y}A{@R}04-22 TAXI TO RAMP");
+    EXPECT_EQ(data.airport_ids[signs.airport[1]], "KBBB");
+    EXPECT_DOUBLE_EQ(signs.heading[1], 270.5);
+    EXPECT_EQ(signs.size_class[1], 3);
+    EXPECT_EQ(signs.sign_text.view(1), "{@L}B");
+
+    // The 1301 line after a 1300 adds no location of its own
+    const StartupLocationColumns& locations = data.startup_locations;
+    ASSERT_EQ(locations.size(), 3u);
+    EXPECT_EQ(data.airport_ids[locations.airport[0]], "KAAA");
+    EXPECT_DOUBLE_EQ(locations.latitude[0], 40.682);
+    EXPECT_DOUBLE_EQ(locations.heading[0], 180.0);
+    EXPECT_EQ(locations.location_type.view(0), "gate");
+    EXPECT_EQ(locations.ramp_name.view(0), "A 12") << "The aircraft types are not part of the name";
+
+    // Legacy row 15 has no location type, its name follows the heading
+    EXPECT_EQ(data.airport_ids[locations.airport[1]], "KAAA");
+    EXPECT_DOUBLE_EQ(locations.heading[1], 90.5);
+    EXPECT_FALSE(locations.location_type.has_value(1));
+    EXPECT_EQ(locations.ramp_name.view(1), "Ramp Start 1");
+
+    EXPECT_EQ(data.airport_ids[locations.airport[2]], "KBBB");
+    EXPECT_EQ(locations.location_type.view(2), "tie_down");
+    EXPECT_FALSE(locations.ramp_name.has_value(2)) << "A 1300 line may leave out the name";
+
+    std::filesystem::remove(apt_path);
+}
+
+TEST(ParserRecordsTest, ParsesNavaids) {
+    auto nav_path = std::filesystem::temp_directory_path() / "parser_records_test_earth_nav.dat";
+    {
+        std::ofstream output(nav_path);
+        output << "I\n"
+               << "1200 Version - data cycle 2401, metadata NavXP1200.\n"
+               << "\n"
+               << " 2  47.63252778 -122.38952778      0   362  50       0.000 BF   ENRT K1 NOLLA/KBFI LMM NDB\n"
+               << " 3  47.43538889 -122.30961111    354 11680 130      19.000 SEA  ENRT K1 SEATTLE VORTAC\n"
+               << " 4  47.42939200 -122.30805600    338 11030  18     180.343 ISNQ KSEA K1 16L ILS-cat-III\n"
+               << " 6  47.46081700 -122.30939400    425 11030  10  300180.343 ISNQ KSEA K1 16L GS\n"
+               << "99\n"
+               << " 3  0.0 0.0 0 11000 10 0.0 XXX ENRT K1 AFTER END\n";
+    }
+
+    XPlaneDatParser parser(false, 1);
+    ParsedNavData data = parser.parse_nav_dat(nav_path);
+    const NavaidColumns& navaids = data.navaids;
+    ASSERT_EQ(navaids.size(), 4u);
+
+    EXPECT_EQ(navaids.navaid_type.view(0), "NDB");
+    EXPECT_EQ(navaids.ident.view(0), "BF");
+    EXPECT_EQ(navaids.name.view(0), "NOLLA/KBFI LMM NDB");
+    EXPECT_FALSE(navaids.airport_icao.has_value(0)) << "ENRT navaids have no airport";
+
+    EXPECT_EQ(navaids.navaid_type.view(1), "VOR");
+    EXPECT_EQ(navaids.frequency[1], 11680);
+    EXPECT_DOUBLE_EQ(navaids.bearing[1], 19.0);
+    EXPECT_FALSE(navaids.glideslope_angle.has_value(1));
+
+    EXPECT_EQ(navaids.navaid_type.view(2), "ILS");
+    EXPECT_EQ(navaids.airport_icao.view(2), "KSEA");
+    EXPECT_EQ(navaids.icao_region.view(2), "K1");
+
+    // The glideslope angle is split off the bearing field
+    EXPECT_EQ(navaids.navaid_type.view(3), "GS");
+    ASSERT_TRUE(navaids.glideslope_angle.has_value(3));
+    EXPECT_DOUBLE_EQ(navaids.glideslope_angle[3], 3.0);
+    EXPECT_NEAR(navaids.bearing[3], 180.343, 1e-6);
+
+    std::filesystem::remove(nav_path);
+}
+
+TEST(ParserRecordsTest, ParsesFixesAndAirways) {
+    auto fix_path = std::filesystem::temp_directory_path() / "parser_records_test_earth_fix.dat";
+    auto awy_path = std::filesystem::temp_directory_path() / "parser_records_test_earth_awy.dat";
+    {
+        std::ofstream output(fix_path);
+        output << "I\n"
+               << "1101 Version - data cycle 2401, metadata FixXP1101.\n"
+               << "\n"
+               << " 47.54111111 -122.63750000 ALKIA ENRT K1 2105430\n"
+               << " 47.40250000 -122.31000000 RW16L KSEA K1\n"
+               << "99\n";
+    }
+    {
+        std::ofstream output(awy_path);
+        output << "I\n"
+               << "1100 Version - data cycle 2401, metadata AwyXP1100.\n"
+               << "\n"
+               << "ALKIA K1 11 SEA   K1  3 N 1 18 180 V4-V204\n"
+               << "SEA   K1  3 BTG   K1  3 F 2 180 450 J5\n"
+               << "99\n";
+    }
+
+    XPlaneDatParser parser(false, 1);
+    ParsedNavData fix_data = parser.parse_fix_dat(fix_path);
+    const FixColumns& fixes = fix_data.fixes;
+    ASSERT_EQ(fixes.size(), 2u);
+    EXPECT_EQ(fixes.ident.view(0), "ALKIA");
+    EXPECT_FALSE(fixes.airport_icao.has_value(0)) << "ENRT fixes have no airport";
+    EXPECT_EQ(fixes.waypoint_type[0], 2105430);
+    EXPECT_EQ(fixes.airport_icao.view(1), "KSEA");
+    EXPECT_FALSE(fixes.waypoint_type.has_value(1)) << "The waypoint type is optional";
+
+    // A segment shared by several airways gives one row per airway
+    ParsedNavData awy_data = parser.parse_awy_dat(awy_path);
+    const AirwaySegmentColumns& segments = awy_data.airway_segments;
+    ASSERT_EQ(segments.size(), 3u);
+    EXPECT_EQ(segments.airway_name.view(0), "V4");
+    EXPECT_EQ(segments.airway_name.view(1), "V204");
+    EXPECT_EQ(segments.to_ident.view(1), "SEA");
+    EXPECT_EQ(segments.to_type[1], 3);
+    EXPECT_EQ(segments.direction.view(2), "F");
+    EXPECT_EQ(segments.airway_level[2], 2);
+    EXPECT_EQ(segments.top_fl[2], 450);
+
+    std::filesystem::remove(fix_path);
+    std::filesystem::remove(awy_path);
+}
+
+TEST(ParserRecordsTest, ParsesCifpProcedures) {
+    auto cifp_path = std::filesystem::temp_directory_path() / "KSEA.dat";
+    {
+        std::ofstream output(cifp_path);
+        output << "RWY:RW16L,     ,     ,00432, ,ISNQ,3,   ;N47274937,W122182023,0000;\n"
+               << "SID:010,5,BANGR9,RW16L,,,,,,,,VA,0,,,,,,,1614,,,,,+,00800,,,,,,,,,,,,,;\n"
+               << "SID:020,5,BANGR9,RW16L,SEA,K1,D,,VE  ,R,,DF,0,,,,,,,,,,,,,,,,,,,,,,,,,;\n"
+               << "APPCH:010,I,I16L,,ZOMBI,K1,P,C,E  F,,,IF,,ISNQ,K1,P,I,,,,,,,,,,,,,,,,,,,,;\n"
+               << "PRDAT:010,00000,00000,0000,0000,00000,000000,00000000,000000,00,  ,  ,,,,,;\n";
+    }
+
+    XPlaneDatParser parser(false, 1);
+    ParsedNavData data = parser.parse_cifp_dat(cifp_path);
+    const ProcedureLegColumns& legs = data.procedure_legs;
+    ASSERT_EQ(legs.size(), 3u) << "RWY and PRDAT records are not procedure legs";
+
+    EXPECT_EQ(legs.airport_icao.view(0), "KSEA") << "The airport comes from the file name";
+    EXPECT_EQ(legs.procedure_type.view(0), "SID");
+    EXPECT_EQ(legs.procedure_ident.view(0), "BANGR9");
+    EXPECT_EQ(legs.transition_ident.view(0), "RW16L");
+    EXPECT_EQ(legs.path_terminator.view(0), "VA");
+    EXPECT_FALSE(legs.fix_ident.has_value(0)) << "A heading leg ends at an altitude, not a fix";
+
+    EXPECT_EQ(legs.sequence[1], 20);
+    EXPECT_EQ(legs.fix_ident.view(1), "SEA");
+    EXPECT_EQ(legs.description_code.view(1), "VE") << "Field padding is trimmed";
+    EXPECT_EQ(legs.turn_direction.view(1), "R");
+
+    EXPECT_EQ(legs.procedure_type.view(2), "APPCH");
+    EXPECT_FALSE(legs.transition_ident.has_value(2)) << "The common route has no transition";
+    EXPECT_EQ(legs.recommended_navaid.view(2), "ISNQ");
+
+    std::filesystem::remove(cifp_path);
+}
+
+TEST(ParserRecordsTest, LenientParsingSkipsBadAirport) {
+    auto apt_path = std::filesystem::temp_directory_path() / "lenient_parsing_test_apt.dat";
+    {
+        std::ofstream output(apt_path);
+        output << "I\n"
+               << "1200 Version - data cycle 2024.01\n"
+               << "\n"
+               << "1     17 0 0 KAAA First\n"
+               << "1302 icao_code KAAA\n"
+               << "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n"
+               << "1     17 0 0 KBBB Broken\n"
+               << "1302 icao_code KBBB\n"
+               << "100 wide 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n"
+               << "100 45.72 1 0 0.25 0 2 1 09 40.68 -74.17 0 0 3 7 1 0 27 40.70 -74.15 0 0 3 10 1 0\n"
+               << "1     17 0 0 KCCC Third\n"
+               << "1302 icao_code KCCC\n"
+               << "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n"
+               << "99\n";
+    }
+
+    XPlaneDatParser strict_parser(false, 1);
+    EXPECT_THROW(strict_parser.parse_airport_dat(apt_path), std::runtime_error);
+
+    // The bad runway drops all of KBBB, the airports around it are kept
+    XPlaneDatParser parser(false, 1);
+    parser.set_lenient(true);
+    ParsedAptData data = parser.parse_airport_dat(apt_path);
+    ASSERT_EQ(data.airports.size(), 2u);
+    EXPECT_EQ(data.airports.icao.view(0), "KAAA");
+    EXPECT_EQ(data.airports.icao.view(1), "KCCC");
+    EXPECT_EQ(data.runways.size(), 2u);
+
+    std::vector<IngestDiagnostic> diagnostics = parser.take_diagnostics();
+    ASSERT_EQ(diagnostics.size(), 1u);
+    EXPECT_EQ(diagnostics[0].file, apt_path.string());
+    EXPECT_EQ(diagnostics[0].line, 9);
+    EXPECT_EQ(diagnostics[0].row_code, 100);
+    EXPECT_FALSE(diagnostics[0].reason.empty());
+    EXPECT_TRUE(parser.take_diagnostics().empty());
+
+    std::filesystem::remove(apt_path);
+}
+
+TEST(ParserRecordsTest, IndexesAirportRecords) {
+    auto apt_path = std::filesystem::temp_directory_path() / "record_index_test_apt.dat";
+    const std::string header = "I\n1200 Version - data cycle 2024.01\n\n";
+    const std::string first = "1     17 0 0 KAAA First\n"
+                              "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n";
+    const std::string second = "1     17 0 0 KBBB Second\n"
+                               "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n"
+                               "100 45.72 1 0 0.25 0 2 1 09 40.68 -74.17 0 0 3 7 1 0 27 40.70 -74.15 0 0 3 10 1 0\n";
+    auto write_apt = [&](const std::string& first_airport) {
+        std::ofstream output(apt_path, std::ios::binary);
+        output << header << first_airport << second << "99\n";
+    };
+    write_apt(first);
+
+    XPlaneDatParser parser(false, 1);
+    ParsedAptData data = parser.parse_airport_dat(apt_path);
+    ASSERT_EQ(data.airports.size(), 2u);
+    AptRecordSpan span = data.airports.record[1];
+    EXPECT_EQ(span.offset, header.size() + first.size());
+    EXPECT_EQ(span.length, second.size() + 3);      // The last airport runs to the end of the file
+    EXPECT_EQ(span.first_line, 6);
+
+    // Only KBBB is parsed, from its offset
+    std::vector<ParsedAptData> batches;
+    auto collect = [&batches](ParsedAptData&& batch) { batches.push_back(std::move(batch)); };
+    ASSERT_TRUE(parser.parse_airport_record(apt_path, span, collect));
+    ASSERT_EQ(batches.size(), 1u);
+    ASSERT_EQ(batches[0].airports.size(), 1u);
+    EXPECT_EQ(batches[0].airports.icao.view(0), "KBBB");
+    EXPECT_EQ(batches[0].runways.size(), 2u);
+
+    // Once the record has moved there is no airport header at the offset any more
+    write_apt(first + "1302 city Somewhere\n");
+    batches.clear();
+    EXPECT_FALSE(parser.parse_airport_record(apt_path, span, collect));
+    EXPECT_TRUE(batches.empty());
+
+    std::filesystem::remove(apt_path);
+}
+
+#ifdef NAVDATA_HAVE_ZLIB
+namespace {
+    // Writes the contents as two concatenated gzip members, as produced by appending to an archive
+    void write_gzip(const std::filesystem::path& path, const std::string& contents) {
+        size_t half = contents.size() / 2;
+        gzFile first = gzopen(path.string().c_str(), "wb");
+        ASSERT_NE(first, nullptr);
+        gzwrite(first, contents.data(), static_cast<unsigned>(half));
+        gzclose(first);
+        gzFile second = gzopen(path.string().c_str(), "ab");
+        ASSERT_NE(second, nullptr);
+        gzwrite(second, contents.data() + half, static_cast<unsigned>(contents.size() - half));
+        gzclose(second);
+    }
+
+    // An apt.dat of airports with runways, taxi routes, linear features, signs and startup locations, at positions
+    // that differ from airport to airport so that it does not compress to nothing
+    std::string generated_apt_dat(int airport_count) {
+        std::ostringstream output;
+        output << "I\n1200 Version - data cycle 2024.01\n\n" << std::fixed << std::setprecision(8);
+        for (int i = 0; i < airport_count; ++i) {
+            std::string icao = "X" + std::to_string(1000 + i);
+            double lat = -60.0 + i * 0.37, lon = -170.0 + i * 1.13;
+            output << "1 " << i % 900 << " 0 0 " << icao << " Generated Field " << i << "\n"
+                   << "1302 icao_code " << icao << "\n"
+                   << "100 45.72 1 0 0.25 0 2 1 04 " << lat << " " << lon << " 0 0 3 7 1 0 22 " << lat + 0.01 << " "
+                   << lon + 0.01 << " 0 0 3 10 1 0\n"
+                   << "20 " << lat + 0.001 << " " << lon << " " << (i * 7) % 360 << " 0 2 {@Y}A{@R}04-22\n"
+                   << "1300 " << lat + 0.002 << " " << lon << " " << (i * 11) % 360 << " gate jets A" << i % 40 << "\n"
+                   << "120 Line " << i << "\n"
+                   << "111 " << lat + 0.0002 << " " << lon << " 1\n"
+                   << "115 " << lat + 0.0004 << " " << lon << "\n"
+                   << "1200\n";
+            for (int node = 0; node < 8; ++node) {
+                output << "1201 " << lat + node * 0.00013 << " " << lon - node * 0.00017 << " both " << node << " A" << node << "\n";
+            }
+            for (int node = 0; node < 7; ++node) {
+                output << "1202 " << node << " " << node + 1 << " twoway taxiway_A A\n";
+            }
+        }
+        output << "99\n";
+        return output.str();
+    }
+}
+
+TEST(CompressedInputTest, GzipParsesLikePlainText) {
+    const std::string contents = generated_apt_dat(300);
+    auto plain_path = std::filesystem::temp_directory_path() / "compressed_input_test_apt.dat";
+    auto gz_path = std::filesystem::temp_directory_path() / "compressed_input_test_apt.dat.gz";
+    std::ofstream(plain_path, std::ios::binary) << contents;
+    write_gzip(gz_path, contents);
+
+    XPlaneDatParser plain_parser(false, 1), gzip_parser(false, 1);
+    ParsedAptData plain = plain_parser.parse_airport_dat(plain_path);
+    ParsedAptData gzip = gzip_parser.parse_airport_dat(gz_path);
+
+    ASSERT_EQ(plain.airports.size(), 300u);
+    ASSERT_EQ(gzip.airports.size(), plain.airports.size());
+    for (size_t row = 0; row < plain.airports.size(); ++row) {
+        EXPECT_EQ(gzip.airports.icao.get(row), plain.airports.icao.get(row));
+    }
+    EXPECT_EQ(gzip.runways.size(), plain.runways.size());
+    EXPECT_EQ(gzip.taxiway_nodes.size(), 2400u);
+    EXPECT_EQ(gzip.taxiway_nodes.size(), plain.taxiway_nodes.size());
+    EXPECT_EQ(gzip.taxiway_edges.size(), plain.taxiway_edges.size());
+    EXPECT_EQ(gzip.linear_features.size(), plain.linear_features.size());
+    EXPECT_EQ(gzip.linear_feature_nodes.size(), plain.linear_feature_nodes.size());
+    EXPECT_EQ(gzip.taxiway_signs.size(), plain.taxiway_signs.size());
+    EXPECT_EQ(gzip.startup_locations.size(), plain.startup_locations.size());
+    EXPECT_EQ(gzip_parser.lines_parsed(), plain_parser.lines_parsed());
+    // Progress of compressed input is measured against the file on disk
+    EXPECT_EQ(gzip_parser.bytes_parsed(), std::filesystem::file_size(gz_path));
+
+    std::filesystem::remove(plain_path);
+    std::filesystem::remove(gz_path);
+}
+
+TEST(CompressedInputTest, TruncatedGzipThrows) {
+    auto gz_path = std::filesystem::temp_directory_path() / "truncated_input_test_apt.dat.gz";
+    write_gzip(gz_path, generated_apt_dat(300));
+    // Cut off the trailer and the end of the second member's deflate data
+    uintmax_t gz_size = std::filesystem::file_size(gz_path);
+    ASSERT_GT(gz_size, 1000u);
+    std::filesystem::resize_file(gz_path, gz_size - 100);
+
+    XPlaneDatParser parser(false, 1);
+    try {
+        parser.parse_airport_dat(gz_path);
+        ADD_FAILURE() << "A truncated gzip file should not parse";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("Unexpected end of gzip data"), std::string::npos) << e.what();
+    }
+
+    std::filesystem::remove(gz_path);
+}
+#endif
@@ -1,10 +1,23 @@
 #include "gtest/gtest.h"
 #include "simple_test_base.h"
+#include "temp_install_test_base.h"
 #include <NavDataManager/NavDataManager.h>
 #include <NavDataManager/AirportQuery.h>
+#include <NavDataManager/NavaidQuery.h>
+#include <NavDataManager/AirwayRouter.h>
+#include "LookaheadLineReader.h"
+#include "FieldDecoder.h"
+#include "XPlaneDatParser.h"
+#include <fstream>
+#include <algorithm>
+#include <iterator>
 #include <filesystem>
 #include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 class PerformanceTest : public SimpleTestBase {
 };
@@ -66,6 +79,90 @@ TEST_F(PerformanceTest, QueryPerformance) {
     EXPECT_LT(duration.count(), 1000) << "100 queries should complete within 1 second";
 }
 
+// Ident lookups use idx_navaids_ident and radius lookups the navaids_rtree spatial index, so each should take
+// microseconds rather than a scan of the table
+TEST_F(PerformanceTest, NavaidLookupPerformance) {
+    const int iterations = 1000;
+    size_t found = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        found += manager->navaid_data().get_by_ident("JFK").size();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        found += manager->navaid_data().get_near(40.6925, -74.1687, 50.0).size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    auto per_query_us = [iterations](std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count() / iterations;
+    };
+    std::cout << "Navaid lookup by ident: " << per_query_us(middle - start) << " us/query" << std::endl;
+    std::cout << "Navaid lookup by radius: " << per_query_us(end - middle) << " us/query" << std::endl;
+
+    EXPECT_GT(found, 0u);
+    EXPECT_LT(per_query_us(middle - start), 1000.0) << "Ident lookups should take well under a millisecond";
+    EXPECT_LT(per_query_us(end - middle), 1000.0) << "Radius lookups should take well under a millisecond";
+}
+
+// A worldwide grid of airways 1.5 degrees apart, some 21000 points, in a temp installation with KJFK and EGLL. Rows
+// alternate between low and high airways, and so do columns.
+class AirwayRoutePerformanceTest : public TempInstallTestBase {
+protected:
+    void SetUp() override {
+        TempInstallTestBase::SetUp();
+        write_apt(GLOBAL_AIRPORTS, located_airport("KJFK", "John F Kennedy Intl", "40.639751", "-73.778925") +
+                                   located_airport("EGLL", "London Heathrow", "51.470600", "-0.461941"));
+
+        const int rows = 87, columns = 240;
+        auto point = [](int row, int column) {
+            std::string name = "Q";
+            for (int i = 0, index = row * columns + column; i < 4; ++i, index /= 26) name += static_cast<char>('A' + index % 26);
+            return name;
+        };
+        std::ostringstream fixes, airways;
+        fixes << "I\n1101 Version - data cycle 2401, metadata FixXP1101.\n\n" << std::fixed << std::setprecision(8);
+        airways << "I\n1100 Version - data cycle 2401, metadata AwyXP1100.\n\n";
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                fixes << -60.0 + 1.5 * row << " " << -180.0 + 1.5 * column << " " << point(row, column) << " ENRT ZZ\n";
+                airways << point(row, column) << " ZZ 11 " << point(row, (column + 1) % columns) << " ZZ 11 N "
+                        << (row % 2 ? 1 : 2) << "  50 450 W" << row << "\n";
+                if (row + 1 < rows) {
+                    airways << point(row, column) << " ZZ 11 " << point(row + 1, column) << " ZZ 11 N "
+                            << (column % 2 ? 2 : 1) << "  50 450 N" << column << "\n";
+                }
+            }
+        }
+        fixes << "99\n";
+        airways << "99\n";
+        write_file("Resources/default data/earth_fix.dat", fixes.str());
+        write_file("Resources/default data/earth_awy.dat", airways.str());
+        ingest();
+    }
+};
+
+// The airway graph is loaded once, after which a route is an A* search over the in-memory adjacency arrays
+TEST_F(AirwayRoutePerformanceTest, AirwayRoutePerformance) {
+    AirwayRouter& router = manager->airway_routing();
+    router.node_count();
+    const int iterations = 100;
+    size_t found = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        found += router.find_route("KJFK", "EGLL").has_value();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double per_route_us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    std::cout << "Airway route KJFK -> EGLL: " << per_route_us << " us/query" << std::endl;
+
+    EXPECT_EQ(found, static_cast<size_t>(iterations));
+    EXPECT_LT(per_route_us, 1000.0) << "Route queries should take under a millisecond";
+}
+
 TEST_F(PerformanceTest, MemoryUsage) {
     
     // Perform many queries to check for memory leaks
@@ -79,4 +176,84 @@ TEST_F(PerformanceTest, MemoryUsage) {
     
     // If we get here without crashing, memory management is likely OK
     SUCCEED() << "Memory test completed without issues";
-}
\ No newline at end of file
+}
+
+// Compares the old std::stod(std::string(token)) decoding against the from_chars based decoder on every
+// coordinate of the global apt.dat (taxi nodes and linear feature nodes make up the bulk of the file).
+TEST(DecodingBenchmark, CoordinateDecodingThroughput) {
+    const std::filesystem::path global_apt_dat = "C:/X-Plane 12/Global Scenery/Global Airports/Earth nav data/apt.dat";
+    ASSERT_TRUE(std::filesystem::exists(global_apt_dat));
+
+    LookaheadLineReader reader(global_apt_dat);
+    std::vector<std::string_view> tokens;
+    std::vector<std::string_view> batch;
+    const size_t batch_size = 1 << 20;
+    batch.reserve(batch_size);
+
+    size_t field_count = 0, field_bytes = 0;
+    double stod_sum = 0.0, from_chars_sum = 0.0;
+    std::chrono::nanoseconds stod_time{0}, from_chars_time{0};
+
+    auto run_batch = [&]() {
+        auto start = std::chrono::steady_clock::now();
+        for (auto field : batch) {
+            stod_sum += std::stod(std::string(field));
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (auto field : batch) {
+            double value = 0.0;
+            decode_double(field, value);
+            from_chars_sum += value;
+        }
+        auto end = std::chrono::steady_clock::now();
+        stod_time += middle - start;
+        from_chars_time += end - middle;
+        field_count += batch.size();
+        batch.clear();
+    };
+
+    while (reader.get_next_line()) {
+        int row_code = reader.get_row_code();
+        if (row_code != 1201 && (row_code < 111 || row_code > 116)) continue;
+        reader.get_line_tokens(tokens);
+        if (tokens.size() < 3) continue;
+        batch.push_back(tokens[1]);
+        batch.push_back(tokens[2]);
+        field_bytes += tokens[1].size() + tokens[2].size();
+        if (batch.size() >= batch_size) run_batch();
+    }
+    run_batch();
+
+    auto to_ms = [](std::chrono::nanoseconds ns) { return std::chrono::duration<double, std::milli>(ns).count(); };
+    double megabytes = static_cast<double>(field_bytes) / (1024.0 * 1024.0);
+    std::cout << "Decoded " << field_count << " coordinates (" << megabytes << " MB)" << std::endl;
+    std::cout << "  std::stod:       " << to_ms(stod_time) << " ms (" << megabytes / (to_ms(stod_time) / 1000.0) << " MB/s)" << std::endl;
+    std::cout << "  std::from_chars: " << to_ms(from_chars_time) << " ms (" << megabytes / (to_ms(from_chars_time) / 1000.0) << " MB/s)" << std::endl;
+
+    ASSERT_GT(field_count, 0u);
+    EXPECT_DOUBLE_EQ(stod_sum, from_chars_sum) << "Both decoders should produce identical values";
+    EXPECT_LT(from_chars_time.count(), stod_time.count()) << "from_chars decoding should be faster than std::stod";
+}
+
+// Serial parse rate of the global apt.dat. Every input line is read once by the parser, so lines_parsed() must match
+// the line count of the file.
+TEST(ParserBenchmark, LinesPerSecond) {
+    const std::filesystem::path global_apt_dat = "C:/X-Plane 12/Global Scenery/Global Airports/Earth nav data/apt.dat";
+    ASSERT_TRUE(std::filesystem::exists(global_apt_dat));
+
+    std::ifstream input(global_apt_dat, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    uint64_t file_lines = std::count(contents.begin(), contents.end(), '\n');
+
+    XPlaneDatParser parser(false, 1);
+    size_t airports = 0;
+    auto start = std::chrono::steady_clock::now();
+    parser.parse_airport_dat(global_apt_dat, [&airports](ParsedAptData&& batch) { airports += batch.airports.size(); });
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Parsed " << parser.lines_parsed() << " lines (" << airports << " airports) in " << elapsed * 1000.0
+              << " ms (" << parser.lines_parsed() / elapsed << " lines/sec)" << std::endl;
+
+    EXPECT_GT(airports, 0u);
+    EXPECT_EQ(parser.lines_parsed(), file_lines);
+}
@@ -1,11 +1,72 @@
 #include "gtest/gtest.h"
 #include "simple_test_base.h"
+#include "temp_install_test_base.h"
 #include <NavDataManager/AirportQuery.h>
+#include <NavDataManager/NavaidQuery.h>
+#include <NavDataManager/AirwayRouter.h>
+#include <NavDataManager/ProcedureQuery.h>
 #include <filesystem>
 
 class QueryTest : public SimpleTestBase {
 };
 
+// Navigation data and procedures around New York, written by the test into a temp installation rather than taken
+// from an X-Plane one
+class NavDataQueryTest : public TempInstallTestBase {
+protected:
+    void SetUp() override {
+        TempInstallTestBase::SetUp();
+        write_apt(GLOBAL_AIRPORTS, located_airport("KEWR", "Newark Liberty Intl", "40.692500", "-74.168700") +
+                                   located_airport("KJFK", "John F Kennedy Intl", "40.639751", "-73.778925") +
+                                   located_airport("KBOS", "General Edward Lawrence Logan Intl", "42.362972", "-71.006417"));
+        write_file("Resources/default data/earth_nav.dat",
+                   "I\n1200 Version - data cycle 2401, metadata NavXP1200.\n\n"
+                   " 3  40.63993300  -73.77869400     12 11590 130     -12.000 JFK  ENRT K6 KENNEDY VOR/DME\n"
+                   "12  40.63993300  -73.77869400     12 11590 130       0.000 JFK  ENRT K6 KENNEDY VOR/DME\n"
+                   " 2  40.72000000  -74.05000000      0 00379  25       0.000 EW   ENRT K6 WEEQUAHIC NDB\n"
+                   " 4  40.70850000  -74.15550000     18 10835  18      38.940 IEZA KEWR K6 04R ILS-cat-III\n"
+                   " 6  40.68070000  -74.17820000     18 10835  10  300038.940 IEZA KEWR K6 04R GS\n"
+                   "12  40.68070000  -74.17820000     18 10835  18       0.000 IEZA KEWR K6 04R DME-ILS\n"
+                   " 3  47.43538889 -122.30961111    354 11680 130      19.000 SEA  ENRT K1 SEATTLE VORTAC\n"
+                   "99\n");
+        write_file("Resources/default data/earth_fix.dat",
+                   "I\n1101 Version - data cycle 2401, metadata FixXP1101.\n\n"
+                   " 40.90000000  -73.30000000 CANDR ENRT K6 2105430\n"
+                   " 41.38000000  -73.14000000 MERIT ENRT K6 2105430\n"
+                   " 40.75000000  -74.40000000 ALLEX ENRT K6 2105430\n"
+                   " 42.20000000  -72.00000000 BOSOX ENRT K6\n"
+                   "99\n");
+        // V1 and J2 both lead from the Kennedy VOR to MERIT, V3 is one way
+        write_file("Resources/default data/earth_awy.dat",
+                   "I\n1100 Version - data cycle 2401, metadata AwyXP1100.\n\n"
+                   "JFK   K6  3 CANDR K6 11 N 1  18 180 V1\n"
+                   "CANDR K6 11 MERIT K6 11 N 1  18 180 V1-V2\n"
+                   "JFK   K6  3 ALLEX K6 11 N 2 180 450 J2\n"
+                   "ALLEX K6 11 MERIT K6 11 N 2 180 450 J2\n"
+                   "MERIT K6 11 BOSOX K6 11 F 1  18 180 V3\n"
+                   "EW    K6  2 ALLEX K6 11 N 1  18 180 V4\n"
+                   "99\n");
+        // KJFK has a SID with two transitions and an approach; Custom Data replaces the procedures of KBOS
+        write_file("Resources/default data/CIFP/KJFK.dat",
+                   "RWY:RW04L,     ,     ,00013, ,IHIQ,1,   ;N40372318,W073470505,0000;\n"
+                   "SID:010,5,DEEZZ5,RW04L,,,,,,,,VA,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "SID:020,5,DEEZZ5,RW04L,CANDR,K6,E,A,E  B,R,,DF,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "SID:010,6,DEEZZ5,MERIT,CANDR,K6,E,A,E   ,,,IF,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "SID:020,6,DEEZZ5,MERIT,MERIT,K6,E,A,EE  ,,,TF,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "STAR:010,1,LENDY8,,LENDY,K6,E,A,E   ,,,IF,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "APPCH:010,A,I04L,CANDR,CANDR,K6,E,A,E  A,,,IF,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "APPCH:010,I,I04L,,ZALPO,K6,P,C,E  F,,,IF,0,IHIQ,K6,D,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "APPCH:020,I,I04L,,RW04L,K6,P,G,G  M,,,CF,0,IHIQ,K6,D,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "PRDAT:010,00000,00000,0000,0000,00000,000000,00000000,000000,00,  ,  ,,,,,;\n");
+        write_file("Resources/default data/CIFP/KBOS.dat",
+                   "SID:010,2,OLDSID1,RW22R,,,,,,,,VA,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n");
+        write_file("Custom Data/CIFP/KBOS.dat",
+                   "SID:010,2,BOSOX1,RW22R,,,,,,,,VA,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n"
+                   "SID:020,2,BOSOX1,RW22R,BOSOX,K6,E,A,E   ,,,DF,0,,,,,,,,0440,,,,+,02000,,18000,,,,,,,,,,;\n");
+        ingest();
+    }
+};
+
 TEST_F(QueryTest, BasicAirportQueries) {
     // Test country filter
     auto us_airports = manager->airport_data()
@@ -73,4 +134,100 @@ TEST_F(QueryTest, ConvenienceMethods) {
     auto us_airports_convenience = manager->airport_data().get_by_country("United States", 5);
     EXPECT_LE(us_airports_convenience.size(), 5);
     EXPECT_GT(us_airports_convenience.size(), 0);
-}
\ No newline at end of file
+}
+
+TEST_F(NavDataQueryTest, NavaidQueries) {
+    auto jfk = manager->navaid_data()
+        .navaids()
+        .ident("JFK")
+        .type("VOR")
+        .first();
+
+    ASSERT_TRUE(jfk.has_value());
+    EXPECT_EQ(jfk->ident.value(), "JFK");
+    EXPECT_TRUE(jfk->is_enroute());
+
+    // ILS components are tied to their airport
+    auto kewr_navaids = manager->navaid_data().get_for_airport("KEWR");
+    EXPECT_GT(kewr_navaids.size(), 0);
+    for (const auto& navaid : kewr_navaids) {
+        EXPECT_EQ(navaid.airport_icao.value_or(""), "KEWR");
+    }
+}
+
+TEST_F(NavDataQueryTest, NavaidRadiusQuery) {
+    // Around KEWR: results are within the radius, nearest first, and include the Kennedy VOR (~33 km away)
+    auto nearby = manager->navaid_data().get_near(40.6925, -74.1687, 50.0);
+    ASSERT_GT(nearby.size(), 0);
+
+    bool found_jfk = false;
+    for (size_t i = 0; i < nearby.size(); ++i) {
+        ASSERT_TRUE(nearby[i].distance_km.has_value());
+        EXPECT_LE(*nearby[i].distance_km, 50.0);
+        if (i > 0) EXPECT_GE(*nearby[i].distance_km, *nearby[i - 1].distance_km);
+        if (nearby[i].ident == "JFK") found_jfk = true;
+        EXPECT_NE(nearby[i].ident, "SEA");
+    }
+    EXPECT_TRUE(found_jfk);
+
+    EXPECT_EQ(manager->navaid_data().navaids().near(40.6925, -74.1687, 50.0).count(), nearby.size());
+}
+
+TEST_F(NavDataQueryTest, AirwayRouting) {
+    AirwayRouter& router = manager->airway_routing();
+    EXPECT_GT(router.node_count(), 0u);
+
+    // The Kennedy VOR is an airway point itself, V1 is the shorter of the two airways to MERIT
+    auto route = router.find_route("JFK", "MERIT");
+    ASSERT_TRUE(route.has_value());
+    ASSERT_EQ(route->waypoints.size(), 3u);
+    EXPECT_EQ(route->waypoints[0].ident, "JFK");
+    EXPECT_EQ(route->waypoints[1].ident, "CANDR");
+    EXPECT_EQ(route->waypoints[2].airway, "V1");
+
+    // Only the high airway J2 remains
+    auto high_route = router.find_route("JFK", "MERIT", AirwayLevel::High);
+    ASSERT_TRUE(high_route.has_value());
+    EXPECT_EQ(high_route->waypoints[1].ident, "ALLEX");
+    EXPECT_GT(high_route->distance_km, route->distance_km);
+
+    // V3 is one way, MERIT -> BOSOX
+    EXPECT_TRUE(router.find_route("MERIT", "BOSOX").has_value());
+    EXPECT_FALSE(router.find_route("BOSOX", "MERIT").has_value());
+
+    // Airports join the network with direct legs
+    auto airport_route = router.find_route("KJFK", "KBOS");
+    ASSERT_TRUE(airport_route.has_value());
+    EXPECT_EQ(airport_route->waypoints.front().ident, "KJFK");
+    EXPECT_EQ(airport_route->waypoints[1].airway, "DCT");
+    EXPECT_EQ(airport_route->waypoints.back().ident, "KBOS");
+    EXPECT_EQ(airport_route->waypoints.back().airway, "DCT");
+    EXPECT_GT(airport_route->distance_km, 300.0) << "Never shorter than the great circle";
+
+    EXPECT_THROW(router.find_route("NOSUCH", "MERIT"), std::invalid_argument);
+}
+
+TEST_F(NavDataQueryTest, ProcedureQueries) {
+    // One procedure per transition, legs in sequence order
+    auto sids = manager->procedure_data().get_sids("KJFK");
+    ASSERT_EQ(sids.size(), 2u);
+    for (const auto& sid : sids) {
+        EXPECT_EQ(sid.ident.value_or(""), "DEEZZ5");
+        ASSERT_GT(sid.legs.size(), 0u);
+        for (size_t i = 1; i < sid.legs.size(); ++i) {
+            EXPECT_GT(*sid.legs[i].sequence, *sid.legs[i - 1].sequence);
+        }
+    }
+
+    auto approach = manager->procedure_data().procedures().airport("KJFK").type("APPCH").ident("I04L").first();
+    ASSERT_TRUE(approach.has_value());
+    EXPECT_FALSE(approach->transition.has_value()) << "The common route sorts first";
+    EXPECT_EQ(approach->legs.front().path_terminator.value_or(""), "IF");
+
+    // Custom Data/CIFP replaces the default file of the same airport
+    auto kbos_sids = manager->procedure_data().get_sids("KBOS");
+    ASSERT_EQ(kbos_sids.size(), 1u);
+    EXPECT_EQ(kbos_sids[0].ident.value_or(""), "BOSOX1");
+
+    EXPECT_TRUE(manager->procedure_data().get_for_airport("NONE").empty());
+}
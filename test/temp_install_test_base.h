@@ -0,0 +1,87 @@
+#ifndef TEMP_INSTALL_TEST_BASE_H
+#define TEMP_INSTALL_TEST_BASE_H
+
+#include "gtest/gtest.h"
+#include <NavDataManager/NavDataManager.h>
+#include <NavDataManager/AirportQuery.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+// A small X-Plane installation in the temp directory, written by the test itself and removed after it. Each ingest()
+// runs on a new NavDataManager, as a separate run of an application would.
+class TempInstallTestBase : public ::testing::Test {
+protected:
+    static constexpr const char* RUNWAY = "100 45.72 1 0 0.25 0 2 1 04 40.68 -74.17 0 0 3 7 1 0 22 40.70 -74.15 0 0 3 10 1 0\n";
+    static constexpr const char* GLOBAL_AIRPORTS = "Global Scenery/Global Airports";
+
+    void SetUp() override {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::string name = std::string(test->test_suite_name()) + "_" + test->name();
+        xp_root = std::filesystem::temp_directory_path() / (name + "_xp");
+        db_path = std::filesystem::temp_directory_path() / (name + ".db");
+        std::filesystem::remove_all(xp_root);
+        std::filesystem::remove(db_path);
+        std::filesystem::create_directories(xp_root / GLOBAL_AIRPORTS / "Earth nav data");
+        std::filesystem::create_directories(xp_root / "Custom Scenery");
+    }
+
+    void TearDown() override {
+        manager.reset();
+        std::filesystem::remove_all(xp_root);
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::filesystem::remove(db_path.string() + suffix);
+        }
+        if (!manifest_path.empty()) std::filesystem::remove(manifest_path);
+    }
+
+    // An airport header line and its records, a single runway unless given others
+    static std::string airport(const std::string& icao, const std::string& name, const std::string& records = RUNWAY) {
+        return "1 17 0 0 " + icao + " " + name + "\n" + records;
+    }
+
+    // An airport with its datum position, which is where routes and radius searches place it
+    static std::string located_airport(const std::string& icao, const std::string& name, const std::string& latitude,
+                                       const std::string& longitude) {
+        return airport(icao, name, "1302 datum_lat " + latitude + "\n1302 datum_lon " + longitude + "\n" + RUNWAY);
+    }
+
+    // Writes the apt.dat of a scenery package, given relative to the installation ("Custom Scenery/A Pack")
+    void write_apt(const std::string& package, const std::string& airports) {
+        write_file(package + "/Earth nav data/apt.dat", "I\n1200 Version - data cycle 2024.01\n\n" + airports + "99\n");
+    }
+
+    void write_file(const std::string& relative_path, const std::string& contents) {
+        std::filesystem::path path = xp_root / std::filesystem::u8path(relative_path);
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << contents;
+    }
+
+    // A new manager on the installation and the database, scanned and connected but not yet parsed
+    NavDataManager& open() {
+        manager.reset();
+        manager = std::make_unique<NavDataManager>(xp_root.string());
+        manager->set_scan_manifest_path(manifest_path.string());
+        manager->scan_xp();
+        manager->connect_database(db_path.string());
+        return *manager;
+    }
+
+    IngestSummary ingest() {
+        return open().parse_all_dat_files();
+    }
+
+    // Name of the airport in the database, empty if there is none
+    std::string airport_name(const std::string& icao) {
+        auto found = manager->airport_data().airports().icao(icao).first();
+        return found ? found->airport_name.value_or("") : std::string();
+    }
+
+    std::filesystem::path xp_root;
+    std::filesystem::path db_path;
+    std::filesystem::path manifest_path;            // Empty: every scan walks all packages
+    std::unique_ptr<NavDataManager> manager;
+};
+
+#endif